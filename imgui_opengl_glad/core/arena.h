@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "platform.h"
+
+// Size classes from the design notes in main_context.h, picked once on the command line.
+// None keeps the plain heap (tests, tools).
+enum class ArenaSize : uint8_t { None, XS, S, M, L, XL, XXL };
+
+// Performance critical: no, start-up only
+static inline uint64_t arena_size_bytes(ArenaSize size) {
+    const uint64_t MB = 1ull << 20;
+    switch (size) {
+    case ArenaSize::XS:
+        return 128 * MB;
+    case ArenaSize::S:
+        return 256 * MB;
+    case ArenaSize::M:
+        return 512 * MB;
+    case ArenaSize::L:
+        return 1024 * MB;
+    case ArenaSize::XL:
+        return 2048 * MB;
+    case ArenaSize::XXL:
+        return 4096 * MB;
+    case ArenaSize::None:
+        break;
+    }
+    return 0;
+}
+
+// Performance critical: no, start-up and report output only
+static inline const char* arena_size_name(ArenaSize size) {
+    static const char* names[] = {"none", "XS", "S", "M", "L", "XL", "XXL"};
+    return names[(int)size];
+}
+
+// Case-insensitive "xs".."xxl"; returns false for anything else.
+// Performance critical: no, command line parsing only
+static inline bool parse_arena_size(const char* text, ArenaSize& out) {
+    // Performance critical: startup-only scan of seven names
+    for (int i = 1; i <= (int)ArenaSize::XXL; ++i) {
+        const char* name = arena_size_name((ArenaSize)i);
+        size_t k = 0;
+        // Performance critical: compare at most four characters
+        while (name[k] && text[k] && std::tolower((unsigned char)text[k]) ==
+                                         std::tolower((unsigned char)name[k]))
+            ++k;
+        if (!name[k] && !text[k]) {
+            out = (ArenaSize)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// One preallocated, prefaulted region for all long-lived host state. Allocation is a bump
+// pointer and nothing is ever returned, so it is meant for buffers sized once at startup.
+// Not thread-safe: carve everything before writer threads start. When the region is full
+// the request is counted as a spill and the caller falls back to the heap.
+struct Arena {
+    struct Tag {
+        const char* name;
+        uint64_t bytes;
+        uint32_t count;
+    };
+    static constexpr uint32_t kMaxTags = 32;
+
+    uint8_t* base{nullptr};
+    uint64_t capacity{0};
+    uint64_t used{0};
+    const char* page_kind{"none"};
+    uint64_t prefault_faults{0};  // page faults taken while prefaulting
+    uint64_t spilled_bytes{0};
+    uint32_t spilled_count{0};
+    Tag tags[kMaxTags]{};
+    uint32_t num_tags{0};
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() {
+        release();
+    }
+
+    // Maps bytes (rounded up to 2 MB) and touches every page so steady-state accesses
+    // never fault. Returns false when the OS refuses the mapping.
+    bool reserve(uint64_t bytes, bool huge_pages) {
+        release();
+        const uint64_t kHuge = 2ull << 20;
+        bytes = (bytes + kHuge - 1) & ~(kHuge - 1);
+        const char* kind = "4k";
+        void* p = os_alloc_pages((size_t)bytes, huge_pages, &kind);
+        if (!p)
+            return false;
+        base = static_cast<uint8_t*>(p);
+        capacity = bytes;
+        page_kind = kind;
+
+        uint64_t faults = os_page_faults();
+        const size_t page = os_page_size();
+        // Performance critical: prefault once at startup, one store per page
+        for (uint64_t off = 0; off < capacity; off += page)
+            static_cast<volatile uint8_t*>(base)[off] = 0;
+        prefault_faults = os_page_faults() - faults;
+        return true;
+    }
+
+    void release() {
+        os_free_pages(base, (size_t)capacity);
+        base = nullptr;
+        capacity = used = 0;
+        page_kind = "none";
+        spilled_bytes = 0;
+        spilled_count = 0;
+        num_tags = 0;
+    }
+
+    bool active() const {
+        return base != nullptr;
+    }
+
+    bool owns(const void* p) const {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        return base && b >= base && b < base + capacity;
+    }
+
+    // Returns align-aligned memory (align must be a power of two), or nullptr when the
+    // arena is inactive or full. tag groups the bytes in the usage report.
+    void* alloc(uint64_t bytes, uint64_t align, const char* tag) {
+        if (!base)
+            return nullptr;
+        uint64_t start = (used + align - 1) & ~(align - 1);
+        if (start + bytes > capacity) {
+            spilled_bytes += bytes;
+            ++spilled_count;
+            return nullptr;
+        }
+        used = start + bytes;
+        record(tag, bytes);
+        return base + start;
+    }
+
+    void record(const char* tag, uint64_t bytes) {
+        // Performance critical: startup-only linear lookup of a handful of tags
+        for (uint32_t t = 0; t < num_tags; ++t) {
+            if (std::strcmp(tags[t].name, tag) == 0) {
+                tags[t].bytes += bytes;
+                ++tags[t].count;
+                return;
+            }
+        }
+        if (num_tags < kMaxTags)
+            tags[num_tags++] = Tag{tag, bytes, 1};
+    }
+
+    void print_report(FILE* out) const {
+        if (!base) {
+            std::fprintf(out, "Arena: off (heap allocation)\n");
+            return;
+        }
+        std::fprintf(out, "Arena: %.1f / %.1f MB used, pages=%s, prefault faults=%llu\n",
+                     used / 1048576.0, capacity / 1048576.0, page_kind,
+                     (unsigned long long)prefault_faults);
+        // Performance critical: report loop over recorded tags
+        for (uint32_t t = 0; t < num_tags; ++t)
+            std::fprintf(out, "  %-16s %10.2f MB  (%u)\n", tags[t].name,
+                         tags[t].bytes / 1048576.0, tags[t].count);
+        if (spilled_count)
+            std::fprintf(out, "  spilled to heap: %u allocations, %.2f MB\n", spilled_count,
+                         spilled_bytes / 1048576.0);
+    }
+};
+
+// Deleter for arrays that may live in an Arena: arena memory is only destroyed in place,
+// heap memory is deleted normally.
+template <typename T>
+struct ArenaDeleter {
+    size_t count{0};
+    bool from_arena{false};
+    void operator()(T* p) const {
+        if (!from_arena) {
+            delete[] p;  // NOTE: heap fallback allocated with new T[] in make_arena_array
+            return;
+        }
+        // Performance critical: trivial destructors compile to nothing
+        for (size_t i = 0; i < count; ++i)
+            p[i].~T();
+    }
+};
+
+template <typename T>
+using ArenaArray = std::unique_ptr<T[], ArenaDeleter<T>>;
+
+// Value-initialized array of n T from arena when it is active and has room, else the heap.
+template <typename T>
+ArenaArray<T> make_arena_array(Arena* arena, size_t n, const char* tag) {
+    if (arena && arena->active()) {
+        const uint64_t align = std::max<uint64_t>(alignof(T), 64);
+        if (void* mem = arena->alloc((uint64_t)sizeof(T) * n, align, tag)) {
+            T* p = static_cast<T*>(mem);
+            // Performance critical: construct in place, startup only
+            for (size_t i = 0; i < n; ++i)
+                ::new (static_cast<void*>(p + i)) T();  // NOTE: placement new into arena
+            return ArenaArray<T>(p, ArenaDeleter<T>{n, true});
+        }
+    }
+    // Heap fallback, required when the arena is off or full; ArenaDeleter uses delete[]
+    return ArenaArray<T>(new T[n](), ArenaDeleter<T>{n, false});
+}
+
+// std::allocator replacement that draws from an Arena when one is bound and active, so a
+// std::vector sized at startup never touches malloc afterwards. Growth past the arena
+// (or without one) falls back to the heap; arena blocks are never freed individually.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    Arena* arena{nullptr};
+    const char* tag{"vector"};
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(Arena* a, const char* t = "vector") : arena(a), tag(t) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena), tag(other.tag) {}
+
+    T* allocate(size_t n) {
+        if (arena && arena->active()) {
+            const uint64_t align = std::max<uint64_t>(alignof(T), 64);
+            if (void* mem = arena->alloc((uint64_t)sizeof(T) * n, align, tag))
+                return static_cast<T*>(mem);
+        }
+        return static_cast<T*>(::operator new(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (arena && arena->owns(p))
+            return;
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return arena == other.arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return arena != other.arena;
+    }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
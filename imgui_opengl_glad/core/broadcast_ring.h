@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "arena.h"
+
+// What a producer does when the slowest consumer is a full lap behind.
+enum class BroadcastPolicy : uint8_t {
+    Gated,  // publish fails (caller counts an overflow); no consumer ever loses an entry
+    Lossy,  // publish always succeeds; a lapped consumer is told so and must resync
+};
+
+// Multi-producer, multi-consumer broadcast ring (disruptor style).
+// Every published entry is seen by every registered consumer: each consumer owns a
+// read cursor and nothing is removed on read. Producers claim positions from a shared
+// counter and publish by stamping the cell with position + 1; in Gated mode a producer
+// only claims a position once every consumer has moved past the entry one lap earlier.
+// Capacity must be a power of two.
+struct BroadcastRing {
+    static constexpr uint32_t kMaxConsumers = 8;
+
+    struct Cell {
+        std::atomic<uint64_t> seq{0};  // position + 1 of the entry stored, 0 = never written
+        std::atomic<uint32_t> value{0};
+    };
+    struct alignas(64) Cursor {
+        std::atomic<uint64_t> pos{0};  // next position this consumer reads
+        std::atomic<bool> active{false};  // pos is valid, producers gate on it
+        std::atomic<bool> taken{false};   // claimed by a consumer, maybe not active yet
+    };
+
+    alignas(64) std::atomic<uint64_t> claim{0};  // next position to claim (producers)
+    alignas(64) std::atomic<uint64_t> gate{0};   // cached slowest cursor (Gated producers)
+    Cursor cursors[kMaxConsumers];
+    uint64_t cap_mask{0};
+    BroadcastPolicy policy{BroadcastPolicy::Gated};
+    ArenaArray<Cell> cells;
+
+    void init(uint32_t capacity_pow2, BroadcastPolicy p, Arena* arena = nullptr) {
+        uint64_t cap = 2;
+        // Performance critical: bit shifting loop for power-of-2 calculation
+        while (cap < capacity_pow2)
+            cap <<= 1;
+        cells = make_arena_array<Cell>(arena, cap, "broadcast ring");
+        cap_mask = cap - 1;
+        policy = p;
+        claim.store(0, std::memory_order_relaxed);
+        gate.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t capacity() const {
+        return cap_mask + 1;
+    }
+
+    // Registers a consumer starting at the current claim position. Returns its id, or -1
+    // when kMaxConsumers are already registered. The cursor's position is stored before it
+    // turns active, so a Gated producer never gates on a stale one (a spurious overflow).
+    int32_t register_consumer() {
+        // Performance critical: called once per consumer, linear scan is fine
+        for (uint32_t c = 0; c < kMaxConsumers; ++c) {
+            bool expected = false;
+            if (cursors[c].taken.compare_exchange_strong(expected, true,
+                                                         std::memory_order_acq_rel)) {
+                cursors[c].pos.store(claim.load(std::memory_order_acquire),
+                                     std::memory_order_relaxed);
+                cursors[c].active.store(true, std::memory_order_release);
+                return (int32_t)c;
+            }
+        }
+        return -1;
+    }
+
+    void unregister_consumer(int32_t id) {
+        if (id < 0 || (uint32_t)id >= kMaxConsumers)
+            return;
+        cursors[id].active.store(false, std::memory_order_release);
+        cursors[id].taken.store(false, std::memory_order_release);
+    }
+
+    // Slowest active cursor, or upto when no consumer is registered.
+    uint64_t min_cursor(uint64_t upto) const {
+        uint64_t m = upto;
+        // Performance critical: scan of the fixed consumer table (slow path of publish)
+        for (uint32_t c = 0; c < kMaxConsumers; ++c) {
+            if (cursors[c].active.load(std::memory_order_acquire)) {
+                uint64_t p = cursors[c].pos.load(std::memory_order_acquire);
+                if (p < m)
+                    m = p;
+            }
+        }
+        return m;
+    }
+
+    // Performance critical: inline multi-producer publish (hot path)
+    // Returns false only in Gated mode when the slowest consumer is a full lap behind.
+    inline bool publish(uint32_t value) {
+        uint64_t pos;
+        if (policy == BroadcastPolicy::Lossy) {
+            pos = claim.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            pos = claim.load(std::memory_order_relaxed);
+            // Performance critical: CAS loop, gate refreshed only when the cached one blocks
+            for (;;) {
+                if (pos - gate.load(std::memory_order_acquire) > cap_mask) {
+                    uint64_t g = min_cursor(pos);
+                    gate.store(g, std::memory_order_release);
+                    if (pos - g > cap_mask)
+                        return false;
+                }
+                if (claim.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+        }
+        store_cell(pos, value);
+        return true;
+    }
+
+    // Claims n consecutive positions at once. All or nothing in Gated mode; fails for
+    // n larger than the capacity.
+    // Performance critical: inline multi-producer batched publish (hot path)
+    inline bool publish_batch(const uint32_t* values, uint32_t n) {
+        if (n == 0)
+            return true;
+        if (n > cap_mask + 1)
+            return false;
+        uint64_t pos;
+        if (policy == BroadcastPolicy::Lossy) {
+            pos = claim.fetch_add(n, std::memory_order_relaxed);
+        } else {
+            pos = claim.load(std::memory_order_relaxed);
+            // Performance critical: CAS loop, gate refreshed only when the cached one blocks
+            for (;;) {
+                uint64_t last = pos + n - 1;
+                if (last - gate.load(std::memory_order_acquire) > cap_mask) {
+                    uint64_t g = min_cursor(pos);
+                    gate.store(g, std::memory_order_release);
+                    if (last - g > cap_mask)
+                        return false;
+                }
+                if (claim.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                    break;
+            }
+        }
+        // Performance critical: stamp each cell in position order
+        for (uint32_t k = 0; k < n; ++k)
+            store_cell(pos + k, values[k]);
+        return true;
+    }
+
+    // A Lossy producer may overwrite a cell a lapped consumer is reading, so it marks the
+    // cell first, as a seqlock writer: seq = pos reads as "not published yet" to a consumer
+    // waiting for pos and as a later lap to one still at pos - capacity, and poll's second
+    // seq check rejects a value read after the mark.
+    // Performance critical: inline cell stamp (hot path)
+    inline void store_cell(uint64_t pos, uint32_t value) {
+        Cell& c = cells[pos & cap_mask];
+        if (policy == BroadcastPolicy::Lossy) {
+            c.seq.store(pos, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        c.value.store(value, std::memory_order_relaxed);
+        c.seq.store(pos + 1, std::memory_order_release);
+    }
+
+    // Reads up to max entries for consumer id. Sets lapped when producers overwrote entries
+    // this consumer had not read yet (Lossy only); the cursor then skips to the oldest
+    // entry still in the ring and the caller must treat everything as changed.
+    // Performance critical: inline per-consumer batch read (hot path)
+    inline uint32_t poll(int32_t id, uint32_t* out, uint32_t max, bool& lapped) {
+        Cursor& cur = cursors[id];
+        uint64_t pos = cur.pos.load(std::memory_order_relaxed);
+        uint32_t n = 0;
+        lapped = false;
+        // Performance critical: one acquire load per entry, stops at the first unpublished cell
+        while (n < max) {
+            Cell& c = cells[pos & cap_mask];
+            uint64_t s1 = c.seq.load(std::memory_order_acquire);
+            if (s1 < pos + 1)
+                break;  // not published yet
+            if (s1 == pos + 1) {
+                uint32_t v = c.value.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (c.seq.load(std::memory_order_relaxed) == s1) {
+                    out[n++] = v;
+                    ++pos;
+                    continue;
+                }
+            }
+            // overwritten by a later lap: jump to the oldest entry that can still be valid
+            lapped = true;
+            uint64_t head = claim.load(std::memory_order_acquire);
+            pos = head > cap_mask ? head - cap_mask : 0;
+            break;
+        }
+        cur.pos.store(pos, std::memory_order_release);
+        return n;
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "published_rows.h"
+
+// Rows one ingest cycle changed, with their values before and after and the RowColumn
+// bits that moved, in the order they were published. Immutable once delivered: listeners
+// get a const reference that stays valid until the next cycle starts.
+struct ChangeSet {
+    uint64_t cycle{0};       // ingest cycle that produced it, 1 for the first
+    uint64_t epoch{0};       // published epoch once every row below was applied
+    uint8_t cols_union{0};   // RowColumn bits changed by any row
+    std::vector<uint32_t> ids;
+    std::vector<RowSnap> before, after;
+    std::vector<uint8_t> cols;
+
+    size_t size() const {
+        return ids.size();
+    }
+    bool empty() const {
+        return ids.empty();
+    }
+
+    // Keeps the capacity, so a steady change rate stops allocating after a few cycles
+    void clear() {
+        ids.clear();
+        before.clear();
+        after.clear();
+        cols.clear();
+        cols_union = 0;
+    }
+
+    // Performance critical: four appends per changed row, capacity reused across cycles
+    void add(uint32_t row, const RowSnap& old_value, const RowSnap& new_value, uint8_t changed) {
+        ids.push_back(row);
+        before.push_back(old_value);
+        after.push_back(new_value);
+        cols.push_back(changed);
+        cols_union |= changed;
+    }
+};
+
+using ChangeSetListener = std::function<void(const ChangeSet&)>;
+
+// Fan-out of change sets from the single ingest stage (run_ingest_cycle) to every view.
+// Listeners run on the ingest thread, in subscription order, after the rows are published.
+struct ChangeFeed {
+    ChangeSet current;
+    std::vector<std::pair<int32_t, ChangeSetListener>> listeners;
+    int32_t next_id{0};
+    uint64_t rows_delivered{0};
+
+    // Returns a handle for unsubscribe
+    int32_t subscribe(ChangeSetListener fn) {
+        listeners.emplace_back(next_id, std::move(fn));  // Performance critical: startup only
+        return next_id++;
+    }
+
+    void unsubscribe(int32_t id) {
+        // Performance critical: a handful of listeners
+        for (size_t k = 0; k < listeners.size(); ++k) {
+            if (listeners[k].first == id) {
+                listeners.erase(listeners.begin() + k);
+                return;
+            }
+        }
+    }
+
+    ChangeSet& begin_cycle() {
+        current.clear();
+        ++current.cycle;
+        return current;
+    }
+
+    void deliver() {
+        rows_delivered += current.size();
+        // Performance critical: one call per listener per cycle
+        for (auto& listener : listeners)
+            listener.second(current);
+    }
+};
@@ -0,0 +1,172 @@
+#include "change_sink.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kSinkBufferAlign = 64u << 10;
+constexpr size_t kTextRowMax = 128;  // widest line: six integers, a small one, separators
+
+// Decimal digits of v at p, returns the end; no locale, no format parsing
+char* append_int(char* p, int64_t v) {
+    uint64_t u = (uint64_t)v;
+    if (v < 0) {
+        *p++ = '-';
+        u = 0 - u;
+    }
+    char digits[20];
+    int n = 0;
+    // Performance critical: one division per digit, the text sink's inner loop
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    // Performance critical: reverse copy of at most 20 digits
+    while (n)
+        *p++ = digits[--n];
+    return p;
+}
+
+}  // namespace
+
+const char* sink_kind_name(SinkKind kind) {
+    switch (kind) {
+    case SinkKind::Null:
+        return "null";
+    case SinkKind::Text:
+        return "text";
+    case SinkKind::Binary:
+        return "binary";
+    }
+    return "?";
+}
+
+bool parse_sink_kind(const char* name, SinkKind& out) {
+    if (std::strcmp(name, "null") == 0)
+        out = SinkKind::Null;
+    else if (std::strcmp(name, "text") == 0)
+        out = SinkKind::Text;
+    else if (std::strcmp(name, "binary") == 0)
+        out = SinkKind::Binary;
+    else
+        return false;
+    return true;
+}
+
+BufferedSink::BufferedSink(FILE* f, bool owns, size_t buffer_bytes) : file(f), owns_file(owns) {
+    const size_t blocks = (buffer_bytes + kSinkBufferAlign - 1) / kSinkBufferAlign;
+    buf.resize(std::max<size_t>(1, blocks) * kSinkBufferAlign);
+    // Owned files skip stdio buffering: buf already batches, a second copy buys nothing
+    if (owns_file)
+        std::setvbuf(file, nullptr, _IONBF, 0);
+}
+
+BufferedSink::~BufferedSink() {
+    flush();
+    if (owns_file)
+        std::fclose(file);
+    else
+        std::fflush(file);
+}
+
+bool BufferedSink::flush() {
+    if (used == 0)
+        return !failed;
+    if (!failed) {
+        const size_t written = std::fwrite(buf.data(), 1, used, file);
+        ++writes;
+        if (written != used) {
+            failed = true;
+            std::fprintf(stderr, "Change sink: short write (%zu of %zu bytes), output stopped\n",
+                         written, used);
+        }
+    }
+    used = 0;
+    return !failed;
+}
+
+char* BufferedSink::reserve(size_t n) {
+    if (used + n > buf.size())
+        flush();
+    return buf.data() + used;
+}
+
+void NullSink::write(const ChangeSet& changes) {
+    if (changes.empty())
+        return;
+    ++sets;
+    rows += changes.size();
+    bytes += sizeof(BinarySink::SetHeader) + changes.size() * sizeof(BinarySink::Record);
+}
+
+void TextSink::write(const ChangeSet& changes) {
+    if (changes.empty())
+        return;
+    ++sets;
+    rows += changes.size();
+    // Performance critical: formats straight into the write buffer, one row per line
+    for (size_t k = 0; k < changes.size(); ++k) {
+        const RowSnap& r = changes.after[k];
+        char* const start = reserve(kTextRowMax);
+        char* p = append_int(start, (int64_t)changes.cycle);
+        *p++ = ' ';
+        p = append_int(p, changes.ids[k]);
+        *p++ = ' ';
+        p = append_int(p, r.ts);
+        *p++ = ' ';
+        p = append_int(p, r.px);
+        *p++ = ' ';
+        p = append_int(p, r.qty);
+        *p++ = ' ';
+        p = append_int(p, r.side);
+        *p++ = ' ';
+        p = append_int(p, changes.cols[k]);
+        *p++ = '\n';
+        commit((size_t)(p - start));
+    }
+}
+
+BinarySink::BinarySink(FILE* f, bool owns, size_t buffer_bytes)
+    : BufferedSink(f, owns, buffer_bytes) {
+    const uint32_t sizes[2] = {(uint32_t)sizeof(SetHeader), (uint32_t)sizeof(Record)};
+    char* p = reserve(sizeof(kMagic) + sizeof(sizes));
+    std::memcpy(p, kMagic, sizeof(kMagic));
+    std::memcpy(p + sizeof(kMagic), sizes, sizeof(sizes));
+    commit(sizeof(kMagic) + sizeof(sizes));
+}
+
+void BinarySink::write(const ChangeSet& changes) {
+    if (changes.empty())
+        return;
+    ++sets;
+    rows += changes.size();
+    const SetHeader header{changes.cycle, changes.epoch, (uint32_t)changes.size(),
+                           changes.cols_union};
+    std::memcpy(reserve(sizeof(header)), &header, sizeof(header));
+    commit(sizeof(header));
+    // Performance critical: one 32-byte record per row, copied into the write buffer
+    for (size_t k = 0; k < changes.size(); ++k) {
+        const RowSnap& r = changes.after[k];
+        const Record rec{changes.ids[k], changes.cols[k], r.side, 0, r.ts, r.px, r.qty};
+        std::memcpy(reserve(sizeof(rec)), &rec, sizeof(rec));
+        commit(sizeof(rec));
+    }
+}
+
+std::unique_ptr<ChangeSink> make_change_sink(SinkKind kind, const char* path,
+                                             size_t buffer_bytes) {
+    if (kind == SinkKind::Null)
+        return std::make_unique<NullSink>();
+
+    const bool to_stdout = !path || std::strcmp(path, "-") == 0 ||
+                           (kind == SinkKind::Text && path[0] == '\0');
+    FILE* file = to_stdout ? stdout : std::fopen(path, kind == SinkKind::Binary ? "wb" : "w");
+    if (!file) {
+        std::fprintf(stderr, "Cannot open %s for the %s sink\n", path, sink_kind_name(kind));
+        return nullptr;
+    }
+    if (kind == SinkKind::Text)
+        return std::make_unique<TextSink>(file, !to_stdout, buffer_bytes);
+    return std::make_unique<BinarySink>(file, !to_stdout, buffer_bytes);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "change_set.h"
+
+/**
+ * @brief Where the headless host writes the change sets of the ingest stage
+ */
+enum class SinkKind : uint8_t {
+    Null,    // counts what would be written, no I/O (pipeline benchmarks)
+    Text,    // one line per changed row: cycle row ts px qty side cols
+    Binary,  // fixed-size records, see BinarySink
+};
+
+const char* sink_kind_name(SinkKind kind);
+bool parse_sink_kind(const char* name, SinkKind& out);
+
+// Receives every change set of the ingest stage, on the ingest thread (subscribe it to
+// ctx.changes). Empty change sets write nothing. Output goes through one large buffer that
+// is handed to the file in single fwrite calls once full, on flush() and on destruction.
+struct ChangeSink {
+    uint64_t sets{0};    // non-empty change sets written
+    uint64_t rows{0};    // rows written
+    uint64_t bytes{0};   // bytes produced, buffered or written
+    uint64_t writes{0};  // fwrite calls issued
+    bool failed{false};  // a write came back short; later output is dropped
+
+    virtual ~ChangeSink() = default;
+    virtual void write(const ChangeSet& changes) = 0;
+    // Hands the buffered bytes to the file; false once any write failed
+    virtual bool flush() {
+        return !failed;
+    }
+};
+
+// Shared buffering of the text and binary sinks. The file is unbuffered in stdio, so every
+// byte is copied once into buf and leaves in buffer-sized writes.
+struct BufferedSink : ChangeSink {
+    FILE* file{nullptr};
+    bool owns_file{false};
+    std::vector<char> buf;
+    size_t used{0};
+
+    BufferedSink(FILE* f, bool owns, size_t buffer_bytes);
+    ~BufferedSink() override;
+    bool flush() override;
+
+    // Room for n more bytes at the end of buf, flushing first when it is short
+    char* reserve(size_t n);
+    void commit(size_t n) {
+        used += n;
+        bytes += n;
+    }
+};
+
+struct NullSink : ChangeSink {
+    void write(const ChangeSet& changes) override;
+};
+
+struct TextSink : BufferedSink {
+    using BufferedSink::BufferedSink;
+    void write(const ChangeSet& changes) override;
+};
+
+// Binary layout, native byte order (little endian on every supported target):
+//   file header  8 bytes "EMSPCHG1", uint32 set header size (24), uint32 record size (32)
+//   per set      uint64 cycle, uint64 epoch, uint32 rows, uint32 cols_union (RowColumn bits)
+//   per row      uint32 row, uint8 cols, uint8 side, uint16 0, int64 ts, int64 px, int64 qty
+struct BinarySink : BufferedSink {
+    static constexpr char kMagic[8] = {'E', 'M', 'S', 'P', 'C', 'H', 'G', '1'};
+    struct SetHeader {
+        uint64_t cycle;
+        uint64_t epoch;
+        uint32_t rows;
+        uint32_t cols_union;
+    };
+    struct Record {
+        uint32_t row;
+        uint8_t cols;
+        uint8_t side;
+        uint16_t pad;
+        int64_t ts;
+        int64_t px;
+        int64_t qty;
+    };
+    static_assert(sizeof(SetHeader) == 24 && sizeof(Record) == 32, "binary layout changed");
+
+    BinarySink(FILE* f, bool owns, size_t buffer_bytes);
+    void write(const ChangeSet& changes) override;
+};
+
+/**
+ * @brief Creates the sink for kind writing to path
+ *
+ * path "-" (or empty, for text) is stdout. Returns nullptr, with a message on stderr, when
+ * the file cannot be opened.
+ *
+ * @param kind Output format
+ * @param path File to create (truncated), ignored by SinkKind::Null
+ * @param buffer_bytes Size of the write buffer; rounded up to 64 KB
+ */
+std::unique_ptr<ChangeSink> make_change_sink(SinkKind kind, const char* path,
+                                             size_t buffer_bytes);
@@ -1,36 +1,119 @@
 #include "data_updater.h"
 
-void update_latest_data_from_context(HostContext& ctx, const EmspConfig& config, uint64_t t,
-                                     uint64_t next_paint, const HostMDSlot& slot) {
-    uint32_t id;
-    // Performance critical: tight loop processing queued market data updates
-    while (ctx.q.pop(id)) {
-        if (id < config.num_rows)
-            ctx.dirty[id] = 1;
+void initializeHostContext(HostContext& ctx, HostMDSlot& slot, const EmspConfig& config,
+                           std::vector<int64_t>& ts_ns, std::vector<int64_t>& px_n,
+                           std::vector<int64_t>& qty, std::vector<uint8_t>& side) {
+    // One prefaulted region for everything below when a size class was requested; a
+    // caller may also reserve ctx.arena itself before calling this
+    if (config.arena_size != ArenaSize::None && !ctx.arena.active() &&
+        !ctx.arena.reserve(arena_size_bytes(config.arena_size), config.huge_pages)) {
+        fprintf(stderr, "Arena %s unavailable, using the heap\n",
+                arena_size_name(config.arena_size));
     }
+    Arena* arena = &ctx.arena;  // inactive arena = heap
 
-    if (t >= next_paint) {
-        uint32_t printed = 0;
-        // Performance critical: batch processing all rows for rendering
-        for (uint32_t i = 0; i < config.num_rows; ++i) {
-            if (!ctx.dirty[i])
-                continue;
-            ctx.dirty[i] = 0;
+    // Initialize HostContext
+    ctx.num_rows = config.num_rows;
+    ctx.col_ts_ns.reset();
+    ctx.col_px_n.reset();
+    ctx.col_qty.reset();
+    ctx.col_side.reset();
+    if (config.row_storage == RowStorage::Lines) {
+        uint32_t num_lines = (config.num_rows + MD_ROWS_PER_LINE - 1) / MD_ROWS_PER_LINE;
+        ctx.row_lines = make_arena_array<MDRowLine>(arena, num_lines, "row lines");  // seq even
+        ctx.seq.init_colocated(
+            reinterpret_cast<std::atomic<uint32_t>*>(&ctx.row_lines[0].seq[0]),
+            1, 4);  // 2 rows per record of 16 words
+        static_assert(MD_ROWS_PER_LINE == 2, "update the colocated seq shifts");
+    } else {
+        ctx.row_lines.reset();
+        ctx.seq.init(config.num_rows, config.seq_layout, arena);
+        if (ctx.arena.active()) {
+            ctx.col_ts_ns = make_arena_array<int64_t>(arena, config.num_rows, "columns");
+            ctx.col_px_n = make_arena_array<int64_t>(arena, config.num_rows, "columns");
+            ctx.col_qty = make_arena_array<int64_t>(arena, config.num_rows, "columns");
+            ctx.col_side = make_arena_array<uint8_t>(arena, config.num_rows, "columns");
+        }
+    }
+    ctx.dirty = DirtyFlags(config.num_rows, 0, ArenaAllocator<uint8_t>(arena, "dirty flags"));
+    ctx.published.init(config.num_rows, arena);
+    ctx.row_torn = ArenaVector<uint32_t>(config.num_rows, 0,
+                                         ArenaAllocator<uint32_t>(arena, "snapshot stats"));
+    ctx.snap_stats = HostContext::SnapshotStats{};
+    ctx.latency.enabled.store(config.latency_stats, std::memory_order_relaxed);
+    Profiler::global().enabled.store(config.profiler, std::memory_order_relaxed);
+    ctx.notify_mode = config.notify_mode;
+    ctx.q.init(1u << 18, arena);  // also the fallback for writers without a ring
+    if (config.notify_mode == NotifyMode::Bitmap) {
+        ctx.dirty_bits.init(config.num_rows, arena);
+    }
+    if (config.notify_mode == NotifyMode::Broadcast) {
+        ctx.bcast.init(1u << 18, config.broadcast_policy, arena);
+        ctx.bcast_primary = ctx.bcast.register_consumer();
+        ctx.bcast_primary_seen = 0;
+    }
+    if (config.notify_mode == NotifyMode::WriterRings) {
+        ctx.max_writers = std::max(1u, config.writers);
+        ctx.writer_rings = make_arena_array<SPSCRing>(arena, ctx.max_writers, "writer rings");
+        ctx.writer_ring_used =
+            make_arena_array<std::atomic<bool>>(arena, ctx.max_writers, "writer rings");
+        // Performance critical: one ring per expected writer thread
+        for (uint32_t w = 0; w < ctx.max_writers; ++w) {
+            ctx.writer_rings[w].init(1u << 16, arena);
+            ctx.writer_ring_used[w].store(false, std::memory_order_relaxed);
+        }
+    }
 
-            HostContext::RowSnap snap{};
-            bool ok = false;
-            // Performance critical: retry loop for atomic row snapshot
-            for (int tries = 0; tries < 4 && !ok; ++tries)
-                ok = row_snapshot(&ctx, &slot, i, snap);
-            if (!ok)
-                continue;
+    // Initialize HostMDSlot
+    slot = HostMDSlot{};
+    slot.num_rows = config.num_rows;
+    if (ctx.row_lines) {
+        slot.row_lines = ctx.row_lines.get();
+    } else if (ctx.col_ts_ns) {
+        slot.ts_ns = ctx.col_ts_ns.get();
+        slot.px_n = ctx.col_px_n.get();
+        slot.qty = ctx.col_qty.get();
+        slot.side = ctx.col_side.get();
+    } else {
+        slot.ts_ns = ts_ns.data();
+        slot.px_n = px_n.data();
+        slot.qty = qty.data();
+        slot.side = side.data();
+    }
+    slot.user = &ctx;
+    slot.begin_row_write = &host_begin_row_write;
+    slot.end_row_write = &host_end_row_write;
+    slot.begin_batch = &host_begin_batch;
+    slot.commit_batch = &host_commit_batch;
+    slot.writer_range = config.shard_writers ? &host_writer_range : nullptr;
+    switch (config.notify_mode) {
+    case NotifyMode::Bitmap:
+        slot.notify_row_dirty = &host_notify_row_dirty_bitmap;
+        break;
+    case NotifyMode::Broadcast:
+        slot.notify_row_dirty = &host_notify_row_dirty_broadcast;
+        break;
+    case NotifyMode::Queue:
+    case NotifyMode::WriterRings:
+        slot.notify_row_dirty = &host_notify_row_dirty;
+        break;
+    }
+    if (config.notify_mode == NotifyMode::WriterRings) {
+        slot.register_writer = &host_register_writer;
+        slot.unregister_writer = &host_unregister_writer;
+        slot.notify_row_dirty_from = &host_notify_row_dirty_from;
+    }
+}
 
-            if (std::memcmp(&snap, &ctx.last[i], sizeof snap) != 0) {
-                std::printf("Row %6u  ts=%lld  px=%lld  qty=%lld  side=%u\n", i, (long long)snap.ts,
-                            (long long)snap.px, (long long)snap.qty, snap.side);
-                ctx.last[i] = snap;
-                ++printed;
-            }
-        }
+void update_latest_data_from_context(HostContext& ctx, const EmspConfig& config, uint64_t t,
+                                     uint64_t next_paint, const HostMDSlot& slot) {
+    (void)config;
+    PROFILE_SCOPE("update_latest_data_from_context");
+    if (t >= next_paint) {
+        // Performance critical: the one ingest cycle, change sets go to ctx.changes listeners
+        run_ingest_cycle(ctx, slot);
+        return;
     }
+    // Between paints only keep the channel drained so bounded rings do not overflow
+    drain_dirty_notifications(ctx);
 }
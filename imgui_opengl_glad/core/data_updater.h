@@ -3,7 +3,9 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <string>
 
+#include "change_sink.h"
 #include "main_context.h"
 
 /**
@@ -13,14 +15,56 @@ struct EmspConfig {
     uint32_t num_rows = 10000;  ///< Number of data rows
     uint32_t writers = 2;       ///< Number of writer threads
     uint32_t ups = 50000;       ///< Updates per second
+    NotifyMode notify_mode = NotifyMode::Queue;  ///< Row-change notification channel
+    BroadcastPolicy broadcast_policy = BroadcastPolicy::Gated;  ///< NotifyMode::Broadcast only
+    bool shard_writers = false;  ///< Give each writer thread its own row partition
+    SeqLayout seq_layout = SeqLayout::Dense;  ///< Memory layout of the per-row seq counters
+    RowStorage row_storage = RowStorage::Columns;  ///< Lines implies SeqLayout::Colocated
+    ArenaSize arena_size = ArenaSize::None;  ///< Host arena size class (None = heap)
+    bool huge_pages = true;                  ///< Back the arena with huge pages when possible
+    uint32_t ingest_period_us = 1000;  ///< Minimum time between ingest cycles, 0 = back to back
+    bool headless = false;             ///< No window: change sets go to the sink instead
+    SinkKind sink = SinkKind::Null;    ///< Headless output format
+    std::string sink_path;             ///< Headless output file, "-" = stdout
+    uint32_t sink_buffer_kb = 4096;    ///< Headless write buffer, one fwrite each time it fills
+    uint32_t duration_s = 0;           ///< Headless run time, 0 = until SIGINT/SIGTERM
+    uint32_t latency_ms = 16;          ///< GUI: new data is painted within this, see FramePacer
+    uint32_t idle_ms = 500;            ///< GUI: repaint interval with no data and no input
+    bool vsync = true;                 ///< GUI: off = swap at once (low-latency mode)
+    uint32_t work_budget_us = 4000;    ///< GUI: table sort/filter/group time per ingest cycle
+    bool latency_stats = true;         ///< Record tick-to-pixel latency histograms
+    std::string latency_out;           ///< Latency report written at exit, empty = none
+    bool profiler = true;              ///< Stage probes on (GUI default), see profiler.h
+    std::string trace_out;             ///< Chrome trace written at exit, empty = none
 };
 
+/**
+ * @brief Wires a HostContext and HostMDSlot to host-owned column buffers
+ *
+ * Sizes all per-row host state for config.num_rows, initializes the notification
+ * channel selected by config.notify_mode and installs the matching host callbacks
+ * in the slot. With RowStorage::Lines the rows live in host-owned MDRowLine blocks
+ * and the column buffers are left unused. When config.arena_size is set (or ctx.arena
+ * was reserved by the caller) every buffer, including the columns, is carved from the
+ * arena and the column vectors passed in are not used either.
+ *
+ * @param ctx The host context to initialize
+ * @param slot The slot handed to the plugin
+ * @param config Configuration parameters for the system
+ * @param ts_ns, px_n, qty, side Column buffers, each config.num_rows long
+ */
+void initializeHostContext(HostContext& ctx, HostMDSlot& slot, const EmspConfig& config,
+                           std::vector<int64_t>& ts_ns, std::vector<int64_t>& px_n,
+                           std::vector<int64_t>& qty, std::vector<uint8_t>& side);
+
 /**
  * @brief Updates the latest market data from the context
  *
- * This function processes queued row updates and optionally prints changed rows
- * when the paint interval has elapsed. It's designed to be called in the main
- * rendering loop to keep the display synchronized with incoming market data.
+ * The host's ingest stage, driven by the caller's clock. Every call drains the
+ * notification channel; once the paint interval has elapsed it runs run_ingest_cycle,
+ * which snapshots and publishes the changed rows and delivers their ChangeSet to every
+ * ctx.changes listener (the table, the navigator). The GUI runs the cycles on an
+ * IngestThread (ingest_thread.h) instead, decoupled from its frames.
  *
  * @param ctx The host context containing the data structures
  * @param config Configuration parameters for the system
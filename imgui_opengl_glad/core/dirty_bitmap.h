@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "arena.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Performance critical: inline count-trailing-zeros, v must be non-zero (hot path)
+static inline uint32_t ctz64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctzll(v);
+#endif
+}
+
+// Lock-free dirty-row bitmap used as an alternative to MPSCQueue for change
+// notifications. Producers set one bit per row; the consumer swaps whole 64-bit
+// words out and walks the set bits. Repeated notifications for the same row
+// between two drains coalesce into one bit, memory is fixed at num_rows / 8 bytes
+// and marking can never overflow.
+struct AtomicDirtyBitmap {
+    // Eight words per cache line; allocated as whole lines so neighbouring bitmaps
+    // or other host state never share a line with the words producers hammer.
+    struct alignas(64) Line {
+        std::atomic<uint64_t> w[8];
+    };
+
+    ArenaArray<Line> lines;
+    uint32_t num_words{0};
+
+    void init(uint32_t num_rows, Arena* arena = nullptr) {
+        uint32_t num_lines = (num_rows + 511) / 512;
+        lines = make_arena_array<Line>(arena, num_lines, "dirty bitmap");
+        num_words = num_lines * 8;
+        // Performance critical: clear every word once at startup
+        for (uint32_t i = 0; i < num_words; ++i)
+            word(i).store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t>& word(uint32_t i) {
+        return lines[i >> 3].w[i & 7];
+    }
+
+    // The relaxed pre-check keeps hot rows that are already pending from issuing an RMW on
+    // a contended line. It must not be reordered before the caller's row stores: a stale
+    // set bit, seen after the consumer swapped the word out and read the old values, would
+    // lose the update for good. The fence pairs with the one in drain(): either the
+    // pre-check sees the bit cleared, or the consumer's reads see the new values.
+    // Performance critical: inline producer mark (hot path)
+    inline void mark(uint32_t row) {
+        std::atomic<uint64_t>& w = word(row >> 6);
+        uint64_t bit = 1ull << (row & 63);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((w.load(std::memory_order_relaxed) & bit) == 0)
+            w.fetch_or(bit, std::memory_order_release);
+    }
+
+    // Performance critical: inline consumer drain, calls fn(row) once per pending row
+    // and clears it. Returns the number of rows visited.
+    template <typename Fn>
+    inline uint32_t drain(Fn&& fn) {
+        uint32_t count = 0;
+        // Performance critical: word scan, empty words cost one relaxed load
+        for (uint32_t i = 0; i < num_words; ++i) {
+            std::atomic<uint64_t>& w = word(i);
+            if (w.load(std::memory_order_relaxed) == 0)
+                continue;
+            uint64_t bits = w.exchange(0, std::memory_order_acquire);
+            // The rows are read after the bits are cleared, see mark()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t base = i << 6;
+            // Performance critical: walk set bits with ctz
+            while (bits) {
+                fn(base + ctz64(bits));
+                bits &= bits - 1;
+                ++count;
+            }
+        }
+        return count;
+    }
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "platform.h"
+
+// Decides when the render loop paints and how long it may sleep in between, instead of
+// polling events and painting every vsync whether anything changed or not. A frame is due
+//   - for input: right away, plus input_frames - 1 more so ImGui hover and layout settle,
+//   - for new data: at once if the last paint is latency_us old, else when it is; a change
+//     is on screen within latency_us and a steady stream paints at most that often,
+//   - otherwise after idle_us, so clocks and counters still move.
+// Until then the loop blocks in glfwWaitEventsTimeout(wait_us). The ingest thread reports
+// data through notify_data, which calls wake (glfwPostEmptyEvent) at most once per painted
+// frame to end the wait early. Times are microseconds of lib_now on both threads.
+struct FramePacer {
+    enum Reason : uint8_t { None, Input, Data, Idle, kReasons };
+
+    uint32_t latency_us{16000};
+    uint32_t idle_us{500000};
+    uint32_t input_frames{3};
+    void (*wake)(){nullptr};  // thread-safe wake-up of the waiting render thread
+
+    // Ingest thread side
+    alignas(64) std::atomic<uint64_t> data_seq{0};
+    std::atomic<int64_t> data_since{0};  // arrival of the oldest unpainted data, 0 = none
+    std::atomic<bool> wake_posted{false};
+
+    // Render thread side
+    alignas(64) uint64_t painted_seq{0};
+    int64_t last_paint{0};
+    int64_t frame_data_since{0};  // data_since taken by begin_frame
+    uint32_t input_left{0};
+
+    struct Stats {
+        uint64_t frames[kReasons]{};  // painted frames by Reason
+        uint64_t waits{0};            // blocking waits for events
+        uint64_t wakes{0};            // empty events posted by notify_data
+        uint64_t data_frames{0};      // frames that showed new data (any reason)
+        uint64_t latency_sum_us{0};   // data arrival to end of the frame showing it
+        uint32_t latency_max_us{0};
+    };
+    Stats stats;
+
+    static int64_t now_us() {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(lib_now().time_since_epoch()).count();
+    }
+
+    // Ingest thread: something new to draw arrived at now
+    void notify_data(int64_t now) {
+        // Arrival time first: the release on data_seq publishes it, so a begin_frame that
+        // sees the new seq also takes this data_since instead of 0
+        int64_t none = 0;
+        data_since.compare_exchange_strong(none, std::max<int64_t>(now, 1),
+                                           std::memory_order_relaxed);
+        data_seq.fetch_add(1, std::memory_order_release);
+        if (!wake_posted.exchange(true, std::memory_order_acq_rel)) {
+            ++stats.wakes;
+            if (wake)
+                wake();
+        }
+    }
+
+    // Render thread (GLFW input callbacks): the user did something
+    void note_input() {
+        input_left = input_frames;
+    }
+
+    bool data_pending() const {
+        return data_seq.load(std::memory_order_acquire) != painted_seq;
+    }
+
+    // Render thread: the frame due at now, None to keep waiting
+    Reason next_paint(int64_t now) const {
+        if (input_left)
+            return Input;
+        const int64_t since = now - last_paint;
+        if (since >= (int64_t)latency_us && data_pending())
+            return Data;
+        if (since >= (int64_t)idle_us)
+            return Idle;
+        return None;
+    }
+
+    // Render thread: how long to wait for events before the next frame is due
+    int64_t wait_us(int64_t now) const {
+        if (input_left)
+            return 0;
+        int64_t due = last_paint + idle_us;
+        if (data_pending())
+            due = std::min(due, last_paint + (int64_t)latency_us);
+        return std::max<int64_t>(0, due - now);
+    }
+
+    // Render thread: before the frame reads the views. Re-arms the wake-up first, so data
+    // arriving from here on posts a new one and is not lost behind this frame.
+    void begin_frame(Reason reason, int64_t now) {
+        wake_posted.store(false, std::memory_order_release);
+        const uint64_t seq = data_seq.load(std::memory_order_acquire);
+        frame_data_since = seq != painted_seq ? data_since.exchange(0, std::memory_order_relaxed)
+                                              : 0;
+        painted_seq = seq;
+        last_paint = now;
+        if (input_left)
+            --input_left;
+        ++stats.frames[reason];
+    }
+
+    // Render thread: after the buffer swap
+    void end_frame(int64_t now) {
+        if (frame_data_since == 0)
+            return;
+        const uint32_t us = (uint32_t)std::max<int64_t>(0, now - frame_data_since);
+        ++stats.data_frames;
+        stats.latency_sum_us += us;
+        stats.latency_max_us = std::max(stats.latency_max_us, us);
+        frame_data_since = 0;
+    }
+
+    void print_report(FILE* out) const {
+        const uint64_t frames =
+            stats.frames[Input] + stats.frames[Data] + stats.frames[Idle];
+        std::fprintf(out,
+                     "Frames: %llu (input %llu, data %llu, idle %llu), %llu waits, %llu wakes, "
+                     "data to screen avg %.1f ms max %.1f ms\n",
+                     (unsigned long long)frames, (unsigned long long)stats.frames[Input],
+                     (unsigned long long)stats.frames[Data],
+                     (unsigned long long)stats.frames[Idle], (unsigned long long)stats.waits,
+                     (unsigned long long)stats.wakes,
+                     stats.data_frames ? stats.latency_sum_us / 1000.0 / stats.data_frames : 0.0,
+                     stats.latency_max_us / 1000.0);
+    }
+};
@@ -0,0 +1,298 @@
+#include "host_app.h"
+
+#include <atomic>
+#include <csignal>
+#include <memory>
+#include <vector>
+
+#include "change_sink.h"
+#include "ingest_thread.h"
+
+bool loadMarketDataPlugin(PluginHandle& plugin, HostMDSlot& slot) {
+#ifdef _WIN32
+    const char* libname = "md_plugin.dll";
+#elif __APPLE__
+    const char* libname = "libmd_plugin.dylib";
+#else
+    const char* libname = "libmd_plugin.so";
+#endif
+
+    plugin.handle = lib_open(libname);
+    if (!plugin.handle) {
+#ifdef _WIN32
+        fprintf(stderr, "Failed to load %s\n", libname);
+#else
+        fprintf(stderr, "Failed to load %s: %s\n", libname, dlerror());
+#endif
+        return false;
+    }
+
+    typedef MD_API (*GetApiFn)(uint32_t);
+    auto get_api = (GetApiFn)lib_sym(plugin.handle, "get_marketdata_api");
+    if (!get_api) {
+        fprintf(stderr, "Symbol get_marketdata_api not found.\n");
+        return false;
+    }
+
+    // Ask for the newest API first; v1 plugins answer only to 1 and skip the batch calls.
+    // Performance critical: no, start-up only
+    uint32_t version = MD_API_VERSION;
+    for (; version >= 1; --version) {
+        plugin.api = get_api(version);
+        if (plugin.api.api_version == version)
+            break;
+    }
+    if (version == 0 || !plugin.api.bind_host_buffers || !plugin.api.start ||
+        !plugin.api.stop) {
+        fprintf(stderr, "Plugin API mismatch.\n");
+        plugin.api = {};  // Clear invalid API
+        return false;
+    }
+
+    if (!plugin.handle) {
+        fprintf(stderr, "loading handle failed.\n");
+        return false;
+    }
+
+    if (plugin.api.api_version == 0) {
+        fprintf(stderr, "api_version is 0 which is invalid \n");
+        return false;
+    }
+
+    fprintf(stderr, "Plugin API v%u\n", plugin.api.api_version);
+
+    if (slot.row_lines && plugin.api.api_version < 4) {
+        fprintf(stderr, "--storage=lines needs a plugin with API v4 or newer.\n");
+        return false;
+    }
+
+    if (plugin.api.bind_host_buffers(&slot) != 0) {
+        fprintf(stderr, "bind_host_buffers failed.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Usage: emsp [num_rows] [writers] [updates_per_sec] 
+//             [--notify=queue|bitmap|rings|broadcast|broadcast-lossy] [--shard]
+//             [--seq=dense|grouped|padded] [--storage=columns|lines]
+//             [--arena=xs|s|m|l|xl|xxl] [--no-hugepages] [--ingest-us=N]
+//             [--headless] [--sink=null|text|binary] [--out=path] [--sink-kb=N]
+//             [--duration=seconds] [--latency-ms=N] [--idle-ms=N] [--vsync=on|off]
+//             [--work-budget-us=N] [--no-latency-stats] [--latency-out=path]
+//             [--profiler=on|off] [--trace-out=path]
+EmspConfig parseCommandLineArguments(int argc, char** argv, bool headless) {
+    EmspConfig config;
+    config.headless = headless;
+
+    bool period_given = false;
+    bool latency_given = false;
+    bool profiler_given = false;
+    int positional = 0;
+    // Performance critical: no, start-up only
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--", 2) == 0) {
+            if (std::strcmp(arg, "--notify=bitmap") == 0)
+                config.notify_mode = NotifyMode::Bitmap;
+            else if (std::strcmp(arg, "--notify=broadcast") == 0)
+                config.notify_mode = NotifyMode::Broadcast;
+            else if (std::strcmp(arg, "--notify=broadcast-lossy") == 0) {
+                config.notify_mode = NotifyMode::Broadcast;
+                config.broadcast_policy = BroadcastPolicy::Lossy;
+            } else if (std::strcmp(arg, "--notify=rings") == 0)
+                config.notify_mode = NotifyMode::WriterRings;
+            else if (std::strcmp(arg, "--notify=queue") == 0)
+                config.notify_mode = NotifyMode::Queue;
+            else if (std::strcmp(arg, "--shard") == 0)
+                config.shard_writers = true;
+            else if (std::strcmp(arg, "--seq=dense") == 0)
+                config.seq_layout = SeqLayout::Dense;
+            else if (std::strcmp(arg, "--seq=grouped") == 0)
+                config.seq_layout = SeqLayout::Grouped;
+            else if (std::strcmp(arg, "--seq=padded") == 0)
+                config.seq_layout = SeqLayout::Padded;
+            else if (std::strcmp(arg, "--storage=columns") == 0)
+                config.row_storage = RowStorage::Columns;
+            else if (std::strcmp(arg, "--storage=lines") == 0)
+                config.row_storage = RowStorage::Lines;
+            else if (std::strncmp(arg, "--arena=", 8) == 0) {
+                if (!parse_arena_size(arg + 8, config.arena_size))
+                    fprintf(stderr, "Unknown arena size %s (xs|s|m|l|xl|xxl)\n", arg + 8);
+            } else if (std::strcmp(arg, "--no-hugepages") == 0)
+                config.huge_pages = false;
+            else if (std::strncmp(arg, "--ingest-us=", 12) == 0) {
+                config.ingest_period_us = (uint32_t)std::strtoul(arg + 12, nullptr, 10);
+                period_given = true;
+            } else if (std::strcmp(arg, "--headless") == 0)
+                config.headless = true;
+            else if (std::strncmp(arg, "--sink=", 7) == 0) {
+                if (!parse_sink_kind(arg + 7, config.sink))
+                    fprintf(stderr, "Unknown sink %s (null|text|binary)\n", arg + 7);
+            } else if (std::strncmp(arg, "--out=", 6) == 0)
+                config.sink_path = arg + 6;
+            else if (std::strncmp(arg, "--sink-kb=", 10) == 0)
+                config.sink_buffer_kb = (uint32_t)std::strtoul(arg + 10, nullptr, 10);
+            else if (std::strncmp(arg, "--duration=", 11) == 0)
+                config.duration_s = (uint32_t)std::strtoul(arg + 11, nullptr, 10);
+            else if (std::strncmp(arg, "--latency-ms=", 13) == 0) {
+                config.latency_ms = (uint32_t)std::strtoul(arg + 13, nullptr, 10);
+                latency_given = true;
+            } else if (std::strncmp(arg, "--idle-ms=", 10) == 0)
+                config.idle_ms = std::max(1u, (uint32_t)std::strtoul(arg + 10, nullptr, 10));
+            else if (std::strcmp(arg, "--vsync=on") == 0)
+                config.vsync = true;
+            else if (std::strcmp(arg, "--vsync=off") == 0)
+                config.vsync = false;
+            else if (std::strncmp(arg, "--work-budget-us=", 17) == 0)
+                config.work_budget_us = (uint32_t)std::strtoul(arg + 17, nullptr, 10);
+            else if (std::strcmp(arg, "--no-latency-stats") == 0)
+                config.latency_stats = false;
+            else if (std::strncmp(arg, "--latency-out=", 14) == 0)
+                config.latency_out = arg + 14;
+            else if (std::strcmp(arg, "--profiler=on") == 0 ||
+                     std::strcmp(arg, "--profiler=off") == 0) {
+                config.profiler = arg[12] == 'n';
+                profiler_given = true;
+            } else if (std::strncmp(arg, "--trace-out=", 12) == 0)
+                config.trace_out = arg + 12;
+            else
+                fprintf(stderr, "Ignoring unknown option %s\n", arg);
+            continue;
+        }
+        uint32_t v = (uint32_t)std::strtoul(arg, nullptr, 10);
+        switch (positional++) {
+        case 0:
+            config.num_rows = std::max(100u, v);
+            break;
+        case 1:
+            config.writers = std::max(1u, v);
+            break;
+        case 2:
+            config.ups = std::max(100u, v);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Headless runs the ingest stage back to back unless told otherwise; the GUI has no
+    // use for more cycles than it can show
+    if (config.headless && !period_given)
+        config.ingest_period_us = 0;
+    // Back to back cycles are short enough for the probes to show; headless profiles only
+    // when asked to, or when a trace is wanted
+    if (config.headless && !profiler_given)
+        config.profiler = !config.trace_out.empty();
+    // Without vsync the swap no longer waits for the display, so new data can go out as soon
+    // as it arrives; 4 ms still coalesces a steady stream into 250 frames/s at most
+    if (!config.vsync && !latency_given)
+        config.latency_ms = 4;
+    if (config.sink == SinkKind::Binary && config.sink_path.empty())
+        config.sink_path = "changes.bin";
+    return config;
+}
+
+
+namespace {
+
+std::atomic<bool> g_stop_requested{false};
+
+void on_stop_signal(int) {
+    g_stop_requested.store(true);
+}
+
+}  // namespace
+
+int run_headless(const EmspConfig& config) {
+    // Same host state as the GUI, minus the window
+    const uint32_t heap_rows = config.arena_size == ArenaSize::None ? config.num_rows : 0;
+    std::vector<int64_t> ts_ns(heap_rows, 0);
+    std::vector<int64_t> px_n(heap_rows, 0);
+    std::vector<int64_t> qty(heap_rows, 0);
+    std::vector<uint8_t> side(heap_rows, 0);
+
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    const char* out_path = config.sink_path.empty() ? "-" : config.sink_path.c_str();
+    fprintf(stderr, "Headless rows=%u writers=%u updates/sec=%u notify=%s sink=%s out=%s\n",
+            config.num_rows, config.writers, config.ups, notify_mode_name(config.notify_mode),
+            sink_kind_name(config.sink), config.sink == SinkKind::Null ? "none" : out_path);
+    if (config.arena_size != ArenaSize::None)
+        ctx.arena.print_report(stderr);  // stdout may be the sink
+
+    std::unique_ptr<ChangeSink> sink = make_change_sink(
+        config.sink, config.sink_path.c_str(), (size_t)config.sink_buffer_kb << 10);
+    if (!sink)
+        return 1;
+    PluginHandle plugin;
+    if (!loadMarketDataPlugin(plugin, slot))
+        return 1;
+
+    // The sink is the only view: it runs on the ingest thread, after each publish
+    ChangeSink& out = *sink;
+    const int32_t sub = ctx.changes.subscribe([&out](const ChangeSet& changes) {
+        PROFILE_SCOPE("sink write");
+        out.write(changes);
+    });
+
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+    IngestThread ingest;
+    plugin.api.start(config.writers, config.ups);
+    ingest.start(ctx, slot, config.ingest_period_us);
+
+    const auto start = lib_now();
+    auto last = start;
+    uint64_t last_rows = 0;
+    // Performance critical: the main thread only reports, once a second
+    while (!g_stop_requested.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto now = lib_now();
+        const double secs = std::chrono::duration<double>(now - last).count();
+        if (secs < 1.0)
+            continue;
+        const uint64_t rows = ingest.rows.load(std::memory_order_relaxed);
+        fprintf(stderr, "  %llu cycles, %.0f rows/s, last cycle %u us, slowest %u us\n",
+                (unsigned long long)ingest.cycles.load(std::memory_order_relaxed),
+                (rows - last_rows) / secs, ingest.last_cycle_us.load(std::memory_order_relaxed),
+                ingest.max_cycle_us.load(std::memory_order_relaxed));
+        last = now;
+        last_rows = rows;
+        if (config.duration_s &&
+            std::chrono::duration<double>(now - start).count() >= config.duration_s)
+            break;
+    }
+
+    // Writers first, then one last cycle picks up what they left, then the sink drains
+    plugin.api.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ingest.stop();
+    run_ingest_cycle(ctx, slot);
+    ctx.changes.unsubscribe(sub);
+    const bool ok = out.flush();
+
+    const double secs = std::chrono::duration<double>(lib_now() - start).count();
+    fprintf(stderr, "Ingest: %llu cycles, %llu rows in %.1f s (%.0f rows/s)\n",
+            (unsigned long long)ingest.cycles.load(), (unsigned long long)ingest.rows.load(),
+            secs, ingest.rows.load() / secs);
+    fprintf(stderr, "Sink %s: %llu sets, %llu rows, %.1f MB in %llu writes%s\n",
+            sink_kind_name(config.sink), (unsigned long long)out.sets,
+            (unsigned long long)out.rows, out.bytes / 1048576.0,
+            (unsigned long long)out.writes, ok ? "" : " (FAILED)");
+    fprintf(stderr, "Snapshots: %llu rows, %llu torn, %llu failed (deferred)\n",
+            (unsigned long long)ctx.snap_stats.rows, (unsigned long long)ctx.snap_stats.torn,
+            (unsigned long long)ctx.snap_stats.failures);
+    if (!config.trace_out.empty() &&
+        Profiler::global().export_chrome_trace(config.trace_out.c_str()))
+        fprintf(stderr, "Trace written to %s\n", config.trace_out.c_str());
+    if (ctx.latency.on()) {
+        // No view or pixel stage here: the sink is the last stage
+        ctx.latency.write_summary(stderr);
+        if (!config.latency_out.empty() && ctx.latency.dump(config.latency_out.c_str()))
+            fprintf(stderr, "Latency report written to %s\n", config.latency_out.c_str());
+    }
+    return ok ? 0 : 1;
+}
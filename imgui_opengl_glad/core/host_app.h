@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#include "data_updater.h"
+
+// Host process plumbing shared by the GUI (main.cpp) and headless (headless_main.cpp)
+// executables: plugin loading, command line, and the headless run loop.
+
+struct PluginHandle {
+    LibHandle handle{};
+    MD_API api{};
+    void Cleanup() {
+        if (api.stop) {
+            // Stop the API if not already stopped
+            api.stop();
+            // Give threads time to finish
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        if (handle) {
+            lib_close(handle);
+        }
+        handle = nullptr;
+        api = {};
+    }
+    ~PluginHandle() {
+        Cleanup();
+    }
+};
+
+/**
+ * @brief Loads md_plugin from the working directory and binds it to slot
+ *
+ * Negotiates the newest API version both sides support and checks that the plugin
+ * can serve the slot's storage. Prints the reason to stderr and returns false on failure.
+ */
+bool loadMarketDataPlugin(PluginHandle& plugin, HostMDSlot& slot);
+
+/**
+ * @brief Parses the emsp command line; unknown options are reported and ignored
+ *
+ * @param headless Start from headless mode, as if --headless were given (emsp_headless)
+ */
+EmspConfig parseCommandLineArguments(int argc, char** argv, bool headless = false);
+
+/**
+ * @brief Runs the host without a window
+ *
+ * Starts the plugin and an IngestThread and writes every change set to the sink chosen
+ * by config.sink, until config.duration_s has passed or SIGINT/SIGTERM arrives. Prints a
+ * progress line to stderr every second and a summary at the end.
+ *
+ * @return 0 on success, non zero when the plugin, the sink or a write failed
+ */
+int run_headless(const EmspConfig& config);
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "work_budget.h"
+
+// Merge sort run in slices: step() works until its WorkBudget runs out and the next call
+// picks up where it stopped. Every element's key is read once, by key_of, into (key, value)
+// entries; runs of kRun entries are sorted with std::sort, then merged pairwise one pass at
+// a time between two entry buffers, and the values are written back in order at the end.
+// Nothing else may touch the data between start() and the step() returning true. Keys may
+// move meanwhile: every slice compares the captured keys, so the result is exactly ordered
+// by the keys as they were captured, and the caller re-places what changed since (see
+// reinsert_changed).
+template <typename T, typename Key = T>
+struct IncrementalSort {
+    static constexpr size_t kRun = 4096;
+    static constexpr size_t kMergeChunk = 4096;  // elements merged per budget check
+
+    enum Phase : uint8_t { Capture, Runs, Merge, WriteBack, Done };
+
+    struct Entry {
+        Key key;
+        T value;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+    Phase phase{Done};
+    size_t n{0};
+    size_t width{0};     // merge pass: length of the sorted runs being paired
+    size_t pos{0};       // start of the current run, pair or copy block
+    size_t left{0}, right{0}, out{0};  // cursors of the pair being merged
+    bool in_pair{false};
+    bool in_scratch{false};  // the latest pass wrote to scratch
+    uint64_t units_done{0};
+    uint64_t units_total{0};
+
+    void start(size_t count) {
+        n = count;
+        phase = n > 1 ? Capture : Done;
+        width = kRun;
+        pos = 0;
+        in_pair = false;
+        in_scratch = false;
+        entries.resize(n);  // capacity kept across sorts
+        scratch.resize(n);
+        size_t passes = 0;
+        // Performance critical: log2(n / kRun) iterations
+        for (size_t w = kRun; w < n; w *= 2)
+            ++passes;
+        units_done = 0;
+        units_total = (uint64_t)n * (3 + passes);
+    }
+
+    bool done() const {
+        return phase == Done;
+    }
+
+    uint32_t permille() const {
+        if (phase == Done)
+            return 1000;
+        return (uint32_t)(units_done * 1000 / units_total);
+    }
+
+    // Sorts data[0, n) by less on the key_of(value) captured first, until done (true) or the
+    // budget is spent (false)
+    template <typename KeyOf, typename Less>
+    bool step(T* data, KeyOf key_of, Less less, WorkBudget& budget) {
+        // Performance critical: one key read per element, kMergeChunk per check
+        while (phase == Capture) {
+            if (pos >= n) {
+                phase = Runs;
+                pos = 0;
+                break;
+            }
+            if (!budget.spend(kMergeChunk))
+                return false;
+            const size_t end = std::min(n, pos + kMergeChunk);
+            // Performance critical: the capture loop
+            for (size_t i = pos; i < end; ++i)
+                entries[i] = Entry{key_of(data[i]), data[i]};
+            units_done += end - pos;
+            pos = end;
+        }
+
+        auto entry_less = [&less](const Entry& a, const Entry& b) { return less(a.key, b.key); };
+        // Performance critical: sorted runs, one budget check each
+        while (phase == Runs) {
+            if (pos >= n) {
+                phase = width < n ? Merge : WriteBack;
+                pos = 0;
+                break;
+            }
+            if (!budget.spend(kRun))
+                return false;
+            const size_t end = std::min(n, pos + kRun);
+            std::sort(entries.begin() + pos, entries.begin() + end, entry_less);
+            units_done += end - pos;
+            pos = end;
+        }
+
+        // Performance critical: one merge pass per doubling of width, kMergeChunk per check
+        while (phase == Merge) {
+            const Entry* src = in_scratch ? scratch.data() : entries.data();
+            Entry* dst = in_scratch ? entries.data() : scratch.data();
+            if (pos >= n) {
+                in_scratch = !in_scratch;
+                width *= 2;
+                pos = 0;
+                if (width >= n)
+                    phase = WriteBack;
+                continue;
+            }
+            const size_t mid = std::min(n, pos + width);
+            const size_t end = std::min(n, pos + 2 * width);
+            if (!in_pair) {
+                left = pos;
+                right = mid;
+                out = pos;
+                in_pair = true;
+            }
+            // Performance critical: merge of one pair, resumable at any element
+            while (out < end) {
+                if (!budget.spend(kMergeChunk))
+                    return false;
+                const size_t stop = std::min(end, out + kMergeChunk);
+                units_done += stop - out;
+                // Performance critical: the inner merge loop
+                while (out < stop) {
+                    if (right >= end || (left < mid && !entry_less(src[right], src[left])))
+                        dst[out++] = src[left++];
+                    else
+                        dst[out++] = src[right++];
+                }
+            }
+            in_pair = false;
+            pos = end;
+        }
+
+        // Performance critical: values back into data in order, kMergeChunk per check
+        while (phase == WriteBack) {
+            if (pos >= n) {
+                phase = Done;
+                break;
+            }
+            if (!budget.spend(kMergeChunk))
+                return false;
+            const Entry* sorted = in_scratch ? scratch.data() : entries.data();
+            const size_t end = std::min(n, pos + kMergeChunk);
+            // Performance critical: the write-back loop
+            for (size_t i = pos; i < end; ++i)
+                data[i] = sorted[i].value;
+            units_done += end - pos;
+            pos = end;
+        }
+        return true;
+    }
+
+    // Sorts values by themselves (Key = T)
+    template <typename Less>
+    bool step(T* data, Less less, WorkBudget& budget) {
+        return step(data, [](const T& value) { return value; }, less, budget);
+    }
+};
+
+// Puts rows whose sort keys moved back in order: rows[0, n) was sorted by less before the
+// keys of the k distinct rows in changed moved, and mark[row] is set for exactly those rows.
+// They are taken out in one compaction pass, sorted among themselves, then merged back from
+// the end, each placed by binary search among the rows that stayed. O(k log n) comparisons
+// and at most n element moves, against n log n comparisons for a full sort. changed is
+// sorted in place and every mark is cleared.
+template <typename Less>
+void reinsert_changed(uint32_t* rows, size_t n, uint32_t* changed, size_t k, uint8_t* mark,
+                      Less less) {
+    if (k == 0)
+        return;
+    size_t kept = 0;
+    // Performance critical: one sequential pass, no comparisons
+    for (size_t i = 0; i < n; ++i) {
+        if (!mark[rows[i]])
+            rows[kept++] = rows[i];
+    }
+    std::sort(changed, changed + k, less);
+    size_t end = kept;  // rows[0, end) are the stayed rows not yet moved right
+    size_t out = n;     // rows[out, n) are final
+    // Performance critical: one binary search and one block move per changed row
+    for (size_t j = k; j-- > 0;) {
+        const uint32_t row = changed[j];
+        const size_t pos = std::upper_bound(rows, rows + end, row, less) - rows;
+        // Performance critical: stayed rows after pos shift right as one block
+        std::move_backward(rows + pos, rows + end, rows + out);
+        out -= end - pos;
+        end = pos;
+        rows[--out] = row;
+        mark[row] = 0;
+    }
+}
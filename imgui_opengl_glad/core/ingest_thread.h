@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "main_context.h"
+
+// Runs the ingest stage (run_ingest_cycle) on a thread of its own, so draining,
+// publishing and the views' change-set listeners keep pace with the writers whatever the
+// render loop does; a vsync'ed buffer swap no longer throttles them to the display rate.
+// A cycle starts every period_us at most, and one that overruns is followed by the next
+// straight away without catching up. Period 0 runs cycles back to back (headless), only
+// yielding after one that found nothing to do. The ctx.changes listeners run on this thread:
+// subscribe before start(), unsubscribe after stop(), and hand results to the render thread
+// through an RcuSlot (rcu_slot.h) rather than shared members.
+struct IngestThread {
+    std::thread thread;
+    std::atomic<bool> stop_requested{false};
+    uint32_t period_us{1000};
+
+    // Written by the ingest thread, readable from any thread
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> rows{0};           // changed rows published
+    std::atomic<uint32_t> last_cycle_us{0};  // latest cycle, listeners included
+    std::atomic<uint32_t> max_cycle_us{0};
+
+    IngestThread() = default;
+    IngestThread(const IngestThread&) = delete;
+    IngestThread& operator=(const IngestThread&) = delete;
+    ~IngestThread() {
+        stop();
+    }
+
+    bool running() const {
+        return thread.joinable();
+    }
+
+    void start(HostContext& ctx, const HostMDSlot& slot, uint32_t period) {
+        if (running())
+            return;
+        period_us = period;
+        stop_requested.store(false, std::memory_order_relaxed);
+        thread = std::thread([this, &ctx, &slot] { run(ctx, slot); });
+    }
+
+    // Returns once the cycle in progress and its listeners have finished
+    void stop() {
+        if (!running())
+            return;
+        stop_requested.store(true, std::memory_order_release);
+        thread.join();
+    }
+
+    void run(HostContext& ctx, const HostMDSlot& slot) {
+        using namespace std::chrono;
+        Profiler::global().set_thread_name("ingest");
+        auto next = lib_now();
+        // Performance critical: one ingest cycle per period until stopped
+        while (!stop_requested.load(std::memory_order_acquire)) {
+            const auto begin = lib_now();
+            const uint32_t changed = run_ingest_cycle(ctx, slot);
+            const auto end = lib_now();
+            const uint32_t us = (uint32_t)duration_cast<microseconds>(end - begin).count();
+            rows.fetch_add(changed, std::memory_order_relaxed);
+            cycles.fetch_add(1, std::memory_order_relaxed);
+            last_cycle_us.store(us, std::memory_order_relaxed);
+            if (us > max_cycle_us.load(std::memory_order_relaxed))
+                max_cycle_us.store(us, std::memory_order_relaxed);
+
+            if (period_us == 0) {
+                if (changed == 0)
+                    std::this_thread::yield();
+                continue;
+            }
+            next += microseconds(period_us);
+            if (next > end)
+                std::this_thread::sleep_until(next);
+            else
+                next = end;
+        }
+    }
+};
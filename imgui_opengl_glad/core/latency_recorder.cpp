@@ -0,0 +1,150 @@
+#include "latency_recorder.h"
+
+#include <algorithm>
+
+const char* tick_stage_name(TickStage stage) {
+    switch (stage) {
+    case TickStage::Notify:
+        return "notify";
+    case TickStage::Snapshot:
+        return "snapshot";
+    case TickStage::Delivered:
+        return "delivered";
+    case TickStage::View:
+        return "view";
+    case TickStage::Pixel:
+        return "pixel";
+    }
+    return "?";
+}
+
+void LatencySnapshot::add(const LatencyHistogram& h) {
+    // Performance critical: one pass over the buckets per merged histogram
+    for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b)
+        counts[b] += h.counts[b].load(std::memory_order_relaxed);
+    total += h.total.load(std::memory_order_relaxed);
+    const uint64_t m = h.max.load(std::memory_order_relaxed);
+    if (m > max)
+        max = m;
+}
+
+void LatencySnapshot::subtract(const LatencySnapshot& base) {
+    uint32_t top = LatencyHistogram::kBuckets;
+    // Performance critical: one pass over the buckets
+    for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+        counts[b] = counts[b] > base.counts[b] ? counts[b] - base.counts[b] : 0;
+        if (counts[b])
+            top = b;
+    }
+    total = total > base.total ? total - base.total : 0;
+    if (top == LatencyHistogram::kBuckets)
+        max = 0;
+    else if (top + 1 < LatencyHistogram::kBuckets)
+        max = std::min(max, LatencyHistogram::bucket_low(top + 1) - 1);
+}
+
+uint64_t LatencySnapshot::percentile(double q) const {
+    uint64_t in_buckets = 0;
+    // Performance critical: one pass over the buckets
+    for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b)
+        in_buckets += counts[b];
+    if (in_buckets == 0)
+        return 0;
+    const uint64_t rank = (uint64_t)(q * (double)in_buckets + 0.5);
+    uint64_t seen = 0;
+    // Performance critical: cumulative walk to the rank
+    for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+        seen += counts[b];
+        if (seen >= rank && seen > 0) {
+            // Highest value of the bucket, as HdrHistogram reports, but never past max
+            const uint64_t high = b + 1 < LatencyHistogram::kBuckets
+                                      ? LatencyHistogram::bucket_low(b + 1) - 1
+                                      : max;
+            return high < max ? high : max;
+        }
+    }
+    return max;
+}
+
+LatencySummary summarize(const LatencySnapshot& snap) {
+    LatencySummary s;
+    s.count = snap.total;
+    s.p50 = snap.percentile(0.50);
+    s.p90 = snap.percentile(0.90);
+    s.p99 = snap.percentile(0.99);
+    s.p999 = snap.percentile(0.999);
+    s.max = snap.max;
+    return s;
+}
+
+void LatencyRecorder::merge(TickStage stage, LatencySnapshot& out) const {
+    const uint32_t n = used.load(std::memory_order_acquire);
+    // Performance critical: one histogram per recording thread
+    for (uint32_t t = 0; t < n; ++t)
+        out.add(threads[t]->stages[(uint32_t)stage]);
+}
+
+LatencySummary LatencyRecorder::summary(TickStage stage) const {
+    auto snap = std::make_unique<LatencySnapshot>();  // 16 KB, off the stack
+    merge(stage, *snap);
+    return summarize(*snap);
+}
+
+void LatencyRecorder::write_summary(FILE* out) const {
+    auto snap = std::make_unique<LatencySnapshot>();
+    std::fprintf(out, "# Tick age per stage, microseconds (plugin ts_ns to the stage)\n");
+    std::fprintf(out, "%-10s %12s %10s %10s %10s %10s %10s\n", "stage", "count", "p50", "p90",
+                 "p99", "p99.9", "max");
+    // Performance critical: five stages
+    for (uint32_t st = 0; st < kTickStages; ++st) {
+        *snap = LatencySnapshot{};
+        merge((TickStage)st, *snap);
+        const LatencySummary s = summarize(*snap);
+        std::fprintf(out, "%-10s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                     tick_stage_name((TickStage)st), (unsigned long long)s.count, s.p50 / 1e3,
+                     s.p90 / 1e3, s.p99 / 1e3, s.p999 / 1e3, s.max / 1e3);
+    }
+    if (const uint64_t lost = unclaimed.load(std::memory_order_relaxed))
+        std::fprintf(out, "# %llu samples from threads past the first %u not recorded\n",
+                     (unsigned long long)lost, kMaxThreads);
+}
+
+void LatencyRecorder::write_report(FILE* out) const {
+    write_summary(out);
+    auto snap = std::make_unique<LatencySnapshot>();
+    // Performance critical: five stages, each a pass over its non-empty buckets
+    for (uint32_t st = 0; st < kTickStages; ++st) {
+        *snap = LatencySnapshot{};
+        merge((TickStage)st, *snap);
+        if (snap->total == 0)
+            continue;
+        std::fprintf(out, "\n# stage %s\n%12s %14s %10s %14s\n", tick_stage_name((TickStage)st),
+                     "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+        uint64_t seen = 0;
+        // Performance critical: cumulative distribution, non-empty buckets only
+        for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            if (snap->counts[b] == 0)
+                continue;
+            seen += snap->counts[b];
+            const double pct = (double)seen / (double)snap->total;
+            const double value_us = LatencyHistogram::bucket_low(b) / 1e3;
+            if (pct < 1.0)
+                std::fprintf(out, "%12.3f %14.12f %10llu %14.2f\n", value_us, pct,
+                             (unsigned long long)seen, 1.0 / (1.0 - pct));
+            else
+                std::fprintf(out, "%12.3f %14.12f %10llu\n", value_us, pct,
+                             (unsigned long long)seen);
+        }
+    }
+}
+
+bool LatencyRecorder::dump(const char* path) const {
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "Cannot write latency report to %s\n", path);
+        return false;
+    }
+    write_report(f);
+    std::fclose(f);
+    return true;
+}
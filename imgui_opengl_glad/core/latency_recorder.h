@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+#include "platform.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Points a market data tick passes on its way to the screen. Each records the tick's age,
+// now minus the ts_ns the plugin stamped on the row (both steady_clock), when it gets there.
+enum class TickStage : uint8_t {
+    Notify,     // writer thread, row notification handed to the host channel
+    Snapshot,   // ingest thread, row read out of the seqlocked storage and published
+    Delivered,  // ingest thread, change-set listeners done with the cycle
+    View,       // ingest thread, table view holding the row handed to the render thread
+    Pixel,      // render thread, buffer swap of the first frame drawing that view
+};
+constexpr uint32_t kTickStages = 5;
+
+const char* tick_stage_name(TickStage stage);
+
+// Performance critical: inline most-significant-bit index, v must be non-zero (hot path)
+static inline uint32_t msb64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, v);
+    return (uint32_t)idx;
+#else
+    return 63u - (uint32_t)__builtin_clzll(v);
+#endif
+}
+
+// Log-linear (HDR-style) histogram of nanoseconds: exact below 128 ns, then 64 buckets per
+// power of two, so a value is within 1/64 of the bucket it lands in; anything past about
+// two minutes lands in the last bucket. One thread records with plain relaxed stores,
+// other threads may read at any time.
+struct LatencyHistogram {
+    static constexpr uint32_t kSubBits = 7;
+    static constexpr uint32_t kHalf = 1u << (kSubBits - 1);
+    static constexpr uint32_t kMaxShift = 30;
+    static constexpr uint32_t kBuckets = (kMaxShift + 2) * kHalf;
+
+    std::atomic<uint64_t> counts[kBuckets]{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> max{0};
+
+    static uint32_t bucket_of(uint64_t ns) {
+        if (ns < (1u << kSubBits))
+            return (uint32_t)ns;
+        const uint32_t shift = msb64(ns) - (kSubBits - 1);
+        if (shift > kMaxShift)
+            return kBuckets - 1;
+        return shift * kHalf + (uint32_t)(ns >> shift);
+    }
+
+    // Smallest value of bucket b
+    static uint64_t bucket_low(uint32_t b) {
+        if (b < (1u << kSubBits))
+            return b;
+        const uint32_t shift = b / kHalf - 1;
+        return (uint64_t)(b % kHalf + kHalf) << shift;
+    }
+
+    // Single writer: n samples of ns
+    void record(uint64_t ns, uint64_t n = 1) {
+        std::atomic<uint64_t>& c = counts[bucket_of(ns)];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        if (ns > max.load(std::memory_order_relaxed))
+            max.store(ns, std::memory_order_relaxed);
+    }
+};
+
+// Plain copy of histograms merged for reading; percentiles and reports work on these
+struct LatencySnapshot {
+    uint64_t counts[LatencyHistogram::kBuckets]{};
+    uint64_t total{0};
+    uint64_t max{0};
+
+    void add(const LatencyHistogram& h);
+    // Drops what base already counted (reset without touching the recording threads); max
+    // becomes the top of the highest bucket left, to bucket precision
+    void subtract(const LatencySnapshot& base);
+    // Value at or below which fraction q of the samples fall, to bucket precision
+    uint64_t percentile(double q) const;
+};
+
+struct LatencySummary {
+    uint64_t count{0};
+    uint64_t p50{0}, p90{0}, p99{0}, p999{0}, max{0};
+};
+
+// Per-thread histogram sets, one per TickStage. A thread claims its set on its first
+// record(), under a mutex; from then on it records into it without any synchronisation.
+// Readers merge every claimed set. Sets stay claimed when their thread exits.
+struct LatencyRecorder {
+    static constexpr uint32_t kMaxThreads = 64;
+
+    struct ThreadHistograms {
+        LatencyHistogram stages[kTickStages];
+    };
+
+    const uint64_t id{next_id()};  // per-thread cache key, never reused
+    std::atomic<bool> enabled{true};
+    std::unique_ptr<ThreadHistograms> threads[kMaxThreads];
+    std::atomic<uint32_t> used{0};
+    std::atomic<uint64_t> unclaimed{0};  // samples dropped: more threads than kMaxThreads
+    std::mutex claim_mutex;
+
+    bool on() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // Records n samples of a tick stamped tick_ns seen at now_ns; unstamped rows are skipped
+    void record(TickStage stage, int64_t tick_ns, int64_t now_ns, uint64_t n = 1) {
+        if (tick_ns <= 0 || !on())
+            return;
+        ThreadHistograms* mine = local();
+        if (!mine) {
+            unclaimed.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        mine->stages[(uint32_t)stage].record(now_ns > tick_ns ? (uint64_t)(now_ns - tick_ns) : 0,
+                                             n);
+    }
+
+    static int64_t now_ns() {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(lib_now().time_since_epoch()).count();
+    }
+
+    // Merges every thread's histogram of stage
+    void merge(TickStage stage, LatencySnapshot& out) const;
+    LatencySummary summary(TickStage stage) const;
+    // Percentile table of every stage, values in microseconds
+    void write_summary(FILE* out) const;
+    // The summary plus each stage's full distribution in the HdrHistogram .hgrm column
+    // layout, values in microseconds
+    void write_report(FILE* out) const;
+    bool dump(const char* path) const;
+
+  private:
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    ThreadHistograms* local() {
+        struct Cache {
+            uint64_t owner{0};
+            ThreadHistograms* histograms{nullptr};
+        };
+        static thread_local Cache cache;
+        if (cache.owner != id) {
+            cache.owner = id;
+            cache.histograms = claim();
+        }
+        return cache.histograms;
+    }
+
+    ThreadHistograms* claim() {
+        std::lock_guard<std::mutex> lock(claim_mutex);
+        const uint32_t n = used.load(std::memory_order_relaxed);
+        if (n >= kMaxThreads)
+            return nullptr;
+        threads[n] = std::make_unique<ThreadHistograms>();
+        used.store(n + 1, std::memory_order_release);
+        return threads[n].get();
+    }
+};
+
+LatencySummary summarize(const LatencySnapshot& snap);
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 #include "../include/md_api.h"
+#include "arena.h"
+#include "broadcast_ring.h"
+#include "change_set.h"
+#include "dirty_bitmap.h"
+#include "latency_recorder.h"
 #include "mpsc.h"
 #include "platform.h"
+#include "profiler.h"
+#include "published_rows.h"
+#include "seq_array.h"
+#include "spsc.h"
 
 /******************************************************************************
     Arena for preallocated memory used for entire lifetime of main program
@@ -28,46 +41,529 @@
         * Data is owned by main program, and will not change for the lifetime of the program
 */
 
+// How writers tell the host that a row changed. Chosen once at startup.
+enum class NotifyMode : uint8_t {
+    Queue,   // row ids pushed into a bounded MPSCQueue (one entry per update)
+    Bitmap,  // one bit per row in an AtomicDirtyBitmap (coalesced, never overflows)
+    WriterRings,  // one SPSCRing per registered writer thread, fanned in by the consumer;
+                  // writers that do not register fall back to the MPSCQueue
+    Broadcast,    // BroadcastRing read through one primary cursor. The views no longer
+                  // take cursors of their own: the ingest stage fans each cycle out to them
+                  // through ChangeFeed. The mode stays for its lossy policy, where producers
+                  // overwrite instead of failing and the consumer resyncs once it is lapped.
+};
+
+// Where the row fields live. Chosen once at startup.
+enum class RowStorage : uint8_t {
+    Columns,  // four host column arrays (ts_ns, px_n, qty, side), seq in a SeqArray
+    Lines,    // MDRowLine blocks: two complete rows plus their seq words per cache line
+};
+
+static_assert(sizeof(MDRowLine) == 64 && alignof(MDRowLine) == 64,
+              "MDRowLine must be exactly one cache line");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "MDRowLine::seq words are used as std::atomic<uint32_t>");
+
+// Performance critical: no, start-up and report output only
+static inline const char* notify_mode_name(NotifyMode mode) {
+    switch (mode) {
+    case NotifyMode::Bitmap:
+        return "bitmap";
+    case NotifyMode::WriterRings:
+        return "rings";
+    case NotifyMode::Broadcast:
+        return "broadcast";
+    case NotifyMode::Queue:
+        break;
+    }
+    return "queue";
+}
+
+// Per-row dirty flags plus the rows flagged since the last consume(), so a consumer visits
+// O(changed rows) instead of scanning the table. A row enters the list when its flag first
+// flips. The list holds up to 1/8 of the table; past that (or after mark_all) consume()
+// falls back to one pass over the flags, which is cheaper than the list at that density.
+// Single consumer thread; arena-backed when the host runs with --arena.
+struct DirtyFlags {
+    static constexpr uint32_t kListShift = 3;  // list capacity = rows >> kListShift
+
+    ArenaVector<uint8_t> flags;
+    ArenaVector<uint32_t> list;    // rows flagged since the last consume, each once
+    ArenaVector<uint32_t> taking;  // list being consumed, swapped with list
+    bool scan_all{false};          // list incomplete, consume scans the flags
+
+    DirtyFlags() = default;
+    DirtyFlags(size_t n, uint8_t value, const ArenaAllocator<uint8_t>& alloc)
+        : flags(n, value ? 1 : 0, alloc), list(ArenaAllocator<uint32_t>(alloc)),
+          taking(ArenaAllocator<uint32_t>(alloc)), scan_all(value && n) {
+        list.reserve(list_capacity());
+        taking.reserve(list_capacity());
+    }
+
+    size_t size() const {
+        return flags.size();
+    }
+    const uint8_t* data() const {
+        return flags.data();
+    }
+    uint8_t operator[](size_t i) const {
+        return flags[i];
+    }
+    size_t list_capacity() const {
+        return std::max<size_t>(64, flags.size() >> kListShift);
+    }
+
+    // Performance critical: one byte test, one append on the first flip (hot path)
+    void mark(uint32_t i) {
+        if (flags[i])
+            return;
+        flags[i] = 1;
+        if (scan_all)
+            return;
+        if (list.size() < list_capacity())
+            list.push_back(i);  // Performance critical: capacity reserved up front
+        else
+            scan_all = true;
+    }
+
+    void mark_all() {
+        std::fill(flags.begin(), flags.end(), (uint8_t)1);
+        list.clear();
+        scan_all = true;
+    }
+
+    void clear() {
+        if (scan_all)
+            std::fill(flags.begin(), flags.end(), (uint8_t)0);
+        // Performance critical: sparse clear of the listed rows
+        for (uint32_t i : list)
+            flags[i] = 0;
+        list.clear();
+        scan_all = false;
+    }
+
+    void assign(size_t n, uint8_t value) {
+        flags.assign(n, value ? 1 : 0);
+        list.clear();
+        taking.clear();
+        list.reserve(list_capacity());
+        taking.reserve(list_capacity());
+        scan_all = value && n;
+    }
+
+    // Calls visit(row) for every flagged row, clearing its flag first. A row visit marks
+    // again is left for the next consume unless a full scan has yet to reach it.
+    template <typename Visit>
+    void consume(Visit&& visit) {
+        taking.swap(list);
+        const bool scan = scan_all;
+        scan_all = false;
+        if (!scan) {
+            // Performance critical: O(changed rows), in notification order
+            for (uint32_t i : taking) {
+                if (!flags[i])
+                    continue;
+                flags[i] = 0;
+                visit(i);
+            }
+            taking.clear();
+            return;
+        }
+        taking.clear();
+        const uint32_t rows = (uint32_t)flags.size();
+        // Performance critical: single pass over the flags, skipping clean runs 8 at a time
+        for (uint32_t i = 0; i < rows; ++i) {
+            uint64_t word;
+            if ((i & 7u) == 0 && i + 8 <= rows) {
+                std::memcpy(&word, &flags[i], sizeof word);
+                if (!word) {
+                    i += 7;
+                    continue;
+                }
+            }
+            if (!flags[i])
+                continue;
+            flags[i] = 0;
+            visit(i);
+        }
+    }
+};
+
 struct HostContext {
-    std::unique_ptr<std::atomic<uint32_t>[]> seq;
-    std::vector<uint8_t> dirty;
-    struct RowSnap {
-        int64_t ts, px, qty;
-        uint8_t side;
+    // Declared first so it outlives everything carved from it. Inactive unless the host
+    // reserves it (--arena); every buffer below then comes from it instead of the heap.
+    Arena arena;
+
+    SeqArray seq;  // per-row seqlock counters, layout chosen at startup
+    ArenaArray<MDRowLine> row_lines;  // RowStorage::Lines only, seq points into it
+    // Column storage owned by the host when the arena is active (RowStorage::Columns);
+    // otherwise the slot points at the caller's vectors.
+    ArenaArray<int64_t> col_ts_ns, col_px_n, col_qty;
+    ArenaArray<uint8_t> col_side;
+    DirtyFlags dirty;
+    using RowSnap = ::RowSnap;
+    PublishedRows published;  // what the views read; see published_rows.h
+    ChangeFeed changes;       // change set of every ingest cycle, see run_ingest_cycle
+    LatencyRecorder latency;  // tick age per stage, from notify to the buffer swap
+
+    // Seqlock reader instrumentation, updated by refresh_dirty_rows (ingest stage only).
+    // A row is torn when a writer held it open or finished a write during the read.
+    struct SnapshotStats {
+        uint64_t rows{0};           // rows snapshotted
+        uint64_t torn{0};           // batched reads that found the row torn
+        uint64_t retries{0};        // single-row retries spent on torn rows
+        uint64_t failures{0};       // rows still torn after every retry
+        uint64_t deferred{0};       // failures re-marked dirty for the next refresh
+        uint32_t last_deferred{0};  // rows carried over by the most recent refresh
+        uint64_t held{0};           // rows held back because a reader was inside
+        uint32_t most_torn_row{0};  // row with the most torn reads in row_torn
+        uint32_t most_torn{0};
     };
-    std::vector<RowSnap> last;
+    SnapshotStats snap_stats;
+    ArenaVector<uint32_t> row_torn;  // per-row torn reads, empty until sized by init
 
+    NotifyMode notify_mode{NotifyMode::Queue};
     MPSCQueue q;
+    AtomicDirtyBitmap dirty_bits;
+
+    // Per-writer rings (NotifyMode::WriterRings). A writer claims a ring through
+    // register_writer; the consumer drains every ring that has ever been claimed,
+    // round-robin, so a busy writer cannot starve the others.
+    ArenaArray<SPSCRing> writer_rings;
+    ArenaArray<std::atomic<bool>> writer_ring_used;
+    uint32_t max_writers{0};
+    std::atomic<uint32_t> writer_ring_hwm{0};  // 1 + highest ring index ever claimed
+    uint32_t writer_ring_rr{0};                // consumer round-robin start
+
+    // Broadcast ring (NotifyMode::Broadcast). Only the primary cursor is registered. It
+    // feeds ctx.dirty, and the views get their changes from ChangeFeed. A consumer outside
+    // the ingest stage can still register its own cursor and drain it with drain_broadcast.
+    BroadcastRing bcast;
+    int32_t bcast_primary{-1};
+    uint64_t bcast_primary_seen{0};  // overflow_count already handled by the primary
+
+    // Overflow handling: a producer that finds the ring full counts the loss and raises
+    // resync_needed; the consumer then discards the ring and marks every row dirty, so the
+    // next paint does one sequential seqlock sweep instead of leaving rows stale.
+    alignas(64) std::atomic<bool> resync_needed{false};
+    std::atomic<uint64_t> overflow_count{0};  // notifications dropped by a full ring
+    uint64_t resync_count{0};                 // full sweeps triggered (consumer only)
     std::atomic<bool> running{true};
     uint32_t num_rows{0};
 };
 
 // Performance critical: inline function for atomic sequence update (hot path)
-static void host_begin_row_write(HostMDSlot* slot, uint32_t i) {
+static inline void host_begin_row_write(HostMDSlot* slot, uint32_t i) {
     HostContext* ctx = (HostContext*)slot->user;
     uint32_t s = ctx->seq[i].load(std::memory_order_relaxed);
     ctx->seq[i].store(s + 1, std::memory_order_release);  // odd
 }
 // Performance critical: inline function for atomic sequence update (hot path)
-static void host_end_row_write(HostMDSlot* slot, uint32_t i) {
+static inline void host_end_row_write(HostMDSlot* slot, uint32_t i) {
     HostContext* ctx = (HostContext*)slot->user;
     uint32_t s = ctx->seq[i].load(std::memory_order_relaxed);
     ctx->seq[i].store(s + 1, std::memory_order_release);  // even
 }
+// Producer side of overflow handling, shared by every bounded channel.
+// Performance critical: cold path, only when a channel is full
+static inline void host_note_overflow(HostContext* ctx) {
+    ctx->overflow_count.fetch_add(1, std::memory_order_relaxed);
+    if (!ctx->resync_needed.load(std::memory_order_relaxed))
+        ctx->resync_needed.store(true, std::memory_order_release);
+}
+// Notify stage of the tick-to-pixel latency: the writer has just stamped and closed the row,
+// so its ts_ns is the one it wrote. One clock read per notification, none when disabled.
+// Performance critical: hot path, once per notification
+static inline void host_note_tick(HostContext* ctx, const HostMDSlot* slot, uint32_t i) {
+    if (ctx->latency.on())
+        ctx->latency.record(TickStage::Notify, *md_ts_ns(slot, i), LatencyRecorder::now_ns());
+}
 // Performance critical: inline function for lock-free queue push (hot path)
-static void host_notify_row_dirty(HostMDSlot* slot, uint32_t i) {
+static inline void host_notify_row_dirty(HostMDSlot* slot, uint32_t i) {
     HostContext* ctx = (HostContext*)slot->user;
+    host_note_tick(ctx, slot, i);
     // Performance critical: lock-free queue push for row update notification
-    ctx->q.push(i);
+    if (!ctx->q.push(i))
+        host_note_overflow(ctx);
+}
+// Performance critical: inline function for lock-free broadcast publish (hot path)
+static inline void host_notify_row_dirty_broadcast(HostMDSlot* slot, uint32_t i) {
+    HostContext* ctx = (HostContext*)slot->user;
+    host_note_tick(ctx, slot, i);
+    if (!ctx->bcast.publish(i))
+        host_note_overflow(ctx);
+}
+// Performance critical: inline function for lock-free bitmap mark (hot path)
+static inline void host_notify_row_dirty_bitmap(HostMDSlot* slot, uint32_t i) {
+    HostContext* ctx = (HostContext*)slot->user;
+    host_note_tick(ctx, slot, i);
+    ctx->dirty_bits.mark(i);
+}
+
+// Claims a free per-writer ring, returns its index or -1 when all rings are taken.
+static inline int32_t host_register_writer(HostMDSlot* slot) {
+    HostContext* ctx = (HostContext*)slot->user;
+    // Performance critical: called once per writer thread, linear scan is fine
+    for (uint32_t w = 0; w < ctx->max_writers; ++w) {
+        bool expected = false;
+        if (ctx->writer_ring_used[w].compare_exchange_strong(expected, true,
+                                                             std::memory_order_acq_rel)) {
+            uint32_t hwm = ctx->writer_ring_hwm.load(std::memory_order_relaxed);
+            // Performance critical: CAS loop raising the drain bound
+            while (hwm < w + 1 && !ctx->writer_ring_hwm.compare_exchange_weak(
+                                      hwm, w + 1, std::memory_order_release)) {
+            }
+            return (int32_t)w;
+        }
+    }
+    return -1;
+}
+// Releases a ring; entries still queued in it are drained normally.
+// Performance critical: no, once per writer thread
+static inline void host_unregister_writer(HostMDSlot* slot, int32_t writer) {
+    HostContext* ctx = (HostContext*)slot->user;
+    if (writer >= 0 && (uint32_t)writer < ctx->max_writers)
+        ctx->writer_ring_used[writer].store(false, std::memory_order_release);
+}
+// Performance critical: inline function for wait-free per-writer ring push (hot path)
+static inline void host_notify_row_dirty_from(HostMDSlot* slot, int32_t writer, uint32_t i) {
+    HostContext* ctx = (HostContext*)slot->user;
+    if (writer < 0 || (uint32_t)writer >= ctx->max_writers) {
+        host_notify_row_dirty(slot, i);
+        return;
+    }
+    host_note_tick(ctx, slot, i);
+    // Performance critical: wait-free push into this writer's private ring
+    if (!ctx->writer_rings[writer].push(i))
+        host_note_overflow(ctx);
+}
+
+// API v2: opens the seqlock of every row in the batch. Duplicate ids are fine, an odd
+// sequence stays odd. One fence orders all the odd stores before the row writes.
+static inline void host_begin_batch(HostMDSlot* slot, const uint32_t* ids, uint32_t n) {
+    HostContext* ctx = (HostContext*)slot->user;
+    // Performance critical: one relaxed store per row, a single fence per batch
+    for (uint32_t k = 0; k < n; ++k) {
+        uint32_t s = ctx->seq[ids[k]].load(std::memory_order_relaxed);
+        ctx->seq[ids[k]].store(s | 1u, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+// Publishes a batch of row ids through the active channel with one ring operation.
+// Performance critical: hot path, once per batch
+static inline void host_notify_rows_dirty(HostContext* ctx, int32_t writer, const uint32_t* ids,
+                                   uint32_t n) {
+    bool ok = true;
+    switch (ctx->notify_mode) {
+    case NotifyMode::Bitmap:
+        // Performance critical: bitmap marks coalesce, nothing can overflow
+        for (uint32_t k = 0; k < n; ++k)
+            ctx->dirty_bits.mark(ids[k]);
+        break;
+    case NotifyMode::Broadcast:
+        ok = ctx->bcast.publish_batch(ids, n);
+        break;
+    case NotifyMode::WriterRings:
+        if (writer >= 0 && (uint32_t)writer < ctx->max_writers) {
+            ok = ctx->writer_rings[writer].push_batch(ids, n);
+            break;
+        }
+        ok = ctx->q.push_batch(ids, n);
+        break;
+    case NotifyMode::Queue:
+        ok = ctx->q.push_batch(ids, n);
+        break;
+    }
+    if (!ok)
+        host_note_overflow(ctx);
+}
+
+// API v2: closes every row opened by host_begin_batch and notifies them all at once.
+// Performance critical: hot path, once per batch
+static inline void host_commit_batch(HostMDSlot* slot, int32_t writer, const uint32_t* ids,
+                              uint32_t n) {
+    HostContext* ctx = (HostContext*)slot->user;
+    // Performance critical: release store per row makes its writes visible with the even seq
+    for (uint32_t k = 0; k < n; ++k) {
+        uint32_t s = ctx->seq[ids[k]].load(std::memory_order_relaxed);
+        ctx->seq[ids[k]].store((s | 1u) + 1, std::memory_order_release);
+    }
+    if (ctx->latency.on()) {
+        const int64_t now = LatencyRecorder::now_ns();
+        // Performance critical: one clock read for the whole batch
+        for (uint32_t k = 0; k < n; ++k)
+            ctx->latency.record(TickStage::Notify, *md_ts_ns(slot, ids[k]), now);
+    }
+    host_notify_rows_dirty(ctx, writer, ids, n);
+}
+
+// API v3: splits the table into one contiguous partition per writer. Boundaries fall on
+// multiples of 8 rows so two writers never store into the same 64-byte line of an int64
+// column; trailing writers get an empty range when there are too few rows.
+// Performance critical: no, once per writer thread
+static inline int host_writer_range(HostMDSlot* slot, uint32_t writer_index, uint32_t num_writers,
+                             uint32_t* first_row, uint32_t* row_count) {
+    if (num_writers == 0 || writer_index >= num_writers || !first_row || !row_count)
+        return -1;
+    const uint32_t kRowsPerLine = 8;
+    uint32_t lines = (slot->num_rows + kRowsPerLine - 1) / kRowsPerLine;
+    uint32_t per = lines / num_writers;
+    uint32_t extra = lines % num_writers;
+    uint32_t first_line = writer_index * per + std::min(writer_index, extra);
+    uint32_t num_lines = per + (writer_index < extra ? 1 : 0);
+    uint32_t first = std::min(first_line * kRowsPerLine, slot->num_rows);
+    uint32_t end = std::min((first_line + num_lines) * kRowsPerLine, slot->num_rows);
+    *first_row = first;
+    *row_count = end - first;
+    return 0;
+}
+
+// Performance critical: marks a batch of drained ids dirty, ids outside the table are ignored
+static inline void mark_ids_dirty(DirtyFlags& dirty, const uint32_t* ids, uint32_t n) {
+    const size_t rows = dirty.size();
+    // Performance critical: scatter into the dirty flags and their sparse list
+    for (uint32_t k = 0; k < n; ++k) {
+        if (ids[k] < rows)
+            dirty.mark(ids[k]);
+    }
+}
+
+// Drains one MPSC ring, at most one ring's worth per call so producers that keep up with
+// the consumer cannot keep it in this loop forever. Ids are discarded when mark is false.
+// Performance critical: consumer hot path, every ingest cycle
+static inline void drain_queue(HostContext& ctx, MPSCQueue& q, bool mark) {
+    uint32_t ids[256];
+    uint32_t budget = q.capacity();
+    uint32_t n;
+    // Performance critical: tight loop draining queued row ids in batches
+    while (budget && (n = q.pop_batch(ids, std::min(budget, 256u))) != 0) {
+        if (mark)
+            mark_ids_dirty(ctx.dirty, ids, n);
+        budget -= n;
+    }
+}
+
+// Fan-in over the per-writer rings: one batch per ring per pass, starting at a rotating
+// ring, until every ring is empty or each ring had up to one capacity drained.
+// Performance critical: consumer hot path, every ingest cycle
+static inline void drain_writer_rings(HostContext& ctx, bool mark) {
+    uint32_t rings = ctx.writer_ring_hwm.load(std::memory_order_acquire);
+    if (rings == 0)
+        return;
+    uint32_t ids[256];
+    uint32_t max_passes = ctx.writer_rings[0].capacity() / 256;
+    bool any = true;
+    // Performance critical: round-robin batch drain across writer rings
+    for (uint32_t pass = 0; any && pass < max_passes; ++pass) {
+        any = false;
+        // Performance critical: one batch per ring per pass
+        for (uint32_t k = 0; k < rings; ++k) {
+            SPSCRing& ring = ctx.writer_rings[(ctx.writer_ring_rr + k) % rings];
+            uint32_t n = ring.pop_batch(ids, 256);
+            if (n) {
+                if (mark)
+                    mark_ids_dirty(ctx.dirty, ids, n);
+                any = true;
+            }
+        }
+    }
+    ctx.writer_ring_rr = (ctx.writer_ring_rr + 1) % rings;
+}
+
+// Consumer side of overflow recovery: empties the rings and marks every row dirty. The flag
+// is cleared first, so an overflow racing with the reset simply triggers another resync.
+// Performance critical: cold path, after an overflow only
+static inline void resync_all_rows(HostContext& ctx) {
+    drain_queue(ctx, ctx.q, false);
+    if (ctx.notify_mode == NotifyMode::WriterRings)
+        drain_writer_rings(ctx, false);
+    ctx.dirty.mark_all();
+    ++ctx.resync_count;
+}
+
+// Reads everything published for one broadcast cursor into dirty. A consumer resyncs (marks
+// every row) when producers dropped entries since its last drain (Gated) or lapped it (Lossy).
+// Performance critical: consumer hot path, once per cursor per cycle
+static inline void drain_broadcast(HostContext& ctx, int32_t cursor, uint64_t& seen_overflows,
+                            DirtyFlags& dirty) {
+    bool resync = false;
+    uint64_t overflows = ctx.overflow_count.load(std::memory_order_acquire);
+    if (overflows != seen_overflows) {
+        seen_overflows = overflows;
+        resync = true;
+    }
+
+    uint32_t ids[256];
+    uint64_t budget = ctx.bcast.capacity();
+    uint32_t n;
+    bool lapped;
+    // Performance critical: batch drain of this consumer's cursor, one ring's worth at most
+    do {
+        n = ctx.bcast.poll(cursor, ids, (uint32_t)std::min<uint64_t>(budget, 256), lapped);
+        resync |= lapped;
+        if (!resync)
+            mark_ids_dirty(dirty, ids, n);
+        budget -= std::min<uint64_t>(budget, (uint64_t)n + (lapped ? 1 : 0));
+        // Performance critical: stop once caught up or a ring's worth has been read
+    } while ((n || lapped) && budget);
+
+    if (resync) {
+        dirty.mark_all();
+        ++ctx.resync_count;
+    }
+}
+
+// Performance critical: drains the active notification channel into ctx.dirty (consumer
+// side). Ids outside the table are ignored.
+static inline void drain_dirty_notifications(HostContext& ctx) {
+    if (ctx.notify_mode == NotifyMode::Broadcast) {
+        drain_broadcast(ctx, ctx.bcast_primary, ctx.bcast_primary_seen, ctx.dirty);
+        return;
+    }
+
+    if (ctx.resync_needed.load(std::memory_order_relaxed) &&
+        ctx.resync_needed.exchange(false, std::memory_order_acquire)) {
+        resync_all_rows(ctx);
+        return;
+    }
+
+    switch (ctx.notify_mode) {
+    case NotifyMode::Bitmap:
+        ctx.dirty_bits.drain([&ctx](uint32_t id) {
+            if (id < ctx.num_rows)
+                ctx.dirty.mark(id);
+        });
+        break;
+    case NotifyMode::WriterRings:
+        drain_writer_rings(ctx, true);
+        drain_queue(ctx, ctx.q, true);  // writers without a ring
+        break;
+    case NotifyMode::Queue:
+    case NotifyMode::Broadcast:
+        drain_queue(ctx, ctx.q, true);
+        break;
+    }
+}
+
+// Performance critical: inline payload read of one row, no seq check (hot path)
+static inline HostContext::RowSnap read_row(const HostMDSlot* slot, uint32_t i) {
+    if (slot->row_lines) {
+        // Row and seq word share one line: the whole snapshot is a single line read
+        const MDRowLine& line = slot->row_lines[i / MD_ROWS_PER_LINE];
+        const uint32_t k = i % MD_ROWS_PER_LINE;
+        return {line.ts_ns[k], line.px_n[k], line.qty[k], line.side[k]};
+    }
+    return {slot->ts_ns[i], slot->px_n[i], slot->qty[i], slot->side[i]};
 }
 
 // Performance critical: inline function for lock-free atomic row snapshot (hot path)
-static bool row_snapshot(const HostContext* ctx, const HostMDSlot* slot, uint32_t i,
+static inline bool row_snapshot(const HostContext* ctx, const HostMDSlot* slot, uint32_t i,
                          HostContext::RowSnap& out) {
     uint32_t s1 = ctx->seq[i].load(std::memory_order_acquire);
     if (s1 & 1u)
         return false;
-    HostContext::RowSnap tmp{slot->ts_ns[i], slot->px_n[i], slot->qty[i], slot->side[i]};
+    HostContext::RowSnap tmp = read_row(slot, i);
     std::atomic_thread_fence(std::memory_order_acquire);
     uint32_t s2 = ctx->seq[i].load(std::memory_order_acquire);
     if (s1 != s2 || (s2 & 1u))
@@ -76,7 +572,224 @@ static bool row_snapshot(const HostContext* ctx, const HostMDSlot* slot, uint32_
     return true;
 }
 
-static uint64_t now_ms() {
+// Rows validated together by snapshot_rows, and how often a torn row is retried alone.
+// snapshot_rows reports per row the attempt that succeeded: 1 for the batched read,
+// 2..kSnapshotRetries + 1 for a retry, 0 when the row stayed torn.
+static constexpr uint32_t kSnapshotGroup = 8;
+static constexpr int kSnapshotRetries = 3;
+
+// Batched row_snapshot: gathers rows ids[0..n) into out[0..n). Seq words are checked a
+// group of eight rows at a time with one fence pair and one SIMD compare instead of two
+// acquire loads and a fence per row; only torn rows are retried, one by one. ok[k]
+// (optional) is the attempt that produced a consistent out[k], 0 when the row stayed
+// torn and out[k] holds garbage. Returns the number of consistent rows.
+// Performance critical: hot path, every changed row of a cycle
+static inline uint32_t snapshot_rows(const HostContext* ctx, const HostMDSlot* slot,
+                              const uint32_t* ids, uint32_t n, HostContext::RowSnap* out,
+                              uint8_t* ok = nullptr) {
+    alignas(16) uint32_t s1[kSnapshotGroup];
+    alignas(16) uint32_t s2[kSnapshotGroup];
+    std::atomic<uint32_t>* seq[kSnapshotGroup];
+    const MDRowLine* lines = slot->row_lines;
+    uint32_t missed = 0;
+    // Performance critical: one validation per group of rows
+    for (uint32_t first = 0; first < n; first += kSnapshotGroup) {
+        const uint32_t m = std::min(kSnapshotGroup, n - first);
+        const uint32_t* g = ids + first;
+        HostContext::RowSnap* dst = out + first;
+        // Performance critical: unused lanes stay odd so they never validate
+        for (uint32_t k = m; k < kSnapshotGroup; ++k)
+            s1[k] = s2[k] = 1u;
+        // Performance critical: first seq read for the whole group
+        for (uint32_t k = 0; k < m; ++k) {
+            seq[k] = &ctx->seq[g[k]];
+            s1[k] = seq[k]->load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Performance critical: payload gather straight into out, no per-row fences
+        if (lines) {
+            for (uint32_t k = 0; k < m; ++k) {
+                const MDRowLine& line = lines[g[k] / MD_ROWS_PER_LINE];
+                const uint32_t r = g[k] % MD_ROWS_PER_LINE;
+                dst[k] = {line.ts_ns[r], line.px_n[r], line.qty[r], line.side[r]};
+            }
+        } else {
+            // Performance critical: column gather, storage branch hoisted out of the loop
+            for (uint32_t k = 0; k < m; ++k) {
+                const uint32_t i = g[k];
+                dst[k] = {slot->ts_ns[i], slot->px_n[i], slot->qty[i], slot->side[i]};
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Performance critical: second seq read for the whole group
+        for (uint32_t k = 0; k < m; ++k)
+            s2[k] = seq[k]->load(std::memory_order_relaxed);
+
+        const uint32_t full = (1u << m) - 1;
+        uint32_t stable = seq_stable_mask8(s1, s2);
+        if (ok) {
+            // Performance critical: eight flag stores per group
+            for (uint32_t k = 0; k < m; ++k)
+                ok[first + k] = (stable >> k) & 1u;
+        }
+        // Performance critical: retry only the rows a writer was touching
+        for (uint32_t torn = ~stable & full; torn; torn &= torn - 1) {
+            const uint32_t k = ctz64(torn);
+            // Performance critical: bounded per-row retry
+            for (int tries = 0; tries < kSnapshotRetries; ++tries) {
+                if (row_snapshot(ctx, slot, g[k], dst[k])) {
+                    stable |= 1u << k;
+                    if (ok)
+                        ok[first + k] = (uint8_t)(tries + 2);
+                    break;
+                }
+            }
+        }
+        // Performance critical: count the rows that stayed torn
+        for (uint32_t bad = ~stable & full; bad; bad &= bad - 1)
+            ++missed;
+    }
+    return n - missed;
+}
+
+// Publisher side of ctx.published: snapshots every row flagged in dirty, clearing the
+// flags, in chunks through snapshot_rows, and publishes each chunk as one epoch. Rows whose
+// value changed are passed to on_changed(row, snap) after their chunk is published, or to
+// on_changed(row, snap, cols) with the RowColumn bits that changed, so a view can skip the
+// stages that do not depend on them (a timestamp-only tick touches RowColTs only), or to
+// on_changed(row, snap, cols, before) with the value it replaced as well. Rows
+// still torn after the retries, and whole chunks that meet a reader inside the published
+// view, are marked dirty again, so the next refresh picks them up even if no further
+// notification arrives; ctx.snap_stats and ctx.row_torn count both. Returns the number of
+// changed rows.
+// Performance critical: hot path, once per ingest cycle
+template <typename OnChanged>
+static inline uint32_t refresh_dirty_rows(HostContext& ctx, const HostMDSlot& slot, DirtyFlags& dirty,
+                                   OnChanged&& on_changed) {
+    constexpr uint32_t kChunk = 256;
+    uint32_t ids[kChunk];
+    HostContext::RowSnap snaps[kChunk];
+    uint8_t ok[kChunk];
+    uint8_t cols[kChunk];
+    constexpr bool kWantsBefore =
+        std::is_invocable_v<OnChanged, uint32_t, const HostContext::RowSnap&, uint8_t,
+                            const HostContext::RowSnap&>;
+    HostContext::RowSnap befores[kWantsBefore ? kChunk : 1];
+    uint32_t deferred[kChunk];
+    uint32_t n = 0, changed = 0, num_deferred = 0;
+    HostContext::SnapshotStats& stats = ctx.snap_stats;
+    const bool per_row = ctx.row_torn.size() == ctx.num_rows;
+    auto flush = [&] {
+        const uint32_t good = snapshot_rows(&ctx, &slot, ids, n, snaps, ok);
+        stats.rows += n;
+        if (!ctx.published.try_begin_publish()) {
+            // A reader is inside the published view: keep the whole chunk for next cycle
+            mark_ids_dirty(dirty, ids, n);
+            stats.held += n;
+            n = 0;
+            return;
+        }
+        uint32_t c = 0;
+        // Performance critical: compare against the published value, compact the changes
+        for (uint32_t k = 0; k < n; ++k) {
+            if (good != n && ok[k] != 1) {
+                ++stats.torn;
+                stats.retries += ok[k] ? ok[k] - 1u : (uint32_t)kSnapshotRetries;
+                if (per_row && ++ctx.row_torn[ids[k]] > stats.most_torn) {
+                    stats.most_torn = ctx.row_torn[ids[k]];
+                    stats.most_torn_row = ids[k];
+                }
+                if (!ok[k]) {
+                    ++stats.failures;
+                    deferred[num_deferred++] = ids[k];
+                    continue;
+                }
+            }
+            const uint8_t diff = ctx.published.diff(ids[k], snaps[k]);
+            if (!diff)
+                continue;
+            if constexpr (kWantsBefore)
+                befores[c] = ctx.published.row(ids[k]);
+            ctx.published.set(ids[k], snaps[k]);
+            ids[c] = ids[k];
+            cols[c] = diff;
+            snaps[c++] = snaps[k];
+        }
+        ctx.published.end_publish();
+        // Performance critical: callbacks run outside the publish section
+        for (uint32_t k = 0; k < c; ++k) {
+            if constexpr (kWantsBefore)
+                on_changed(ids[k], snaps[k], cols[k], befores[k]);
+            else if constexpr (std::is_invocable_v<OnChanged, uint32_t,
+                                                   const HostContext::RowSnap&, uint8_t>)
+                on_changed(ids[k], snaps[k], cols[k]);
+            else
+                on_changed(ids[k], snaps[k]);
+        }
+        changed += c;
+        n = 0;
+        // Rows already visited: re-marking them leaves them for the next refresh
+        mark_ids_dirty(dirty, deferred, num_deferred);
+        stats.deferred += num_deferred;
+        stats.last_deferred += num_deferred;
+        num_deferred = 0;
+    };
+    stats.last_deferred = 0;
+    // Performance critical: visits the flagged rows only (O(changed rows))
+    dirty.consume([&](uint32_t i) {
+        if (i >= ctx.num_rows)
+            return;
+        ids[n++] = i;
+        if (n == kChunk)
+            flush();
+    });
+    flush();
+    return changed;
+}
+
+// Ages of every row of a change set at one stage, one clock read for the lot
+static inline void record_tick_ages(LatencyRecorder& latency, TickStage stage, const ChangeSet& set) {
+    const int64_t now = LatencyRecorder::now_ns();
+    // Performance critical: one histogram store per changed row
+    for (const RowSnap& row : set.after)
+        latency.record(stage, row.ts, now);
+}
+
+// The single ingest stage: drains the notification channel once, snapshots and publishes
+// the changed rows, and hands one ChangeSet (ids, values before and after, changed columns)
+// to every ctx.changes listener. Views subscribe instead of draining or snapshotting on
+// their own. Returns the number of changed rows.
+// Performance critical: hot path, the whole ingest stage
+static inline uint32_t run_ingest_cycle(HostContext& ctx, const HostMDSlot& slot) {
+    PROFILE_SCOPE("ingest cycle");
+    {
+        PROFILE_SCOPE("drain");
+        drain_dirty_notifications(ctx);
+    }
+    ChangeSet& set = ctx.changes.begin_cycle();
+    uint32_t changed;
+    {
+        PROFILE_SCOPE("snapshot");
+        changed = refresh_dirty_rows(
+            ctx, slot, ctx.dirty,
+            [&set](uint32_t row, const HostContext::RowSnap& after, uint8_t cols,
+                   const HostContext::RowSnap& before) { set.add(row, before, after, cols); });
+    }
+    set.epoch = ctx.published.epoch.load(std::memory_order_relaxed);
+    const bool timed = ctx.latency.on() && !set.empty();
+    if (timed)
+        record_tick_ages(ctx.latency, TickStage::Snapshot, set);
+    {
+        PROFILE_SCOPE("deliver");
+        ctx.changes.deliver();
+    }
+    if (timed)
+        record_tick_ages(ctx.latency, TickStage::Delivered, set);
+    return changed;
+}
+
+// Performance critical: no, pacing and reports only
+static inline uint64_t now_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(lib_now().time_since_epoch()).count();
 }
\ No newline at end of file
@@ -1,17 +1,28 @@
-
 #pragma once
 
 #include <atomic>
 #include <cstdint>
-#include <vector>
+#include <memory>
+
+#include "arena.h"
 
-// Simple multi-producer, single-consumer ring buffer.
+// Bounded multi-producer, single-consumer ring buffer (Vyukov style).
+// Every cell carries its own sequence stamp: a producer claims position p only
+// when cell[p].seq == p, stores the value and then publishes seq = p + 1. The
+// consumer reads cell[p] only once it sees seq == p + 1, so it can never observe
+// a slot that was claimed but not yet written. A failed push does not move any
+// counter, so overflow never corrupts the ring.
 // Capacity must be a power of two.
 struct MPSCQueue {
-    std::atomic<uint32_t> head{0};
-    std::atomic<uint32_t> tail{0};
-    uint32_t cap_mask{0};
-    std::vector<uint32_t> buf;
+    struct Cell {
+        std::atomic<uint32_t> seq{0};
+        uint32_t value{0};
+    };
+
+    alignas(64) std::atomic<uint32_t> head{0};  // next position to claim (producers)
+    alignas(64) std::atomic<uint32_t> tail{0};  // next position to read (consumer)
+    alignas(64) uint32_t cap_mask{0};
+    ArenaArray<Cell> cells;
 
     static uint32_t next_pow2(uint32_t v) {
         if (v < 2)
@@ -23,35 +34,106 @@ struct MPSCQueue {
         return p;
     }
 
-    void init(uint32_t capacity_pow2) {
+    void init(uint32_t capacity_pow2, Arena* arena = nullptr) {
         uint32_t cap = next_pow2(capacity_pow2);
-        buf.resize(cap);
+        cells = make_arena_array<Cell>(arena, cap, "notify queue");
+        // Performance critical: stamp every cell with the position that may claim it first
+        for (uint32_t i = 0; i < cap; ++i)
+            cells[i].seq.store(i, std::memory_order_relaxed);
         cap_mask = cap - 1;
         head.store(0, std::memory_order_relaxed);
-        tail.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_release);
+    }
+
+    uint32_t capacity() const {
+        return cap_mask + 1;
+    }
+
+    // Approximate number of queued entries (exact when called by the consumer with no
+    // concurrent producers).
+    uint32_t size_approx() const {
+        return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
     }
 
     // Performance critical: inline function for lock-free producer push (hot path)
+    // Returns false when the ring is full; the caller decides what to do with the value.
     inline bool push(uint32_t value) {
-        uint32_t h = head.fetch_add(1, std::memory_order_acq_rel);
-        uint32_t t = tail.load(std::memory_order_acquire);
-        if (h - t >= buf.size()) {
-            // overflow: return false and let caller decide what to do,
-            // e.g. retry with newer value / etc
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        // Performance critical: CAS loop, only retries when another producer won the slot
+        for (;;) {
+            Cell& c = cells[pos & cap_mask];
+            uint32_t seq = c.seq.load(std::memory_order_acquire);
+            int32_t dif = (int32_t)(seq - pos);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false;  // cell still holds an unread value from the previous lap
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        Cell& c = cells[pos & cap_mask];
+        c.value = value;
+        c.seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Claims n consecutive positions with one CAS and publishes values in order. All or
+    // nothing: returns false, moving no counter, when fewer than n cells are free.
+    // Performance critical: inline function for lock-free batched producer push (hot path)
+    inline bool push_batch(const uint32_t* values, uint32_t n) {
+        if (n == 0)
+            return true;
+        if (n > cap_mask + 1)
             return false;
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        // Performance critical: CAS loop; the consumer frees cells in order, so the last
+        // cell of the range being free means the whole range is
+        for (;;) {
+            uint32_t last = pos + n - 1;
+            uint32_t seq = cells[last & cap_mask].seq.load(std::memory_order_acquire);
+            int32_t dif = (int32_t)(seq - last);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        // Performance critical: publish each cell; the consumer may start on the first one
+        for (uint32_t k = 0; k < n; ++k) {
+            Cell& c = cells[(pos + k) & cap_mask];
+            c.value = values[k];
+            c.seq.store(pos + k + 1, std::memory_order_release);
         }
-        buf[h & cap_mask] = value;
         return true;
     }
 
     // Performance critical: inline function for single-consumer pop (hot path)
     inline bool pop(uint32_t& out) {
-        uint32_t t = tail.load(std::memory_order_acquire);
-        uint32_t h = head.load(std::memory_order_acquire);
-        if (t == h)
-            return false;
-        out = buf[t & cap_mask];
-        tail.store(t + 1, std::memory_order_release);
-        return true;
+        return pop_batch(&out, 1) == 1;
+    }
+
+    // Performance critical: inline function draining up to max entries with a single
+    // tail publication. Returns the number of entries written to out.
+    inline uint32_t pop_batch(uint32_t* out, uint32_t max) {
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        const uint32_t lap = cap_mask + 1;
+        uint32_t n = 0;
+        // Performance critical: one acquire load per entry, stops at the first unpublished cell
+        while (n < max) {
+            Cell& c = cells[pos & cap_mask];
+            if (c.seq.load(std::memory_order_acquire) != pos + 1)
+                break;
+            out[n++] = c.value;
+            c.seq.store(pos + lap, std::memory_order_release);  // hand cell to next lap
+            ++pos;
+        }
+        if (n)
+            tail.store(pos, std::memory_order_release);
+        return n;
     }
 };
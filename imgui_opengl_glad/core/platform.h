@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <chrono>
@@ -24,6 +25,9 @@ static inline void lib_close(LibHandle h) {
 }
 #else
 #include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
 typedef void* LibHandle;
 // Performance critical: inline function for loading shared objects (hot path)
 static inline LibHandle lib_open(const char* path) {
@@ -44,3 +48,82 @@ static inline void lib_close(LibHandle h) {
 static inline std::chrono::steady_clock::time_point lib_now() {
     return std::chrono::steady_clock::now();
 }
+
+// Page-granular memory for the host arena. kind receives what backs the mapping:
+// "hugetlb"/"large" (explicit huge pages), "thp" (transparent huge pages advised) or "4k".
+// Performance critical: no, once per arena
+static inline void* os_alloc_pages(size_t size, bool huge_pages, const char** kind) {
+#ifdef _WIN32
+    if (huge_pages) {
+        SIZE_T large = GetLargePageMinimum();
+        if (large && size % large == 0) {
+            // Needs SeLockMemoryPrivilege; falls through to normal pages without it
+            void* p = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                   PAGE_READWRITE);
+            if (p) {
+                *kind = "large";
+                return p;
+            }
+        }
+    }
+    *kind = "4k";
+    return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                 -1, 0);
+        if (p != MAP_FAILED) {
+            *kind = "hugetlb";
+            return p;
+        }
+    }
+#endif
+    p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+    *kind = "4k";
+#ifdef MADV_HUGEPAGE
+    if (huge_pages && madvise(p, size, MADV_HUGEPAGE) == 0)
+        *kind = "thp";
+#endif
+    return p;
+#endif
+}
+
+// Performance critical: no, once per arena
+static inline void os_free_pages(void* p, size_t size) {
+    if (!p)
+        return;
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+// Performance critical: no, arena set-up only
+static inline size_t os_page_size() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Page faults taken by this process so far (0 where the count is not available).
+// Performance critical: no, reports only
+static inline uint64_t os_page_faults() {
+#ifdef _WIN32
+    return 0;  // GetProcessMemoryInfo would pull in psapi
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+    return (uint64_t)ru.ru_minflt + (uint64_t)ru.ru_majflt;
+#endif
+}
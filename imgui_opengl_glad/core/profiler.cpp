@@ -0,0 +1,108 @@
+#include "profiler.h"
+
+#include <algorithm>
+
+void ProfileRing::copy(std::vector<ProfileSample>& out, int64_t since_ns) const {
+    const uint64_t h1 = head.load(std::memory_order_acquire);
+    const uint64_t first = h1 >= kCapacity ? h1 - kCapacity + 1 : 0;
+    const size_t start = out.size();
+    // Scopes are pushed as they end, so end times only grow: walk back from the newest
+    // until one ended before since_ns
+    uint64_t i = h1;
+    // Performance critical: touches only the slots in the requested window
+    while (i > first) {
+        --i;
+        const Slot& s = slots[i & kMask];
+        ProfileSample sample;
+        sample.end_ns = s.end_ns.load(std::memory_order_relaxed);
+        if (sample.end_ns < since_ns)
+            break;
+        sample.name = s.name.load(std::memory_order_relaxed);
+        sample.begin_ns = s.begin_ns.load(std::memory_order_relaxed);
+        sample.depth = s.depth.load(std::memory_order_relaxed);
+        sample.thread = index;
+        out.push_back(sample);
+    }
+    // Slot i may have been reused once the writer got to index i + kCapacity; the head it
+    // had published by then is at least that index (see push)
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t h2 = head.load(std::memory_order_relaxed);
+    const uint64_t safe = h2 >= kCapacity ? h2 - kCapacity + 1 : 0;
+    const size_t copied = out.size() - start;  // indices h1 - 1 down to h1 - copied
+    const size_t valid = h1 > safe ? std::min<size_t>(copied, (size_t)(h1 - safe)) : 0;
+    out.resize(start + valid);
+    std::reverse(out.begin() + start, out.end());
+}
+
+void Profiler::collect(std::vector<ProfileSample>& out, int64_t since_ns) const {
+    const uint32_t n = used.load(std::memory_order_acquire);
+    // Performance critical: one ring per profiled thread
+    for (uint32_t t = 0; t < n; ++t)
+        rings[t]->copy(out, since_ns);
+}
+
+std::string Profiler::thread_name(uint32_t thread) const {
+    if (thread >= used.load(std::memory_order_acquire))
+        return std::string();
+    std::lock_guard<std::mutex> lock(claim_mutex);
+    return rings[thread]->thread_name;
+}
+
+namespace {
+
+// Probe names are identifiers in practice; quotes and backslashes are escaped all the same
+void write_json_string(FILE* out, const char* s) {
+    std::fputc('"', out);
+    // Performance critical: no, export only
+    for (; s && *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            std::fputc('\\', out);
+        if ((unsigned char)*s >= 0x20)
+            std::fputc(*s, out);
+    }
+    std::fputc('"', out);
+}
+
+}  // namespace
+
+void Profiler::write_chrome_trace(FILE* out) const {
+    std::vector<ProfileSample> samples;
+    collect(samples);
+    int64_t origin = INT64_MAX;
+    // Performance critical: no, export only
+    for (const ProfileSample& s : samples)
+        origin = std::min(origin, s.begin_ns);
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const uint32_t n = used.load(std::memory_order_acquire);
+    bool first = true;
+    // Performance critical: no, export only
+    for (uint32_t t = 0; t < n; ++t) {
+        std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                          "\"args\":{\"name\":",
+                     first ? "" : ",\n", t);
+        write_json_string(out, thread_name(t).c_str());
+        std::fprintf(out, "}}");
+        first = false;
+    }
+    // Performance critical: no, export only
+    for (const ProfileSample& s : samples) {
+        std::fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+        write_json_string(out, s.name);
+        std::fprintf(out, ",\"cat\":\"emsp\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                          "\"tid\":%u}",
+                     (s.begin_ns - origin) / 1e3, (s.end_ns - s.begin_ns) / 1e3, s.thread);
+        first = false;
+    }
+    std::fprintf(out, "\n]}\n");
+}
+
+bool Profiler::export_chrome_trace(const char* path) const {
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "Cannot write trace to %s\n", path);
+        return false;
+    }
+    write_chrome_trace(f);
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform.h"
+
+// Scoped timing probes for the pipeline stages (ingest cycle, view updates, table passes,
+// ImGui and GL work, the buffer swap). PROFILE_SCOPE("name") times the rest of the
+// enclosing block into the calling thread's ProfileRing; names must be string literals or
+// otherwise outlive the profiler. A probe costs one relaxed load while profiling is off
+// and two clock reads plus a ring store while on, with no locks either way.
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+// One finished scope, as copied out of a ring
+struct ProfileSample {
+    const char* name;
+    int64_t begin_ns;  // steady_clock, like lib_now()
+    int64_t end_ns;
+    uint32_t depth;    // enclosing probes still open on the thread
+    uint32_t thread;   // index of the ring it came from
+};
+
+// Last kCapacity - 1 scopes of one thread (the slot after the head may be in the middle of
+// a write). The owning thread is the only writer; any thread may copy(). Slots are relaxed
+// atomics and the head moves with a release store once a slot is complete, so a reader
+// keeps exactly the slots the writer cannot have reused meanwhile (the seqlock pattern,
+// with the head as the sequence).
+struct ProfileRing {
+    static constexpr uint32_t kCapacity = 1u << 14;
+    static constexpr uint32_t kMask = kCapacity - 1;
+
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> begin_ns{0};
+        std::atomic<int64_t> end_ns{0};
+        std::atomic<uint32_t> depth{0};
+    };
+
+    Slot slots[kCapacity];
+    std::atomic<uint64_t> head{0};  // scopes recorded so far
+    uint32_t open{0};               // writer only: probes currently open
+    uint32_t index{0};
+    char thread_name[32]{};         // under Profiler::claim_mutex
+
+    // Writer: one finished scope
+    void push(const char* name, int64_t begin_ns, int64_t end_ns, uint32_t depth) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        Slot& s = slots[h & kMask];
+        // Readers that see any of the stores below also see a head that rules the slot out
+        std::atomic_thread_fence(std::memory_order_release);
+        s.name.store(name, std::memory_order_relaxed);
+        s.begin_ns.store(begin_ns, std::memory_order_relaxed);
+        s.end_ns.store(end_ns, std::memory_order_relaxed);
+        s.depth.store(depth, std::memory_order_relaxed);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Any thread: appends the complete scopes that ended at or after since_ns
+    void copy(std::vector<ProfileSample>& out, int64_t since_ns) const;
+};
+
+// The per-thread rings. A thread claims one on its first probe while profiling is on, under
+// a mutex; rings stay claimed (and readable) after their thread exits.
+struct Profiler {
+    static constexpr uint32_t kMaxThreads = 32;
+
+    const uint64_t id{next_id()};  // per-thread cache key, never reused
+    std::atomic<bool> enabled{true};
+    std::unique_ptr<ProfileRing> rings[kMaxThreads];
+    std::atomic<uint32_t> used{0};
+    mutable std::mutex claim_mutex;  // claims and thread names
+
+    // The profiler PROFILE_SCOPE records into
+    static Profiler& global() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static int64_t now_ns() {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(lib_now().time_since_epoch()).count();
+    }
+
+    bool on() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // The calling thread's ring, claimed on first use; nullptr once every ring is taken
+    ProfileRing* local() {
+        struct Cache {
+            uint64_t owner{0};
+            ProfileRing* ring{nullptr};
+        };
+        static thread_local Cache cache;
+        if (cache.owner != id) {
+            cache.owner = id;
+            cache.ring = claim();
+        }
+        return cache.ring;
+    }
+
+    // Names the calling thread in the overlay and the trace export
+    void set_thread_name(const char* name) {
+        ProfileRing* ring = local();
+        if (!ring)
+            return;
+        std::lock_guard<std::mutex> lock(claim_mutex);
+        std::snprintf(ring->thread_name, sizeof(ring->thread_name), "%s", name);
+    }
+
+    // Every ring's complete scopes that ended at or after since_ns, oldest thread first
+    void collect(std::vector<ProfileSample>& out, int64_t since_ns = 0) const;
+    std::string thread_name(uint32_t thread) const;
+
+    // Chrome trace event format (chrome://tracing, Perfetto): one complete ("X") event per
+    // scope, timestamps in microseconds, one track per thread
+    void write_chrome_trace(FILE* out) const;
+    bool export_chrome_trace(const char* path) const;
+
+  private:
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    ProfileRing* claim() {
+        std::lock_guard<std::mutex> lock(claim_mutex);
+        const uint32_t n = used.load(std::memory_order_relaxed);
+        if (n >= kMaxThreads)
+            return nullptr;
+        rings[n] = std::make_unique<ProfileRing>();
+        rings[n]->index = n;
+        std::snprintf(rings[n]->thread_name, sizeof(rings[n]->thread_name), "thread %u", n);
+        used.store(n + 1, std::memory_order_release);
+        return rings[n].get();
+    }
+};
+
+// Times its scope into the global profiler, see PROFILE_SCOPE
+struct ProfileScope {
+    const char* name;
+    ProfileRing* ring{nullptr};
+    int64_t begin_ns{0};
+
+    explicit ProfileScope(const char* scope_name) : name(scope_name) {
+        Profiler& profiler = Profiler::global();
+        if (!profiler.on())
+            return;
+        ring = profiler.local();
+        if (!ring)
+            return;
+        ++ring->open;
+        begin_ns = Profiler::now_ns();
+    }
+
+    ~ProfileScope() {
+        if (!ring)
+            return;
+        const int64_t end_ns = Profiler::now_ns();
+        --ring->open;
+        ring->push(name, begin_ns, end_ns, ring->open);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
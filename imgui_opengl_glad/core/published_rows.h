@@ -0,0 +1,468 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+
+// Value of one row as seen by the views.
+struct RowSnap {
+    int64_t ts, px, qty;
+    uint8_t side;
+};
+
+// Columns of a row change, as a bitmask (refresh_dirty_rows reports them per changed row).
+enum RowColumn : uint8_t {
+    RowColTs = 1,
+    RowColPx = 2,
+    RowColQty = 4,
+    RowColSide = 8,
+    RowColAll = 15,
+};
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PUBLISHED_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PUBLISHED_SIMD_NEON 1
+#endif
+
+// Rows of the published table are stored in blocks of kPublishedBlockRows so a snapshot
+// can share them and the publisher copies only the blocks it changes (copy-on-write).
+static constexpr uint32_t kPublishedBlockShift = 12;
+static constexpr uint32_t kPublishedBlockRows = 1u << kPublishedBlockShift;
+static constexpr uint32_t kPublishedBlockMask = kPublishedBlockRows - 1;
+
+// Columns of a block, in PublishedBlock::off order.
+enum PublishedField : uint32_t { PubTs = 0, PubPx = 1, PubQty = 2, kPublishedFields = 3 };
+
+// Offset that stands for the value 0, so untouched rows never force a rebase.
+static constexpr uint32_t kPublishedZero = 0xFFFFFFFFu;
+
+// One block of the published table, delta-encoded: each column keeps an int64 base and a
+// 32-bit unsigned offset per row (12 bytes per row for ts/px/qty), side is packed four rows
+// per byte. A column whose values span more than 32 bits within the block switches to
+// plain int64 values (wide) until the table is re-initialized.
+struct alignas(64) PublishedBlock {
+    uint32_t off[kPublishedFields][kPublishedBlockRows];  // value - base, or kPublishedZero
+    uint8_t side2[kPublishedBlockRows / 4];               // 2 bits per row
+    int64_t base[kPublishedFields] = {0, 0, 0};
+    bool based[kPublishedFields] = {false, false, false};  // base set by a non-zero value
+    bool wide_on[kPublishedFields] = {false, false, false};
+    std::unique_ptr<int64_t[]> wide[kPublishedFields];     // kept once allocated
+    // 1 while the block is current in the table, +1 per snapshot holding it
+    alignas(64) std::atomic<uint32_t> refs{0};
+    PublishedBlock* next_free{nullptr};  // link while the block sits in the free list
+
+    PublishedBlock() {
+        std::memset(off, 0xFF, sizeof off);  // every row starts at 0
+        std::memset(side2, 0, sizeof side2);
+    }
+
+    // Performance critical: one add, one compare per narrow value (hot path)
+    int64_t get(uint32_t f, uint32_t k) const {
+        if (wide_on[f])
+            return wide[f][k];
+        const uint32_t o = off[f][k];
+        return o == kPublishedZero ? 0 : (int64_t)((uint64_t)base[f] + o);
+    }
+    uint8_t side(uint32_t k) const {
+        return (side2[k >> 2] >> ((k & 3u) * 2)) & 3u;
+    }
+    RowSnap row(uint32_t k) const {
+        return {get(PubTs, k), get(PubPx, k), get(PubQty, k), side(k)};
+    }
+
+    // Decodes n values of column f starting at row k (n <= rows left in the block).
+    void decode(uint32_t f, uint32_t k, uint32_t n, int64_t* out) const {
+        if (wide_on[f]) {
+            std::memcpy(out, wide[f].get() + k, n * sizeof(int64_t));
+            return;
+        }
+        const uint32_t* src = off[f] + k;
+        uint32_t j = 0;
+#if defined(PUBLISHED_SIMD_SSE2)
+        const __m128i b = _mm_set1_epi64x(base[f]);
+        const __m128i zero_off = _mm_set1_epi32(-1);
+        const __m128i z = _mm_setzero_si128();
+        // Performance critical: four offsets widened, rebased and masked per step
+        for (; j + 4 <= n; j += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j));
+            __m128i is_zero = _mm_cmpeq_epi32(v, zero_off);
+            __m128i lo = _mm_add_epi64(_mm_unpacklo_epi32(v, z), b);
+            __m128i hi = _mm_add_epi64(_mm_unpackhi_epi32(v, z), b);
+            lo = _mm_andnot_si128(_mm_unpacklo_epi32(is_zero, is_zero), lo);
+            hi = _mm_andnot_si128(_mm_unpackhi_epi32(is_zero, is_zero), hi);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j + 2), hi);
+        }
+#elif defined(PUBLISHED_SIMD_NEON)
+        const int64x2_t b = vdupq_n_s64(base[f]);
+        const uint32x4_t zero_off = vdupq_n_u32(kPublishedZero);
+        // Performance critical: four offsets widened, rebased and masked per step
+        for (; j + 4 <= n; j += 4) {
+            uint32x4_t v = vld1q_u32(src + j);
+            int32x4_t is_zero = vreinterpretq_s32_u32(vceqq_u32(v, zero_off));
+            int64x2_t lo = vaddq_s64(vreinterpretq_s64_u64(vmovl_u32(vget_low_u32(v))), b);
+            int64x2_t hi = vaddq_s64(vreinterpretq_s64_u64(vmovl_u32(vget_high_u32(v))), b);
+            lo = vbicq_s64(lo, vmovl_s32(vget_low_s32(is_zero)));
+            hi = vbicq_s64(hi, vmovl_s32(vget_high_s32(is_zero)));
+            vst1q_s64(out + j, lo);
+            vst1q_s64(out + j + 2, hi);
+        }
+#endif
+        // Performance critical: scalar tail (or the whole run without SIMD)
+        for (; j < n; ++j)
+            out[j] = src[j] == kPublishedZero ? 0 : (int64_t)((uint64_t)base[f] + src[j]);
+    }
+};
+
+struct PublishedSnapshot;
+
+// Row values published to the views: one delta-encoded copy, about 12 bytes per row. The
+// seqlocked live columns are the writers' shadow; a single publisher (the refresh) copies
+// changed rows from there and applies them here under an epoch flip. The epoch is odd
+// while a change set is being applied and readers only enter while it is even, so a read
+// section sees every row as of one epoch without per-row checks. The publisher never
+// waits for readers: while one is inside, try_begin_publish fails and the changes stay
+// pending for the next cycle. Readers wait at most for one change set to be applied.
+//
+// A consumer that needs a view for longer (aggregates, exports) takes a snapshot instead:
+// it pins the current blocks in one short read section and keeps reading them after
+// publishing resumes. The publisher clones a pinned block before its first write to it,
+// so a snapshot costs one pointer per block plus the blocks changed while it is held.
+struct PublishedRows {
+    ArenaArray<PublishedBlock> base;      // initial blocks, carved once
+    ArenaArray<PublishedBlock*> blocks;   // current block per range of rows
+    uint32_t num_rows{0};
+    uint32_t num_blocks{0};
+    alignas(64) std::atomic<uint64_t> epoch{0};  // number of change sets applied, x2
+    alignas(64) std::atomic<uint32_t> readers{0};
+
+    // Copy-on-write bookkeeping. Cloned blocks come from a recycled pool: any thread that
+    // drops the last reference pushes the block onto free_head (a Treiber stack), and the
+    // publisher, the only one taking blocks out, moves the whole stack to its private
+    // free_local in one exchange. With a single taker no node leaves the stack between a
+    // pusher's load and its CAS, so the stack has no ABA problem.
+    alignas(64) std::atomic<PublishedBlock*> free_head{nullptr};
+    PublishedBlock* free_local{nullptr};                  // publisher only
+    std::vector<std::unique_ptr<PublishedBlock>> spares;  // owns the blocks made past base
+    uint64_t cow_copies{0};  // blocks cloned because a snapshot held them (publisher)
+    uint64_t rebases{0};     // column bases moved because a value left the 32-bit window
+    uint64_t widened{0};     // block columns that fell back to plain int64 values
+
+    void init(uint32_t rows, Arena* arena = nullptr) {
+        num_rows = rows;
+        num_blocks = (rows + kPublishedBlockMask) >> kPublishedBlockShift;
+        base = make_arena_array<PublishedBlock>(arena, num_blocks, "published rows");
+        blocks = make_arena_array<PublishedBlock*>(arena, num_blocks, "published rows");
+        // Performance critical: startup only, one pointer per block
+        for (uint32_t b = 0; b < num_blocks; ++b) {
+            blocks[b] = &base[b];
+            base[b].refs.store(1, std::memory_order_relaxed);
+        }
+        free_head.store(nullptr, std::memory_order_relaxed);
+        free_local = nullptr;
+        spares.clear();
+        cow_copies = rebases = widened = 0;
+        epoch.store(0, std::memory_order_relaxed);
+        readers.store(0, std::memory_order_relaxed);
+    }
+
+    // Enters a read section and returns the (even) epoch it observes. Sections may nest.
+    uint64_t read_begin() {
+        // Performance critical: one increment and one load unless a change set is in flight
+        for (;;) {
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            const uint64_t e = epoch.load(std::memory_order_seq_cst);
+            if (!(e & 1u))
+                return e;
+            readers.fetch_sub(1, std::memory_order_release);
+            // Performance critical: the publisher is applying one bounded chunk
+            while (epoch.load(std::memory_order_acquire) == e)
+                std::this_thread::yield();
+        }
+    }
+
+    void read_end() {
+        readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Publisher only. Returns false, changing nothing, while a reader is inside.
+    bool try_begin_publish() {
+        if (readers.load(std::memory_order_relaxed) != 0)
+            return false;
+        const uint64_t e = epoch.load(std::memory_order_relaxed);
+        epoch.store(e + 1, std::memory_order_seq_cst);
+        if (readers.load(std::memory_order_seq_cst) != 0) {
+            epoch.store(e, std::memory_order_release);  // back off, readers go first
+            return false;
+        }
+        return true;
+    }
+
+    void end_publish() {
+        epoch.store(epoch.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Performance critical: column reads through the block table (hot path)
+    int64_t ts(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubTs, i & kPublishedBlockMask);
+    }
+    int64_t px(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubPx, i & kPublishedBlockMask);
+    }
+    int64_t qty(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubQty, i & kPublishedBlockMask);
+    }
+    uint8_t side(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->side(i & kPublishedBlockMask);
+    }
+    RowSnap row(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->row(i & kPublishedBlockMask);
+    }
+
+    // Performance critical: field compare on decoded values (hot path)
+    bool same(uint32_t i, const RowSnap& r) const {
+        const PublishedBlock* b = blocks[i >> kPublishedBlockShift];
+        const uint32_t k = i & kPublishedBlockMask;
+        return b->get(PubPx, k) == r.px && b->get(PubQty, k) == r.qty &&
+               b->get(PubTs, k) == r.ts && b->side(k) == (r.side & 3u);
+    }
+
+    // Columns of row i that differ from r, 0 when the row is unchanged
+    uint8_t diff(uint32_t i, const RowSnap& r) const {
+        const PublishedBlock* b = blocks[i >> kPublishedBlockShift];
+        const uint32_t k = i & kPublishedBlockMask;
+        return (uint8_t)((b->get(PubTs, k) != r.ts ? RowColTs : 0) |
+                         (b->get(PubPx, k) != r.px ? RowColPx : 0) |
+                         (b->get(PubQty, k) != r.qty ? RowColQty : 0) |
+                         (b->side(k) != (r.side & 3u) ? RowColSide : 0));
+    }
+
+    // Performance critical: encode one row, publisher inside a publish section. A block
+    // still pinned by a snapshot is cloned before the first write. Sides are stored in
+    // two bits (md_api.h defines 0..3).
+    void set(uint32_t i, const RowSnap& r) {
+        PublishedBlock*& slot = blocks[i >> kPublishedBlockShift];
+        if (slot->refs.load(std::memory_order_acquire) != 1)
+            slot = clone_block(slot);
+        PublishedBlock* b = slot;
+        const uint32_t k = i & kPublishedBlockMask;
+        encode(b, PubTs, k, r.ts);
+        encode(b, PubPx, k, r.px);
+        encode(b, PubQty, k, r.qty);
+        const uint32_t shift = (k & 3u) * 2;
+        b->side2[k >> 2] = (uint8_t)((b->side2[k >> 2] & ~(3u << shift)) | ((r.side & 3u) << shift));
+    }
+
+    // Drops one reference; a block nobody uses any more (an initial one or a clone) goes
+    // back to the pool for the next copy. Any thread, lock-free.
+    void unref(PublishedBlock* b) {
+        if (b->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        PublishedBlock* head = free_head.load(std::memory_order_relaxed);
+        // Performance critical: lock-free push, retried only when another release raced it
+        do {
+            b->next_free = head;
+            // Performance critical: release publishes next_free to the publisher's exchange
+        } while (!free_head.compare_exchange_weak(head, b, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    bool snapshot(PublishedSnapshot& out);
+
+    // Encoded size of a row while every column of its block is narrow
+    static constexpr double bytes_per_row() {
+        return kPublishedFields * sizeof(uint32_t) + 0.25;
+    }
+
+  private:
+    // Performance critical: one subtract and compare unless the value leaves the window
+    void encode(PublishedBlock* b, uint32_t f, uint32_t k, int64_t v) {
+        if (b->wide_on[f]) {
+            b->wide[f][k] = v;
+            return;
+        }
+        if (v == 0) {
+            b->off[f][k] = kPublishedZero;
+            return;
+        }
+        const uint64_t d = (uint64_t)v - (uint64_t)b->base[f];
+        if (b->based[f] && d < kPublishedZero) {
+            b->off[f][k] = (uint32_t)d;
+            return;
+        }
+        rebase(b, f, k, v);
+    }
+
+    // Re-centres the base of column f around its values and v, or switches the column to
+    // int64 values when they span more than the 32-bit window.
+    void rebase(PublishedBlock* b, uint32_t f, uint32_t k, int64_t v) {
+        int64_t lo = v, hi = v;
+        // Performance critical: rare, one pass over the block column
+        for (uint32_t j = 0; j < kPublishedBlockRows; ++j) {
+            if (j == k || b->off[f][j] == kPublishedZero)
+                continue;
+            const int64_t x = (int64_t)((uint64_t)b->base[f] + b->off[f][j]);
+            lo = x < lo ? x : lo;
+            hi = x > hi ? x : hi;
+        }
+        const uint64_t span = (uint64_t)hi - (uint64_t)lo;
+        if (span >= kPublishedZero) {
+            if (!b->wide[f])
+                b->wide[f].reset(new int64_t[kPublishedBlockRows]);  // heap, required once per block column
+            b->decode(f, 0, kPublishedBlockRows, b->wide[f].get());
+            b->wide[f][k] = v;
+            b->wide_on[f] = true;
+            ++widened;
+            return;
+        }
+        // Leave equal room on both sides so values drifting either way stay in the window
+        const int64_t new_base = (int64_t)((uint64_t)lo - (kPublishedZero - 1 - span) / 2);
+        const uint64_t shift = (uint64_t)b->base[f] - (uint64_t)new_base;
+        // Performance critical: rare, one pass over the block column
+        for (uint32_t j = 0; j < kPublishedBlockRows; ++j) {
+            if (b->off[f][j] != kPublishedZero)
+                b->off[f][j] = (uint32_t)(b->off[f][j] + shift);
+        }
+        b->base[f] = new_base;
+        b->based[f] = true;
+        b->off[f][k] = (uint32_t)((uint64_t)v - (uint64_t)new_base);
+        ++rebases;
+    }
+
+    PublishedBlock* clone_block(PublishedBlock* shared) {
+        if (!free_local)
+            free_local = free_head.exchange(nullptr, std::memory_order_acquire);
+        PublishedBlock* copy = free_local;
+        if (copy) {
+            free_local = copy->next_free;
+        } else {
+            // Performance critical: heap block, required only when more blocks are
+            // pinned at once than ever before; owned by spares until init/destruction
+            spares.emplace_back(new PublishedBlock());
+            copy = spares.back().get();
+        }
+        std::memcpy(copy->off, shared->off, sizeof copy->off);
+        std::memcpy(copy->side2, shared->side2, sizeof copy->side2);
+        // Performance critical: three columns, a wide one copies its int64 values
+        for (uint32_t f = 0; f < kPublishedFields; ++f) {
+            copy->base[f] = shared->base[f];
+            copy->based[f] = shared->based[f];
+            copy->wide_on[f] = shared->wide_on[f];
+            if (!shared->wide_on[f])
+                continue;
+            if (!copy->wide[f])
+                copy->wide[f].reset(new int64_t[kPublishedBlockRows]);  // heap, required once per block column
+            std::memcpy(copy->wide[f].get(), shared->wide[f].get(),
+                        kPublishedBlockRows * sizeof(int64_t));
+        }
+        copy->refs.store(1, std::memory_order_relaxed);
+        ++cow_copies;
+        unref(shared);  // the table no longer holds it; the snapshots still do
+        return copy;
+    }
+};
+
+// Point-in-time view of the published table as of epoch, readable from any thread while
+// publishing continues. Reuse one object across snapshots to keep its block list
+// allocated; release() as soon as the view is no longer needed, since every block the
+// publisher changes meanwhile is copied once.
+struct PublishedSnapshot {
+    PublishedRows* rows{nullptr};
+    uint64_t epoch{0};
+    uint32_t num_rows{0};
+    std::vector<PublishedBlock*> blocks;
+
+    PublishedSnapshot() = default;
+    PublishedSnapshot(const PublishedSnapshot&) = delete;
+    PublishedSnapshot& operator=(const PublishedSnapshot&) = delete;
+    ~PublishedSnapshot() {
+        release();
+    }
+
+    bool valid() const {
+        return rows != nullptr;
+    }
+
+    void release() {
+        if (!rows)
+            return;
+        // Performance critical: one decrement per pinned block
+        for (PublishedBlock* b : blocks)
+            rows->unref(b);
+        blocks.clear();
+        rows = nullptr;
+    }
+
+    // Performance critical: column reads, same encoding as the live table (hot path)
+    int64_t ts(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubTs, i & kPublishedBlockMask);
+    }
+    int64_t px(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubPx, i & kPublishedBlockMask);
+    }
+    int64_t qty(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->get(PubQty, i & kPublishedBlockMask);
+    }
+    uint8_t side(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->side(i & kPublishedBlockMask);
+    }
+    RowSnap row(uint32_t i) const {
+        return blocks[i >> kPublishedBlockShift]->row(i & kPublishedBlockMask);
+    }
+
+    // Decodes column f of rows [first, first + n) into out, a block at a time.
+    void decode(uint32_t f, uint32_t first, uint32_t n, int64_t* out) const {
+        // Performance critical: bulk decode for aggregates, SIMD inside a block
+        while (n > 0) {
+            const uint32_t k = first & kPublishedBlockMask;
+            const uint32_t run = n < kPublishedBlockRows - k ? n : kPublishedBlockRows - k;
+            blocks[first >> kPublishedBlockShift]->decode(f, k, run, out);
+            first += run;
+            out += run;
+            n -= run;
+        }
+    }
+};
+
+// Pins the current blocks in one short read section; out keeps the state of that epoch
+// until it is released or reused. Returns false when the table is empty.
+// Performance critical: inline, one short read section per snapshot
+inline bool PublishedRows::snapshot(PublishedSnapshot& out) {
+    out.release();
+    if (num_blocks == 0)
+        return false;
+    const uint64_t e = read_begin();
+    out.blocks.resize(num_blocks);
+    // Performance critical: one pointer copy and one increment per block
+    for (uint32_t b = 0; b < num_blocks; ++b) {
+        blocks[b]->refs.fetch_add(1, std::memory_order_relaxed);
+        out.blocks[b] = blocks[b];
+    }
+    read_end();
+    out.rows = this;
+    out.epoch = e;
+    out.num_rows = num_rows;
+    return true;
+}
+
+// Scoped read section over a PublishedRows; every row read inside belongs to guard.epoch.
+// Must not be held across a publish on the same thread (the publish would just defer).
+struct PublishedReadGuard {
+    PublishedRows& rows;
+    const uint64_t epoch;
+
+    explicit PublishedReadGuard(PublishedRows& r) : rows(r), epoch(r.read_begin()) {}
+    ~PublishedReadGuard() {
+        rows.read_end();
+    }
+    PublishedReadGuard(const PublishedReadGuard&) = delete;
+    PublishedReadGuard& operator=(const PublishedReadGuard&) = delete;
+};
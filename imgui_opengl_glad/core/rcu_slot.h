@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Latest-value handoff from one producer thread to one consumer thread by pointer swap
+// (RCU-style, triple buffered). The producer fills back() and publish() swaps it with the
+// shared middle slot; read() swaps the middle slot with the consumer's own buffer only when
+// something newer was published. Each side owns its buffer until its next swap, so neither
+// waits, and the consumer always gets the newest complete value; values published in between
+// are skipped. A buffer goes back to the producer only once the consumer has moved past it
+// (its grace period), and is then overwritten: back() can hold a value two publishes old,
+// so fill it completely each time, and let T keep its capacity on assignment.
+template <typename T>
+struct RcuSlot {
+    static constexpr uint8_t kIndex = 3;
+    static constexpr uint8_t kFresh = 4;  // middle holds a value the consumer has not taken
+
+    T bufs[3]{};
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t back_idx{0};  // producer only
+    uint64_t published{0};
+    alignas(64) uint8_t front_idx{2};  // consumer only
+    uint64_t taken{0};
+
+    // Producer: the buffer to fill for the next publish
+    T& back() {
+        return bufs[back_idx];
+    }
+
+    // Producer: hands back() to the consumer and takes the previous middle buffer
+    void publish() {
+        back_idx = middle.exchange(back_idx | kFresh, std::memory_order_acq_rel) & kIndex;
+        ++published;
+    }
+
+    // Consumer: the newest published value, valid until the next read()
+    const T& read() {
+        if (middle.load(std::memory_order_acquire) & kFresh) {
+            front_idx = middle.exchange(front_idx, std::memory_order_acq_rel) & kIndex;
+            ++taken;
+        }
+        return bufs[front_idx];
+    }
+
+    // Consumer: the value the last read() returned
+    const T& front() const {
+        return bufs[front_idx];
+    }
+
+    // Either side: a publish the consumer has not read yet
+    bool fresh() const {
+        return (middle.load(std::memory_order_acquire) & kFresh) != 0;
+    }
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "arena.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SEQ_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SEQ_SIMD_NEON 1
+#endif
+
+// Memory layout of the per-row seqlock counters. Chosen once at startup.
+enum class SeqLayout : uint8_t {
+    Dense,    // 4 bytes per row, 16 rows per cache line (smallest, most false sharing)
+    Grouped,  // 8 bytes per row: rows 8k..8k+7 share a line, as they do in each int64 column,
+              // so writers that own whole data lines (--shard) also own their seq line
+    Padded,   // one 64-byte line per row, never shared
+    Colocated,  // inside the row's own MDRowLine (RowStorage::Lines), same line as its data
+};
+
+// Performance critical: no, start-up and report output only
+static inline const char* seq_layout_name(SeqLayout layout) {
+    switch (layout) {
+    case SeqLayout::Grouped:
+        return "grouped";
+    case SeqLayout::Padded:
+        return "padded";
+    case SeqLayout::Colocated:
+        return "colocated";
+    case SeqLayout::Dense:
+        break;
+    }
+    return "dense";
+}
+
+// Performance critical: validates eight seqlock reads at once. Bit k of the result is set
+// when before[k] is even and equal to after[k], i.e. the row read in between is consistent.
+static inline uint32_t seq_stable_mask8(const uint32_t* before, const uint32_t* after) {
+#if defined(SEQ_SIMD_SSE2)
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t mask = 0;
+    // Performance critical: two 4-lane compares cover the group
+    for (int half = 0; half < 2; ++half) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(before + 4 * half));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(after + 4 * half));
+        __m128i even = _mm_cmpeq_epi32(_mm_and_si128(b, one), zero);
+        __m128i ok = _mm_and_si128(_mm_cmpeq_epi32(a, b), even);
+        mask |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(ok)) << (4 * half);
+    }
+    return mask;
+#elif defined(SEQ_SIMD_NEON)
+    static const uint32_t kBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(kBits);
+    const uint32x4_t one = vdupq_n_u32(1);
+    uint32_t mask = 0;
+    // Performance critical: two 4-lane compares cover the group
+    for (int half = 0; half < 2; ++half) {
+        uint32x4_t b = vld1q_u32(before + 4 * half);
+        uint32x4_t a = vld1q_u32(after + 4 * half);
+        uint32x4_t ok = vandq_u32(vceqq_u32(a, b), vceqq_u32(vandq_u32(b, one), vdupq_n_u32(0)));
+        mask |= vaddvq_u32(vandq_u32(ok, bits)) << (4 * half);
+    }
+    return mask;
+#else
+    uint32_t mask = 0;
+    // Performance critical: scalar fallback, eight compares
+    for (int k = 0; k < 8; ++k)
+        mask |= (uint32_t)(before[k] == after[k] && !(before[k] & 1u)) << k;
+    return mask;
+#endif
+}
+
+// Per-row seqlock counters with a configurable stride. Rows are grouped 1 << group_shift
+// per record of 1 << shift words; row i lives at word ((i >> group_shift) << shift) +
+// (i & group_mask) from base. For the owned layouts a group is a single row.
+struct SeqArray {
+    ArenaArray<std::atomic<uint32_t>> storage;  // empty for Colocated
+    std::atomic<uint32_t>* base{nullptr};
+    uint32_t shift{0};
+    uint32_t group_shift{0};
+    uint32_t group_mask{0};
+    SeqLayout layout{SeqLayout::Dense};
+
+    void init(uint32_t num_rows, SeqLayout l, Arena* arena = nullptr) {
+        layout = l == SeqLayout::Colocated ? SeqLayout::Dense : l;  // needs row storage
+        shift = layout == SeqLayout::Padded ? 4 : layout == SeqLayout::Grouped ? 1 : 0;
+        group_shift = 0;
+        group_mask = 0;
+        const size_t kWordsPerLine = 64 / sizeof(std::atomic<uint32_t>);
+        size_t words = ((size_t)num_rows << shift) + kWordsPerLine;  // + slack for alignment
+        storage = make_arena_array<std::atomic<uint32_t>>(arena, words, "seq counters");
+        uintptr_t p = (uintptr_t)storage.get();
+        base = storage.get() + ((64 - (p & 63)) & 63) / sizeof(std::atomic<uint32_t>);
+        // Performance critical: zero every counter once at startup
+        for (size_t w = 0; w < words; ++w)
+            storage[w].store(0, std::memory_order_relaxed);
+    }
+
+    // Points the counters at seq words embedded in caller-owned records: 1 << group_shift
+    // rows per record of 1 << record_shift words, first is row 0's counter.
+    void init_colocated(std::atomic<uint32_t>* first, uint32_t groups_shift,
+                        uint32_t record_shift) {
+        storage.reset();
+        base = first;
+        shift = record_shift;
+        group_shift = groups_shift;
+        group_mask = (1u << groups_shift) - 1;
+        layout = SeqLayout::Colocated;
+    }
+
+    // Adopts a caller-built dense array (tests and tools that size the counters themselves).
+    SeqArray& operator=(std::unique_ptr<std::atomic<uint32_t>[]> dense) {
+        // Performance critical: takes ownership, the counters are not copied
+        storage = ArenaArray<std::atomic<uint32_t>>(dense.release(),
+                                                     ArenaDeleter<std::atomic<uint32_t>>{});
+        base = storage.get();
+        shift = 0;
+        group_shift = 0;
+        group_mask = 0;
+        layout = SeqLayout::Dense;
+        return *this;
+    }
+
+    // Performance critical: inline counter lookup (hot path, two shifts and a mask)
+    inline std::atomic<uint32_t>& operator[](uint32_t row) const {
+        return base[((size_t)(row >> group_shift) << shift) + (row & group_mask)];
+    }
+
+    // Bytes between the counters of two neighbouring groups of rows.
+    uint32_t stride_bytes() const {
+        return (uint32_t)sizeof(std::atomic<uint32_t>) << shift;
+    }
+};
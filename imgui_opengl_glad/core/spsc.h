@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "arena.h"
+
+// Wait-free single-producer, single-consumer ring buffer.
+// head is written only by the producer and tail only by the consumer, each on its own
+// cache line. Both sides keep a private copy of the other side's index and refresh it
+// only when the ring looks full (producer) or shorter than the requested batch
+// (consumer), so in steady state a push touches no shared line besides the slot itself.
+// Capacity must be a power of two.
+struct SPSCRing {
+    alignas(64) std::atomic<uint32_t> head{0};  // next slot to write (producer)
+    uint32_t cached_tail{0};                    // producer's view of tail
+    alignas(64) std::atomic<uint32_t> tail{0};  // next slot to read (consumer)
+    uint32_t cached_head{0};                    // consumer's view of head
+    alignas(64) uint32_t cap_mask{0};
+    ArenaArray<uint32_t> buf;
+
+    void init(uint32_t capacity_pow2, Arena* arena = nullptr) {
+        uint32_t cap = 2;
+        // Performance critical: bit shifting loop for power-of-2 calculation
+        while (cap < capacity_pow2)
+            cap <<= 1;
+        buf = make_arena_array<uint32_t>(arena, cap, "writer rings");
+        cap_mask = cap - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cached_tail = 0;
+        cached_head = 0;
+    }
+
+    uint32_t capacity() const {
+        return cap_mask + 1;
+    }
+
+    // Performance critical: inline wait-free producer push (hot path)
+    inline bool push(uint32_t value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail > cap_mask) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail > cap_mask)
+                return false;
+        }
+        buf[h & cap_mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // All or nothing: returns false when fewer than n slots are free.
+    // Performance critical: inline wait-free producer batch push, one head store (hot path)
+    inline bool push_batch(const uint32_t* values, uint32_t n) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail + n > cap_mask + 1) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail + n > cap_mask + 1)
+                return false;
+        }
+        // Performance critical: contiguous copy into free slots
+        for (uint32_t k = 0; k < n; ++k)
+            buf[(h + k) & cap_mask] = values[k];
+        head.store(h + n, std::memory_order_release);
+        return true;
+    }
+
+    // Performance critical: inline wait-free consumer batch pop (hot path)
+    inline uint32_t pop_batch(uint32_t* out, uint32_t max) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (cached_head - t < max) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t == cached_head)
+                return 0;
+        }
+        uint32_t avail = cached_head - t;
+        uint32_t n = avail < max ? avail : max;
+        // Performance critical: contiguous copy of published entries
+        for (uint32_t k = 0; k < n; ++k)
+            out[k] = buf[(t + k) & cap_mask];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "platform.h"
+
+// Time slice for work that can stop and resume later (IncrementalSort, the table's filter
+// and group passes). Callers report their work in units, rows as a rule, through spend()
+// and stop at a resumable point once it returns false. The clock is read once every
+// kCheckUnits units, so checking costs nothing next to per-row work and a slice overruns by
+// at most that much. The first spend always goes ahead, so every slice makes progress.
+struct WorkBudget {
+    static constexpr uint32_t kCheckUnits = 1024;
+
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t spent{0};
+    uint32_t credit{kCheckUnits};  // units left before the clock is read again
+    bool unlimited{false};
+    bool expired{false};
+
+    // budget_us 0 never expires
+    explicit WorkBudget(uint32_t budget_us)
+        : deadline(lib_now() + std::chrono::microseconds(budget_us)), unlimited(budget_us == 0) {
+    }
+
+    // Accounts units about to be done; false once the slice is over
+    bool spend(uint32_t units) {
+        if (expired)
+            return false;
+        spent += units;
+        if (unlimited || spent == units)
+            return true;
+        if (units < credit) {
+            credit -= units;
+            return true;
+        }
+        credit = kCheckUnits;
+        expired = lib_now() >= deadline;
+        return !expired;
+    }
+};
@@ -0,0 +1,8 @@
+// emsp without Dear ImGui, GLFW or OpenGL: the same plugin, ingest thread and change sets
+// as the GUI host, written to a sink instead of drawn. `emsp --headless` does the same.
+#include "core/host_app.h"
+
+int main(int argc, char** argv) {
+    const EmspConfig config = parseCommandLineArguments(argc, argv, true);
+    return run_headless(config);
+}
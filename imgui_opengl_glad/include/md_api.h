@@ -13,6 +13,20 @@ extern "C" {
   - Plugin writes directly into those arrays.
   - Plugin must call begin_row_write/end_row_write around each row update.
   - After writing a row, plugin calls notify_row_dirty(row_id) to enqueue for UI.
+  - API v2 adds batched writes: begin_batch(ids, n), write the rows, then
+    commit_batch(writer, ids, n) closes every row and publishes all ids with one
+    notification. Ids may repeat within a batch. writer is -1 before v5.
+  - API v3 adds writer_range(): when non-NULL, writer k of n must only write the rows
+    the host assigns to it, so every row has a single writer.
+  - API v4 adds row_lines: when non-NULL the host stores rows in 64-byte MDRowLine
+    blocks (two complete rows and their seq words per cache line) and the column
+    pointers are NULL. v4 plugins must go through the md_* accessors below, which
+    work for both storage modes.
+  - API v5 adds per-writer notification rings: a writer thread may claim a private
+    ring with register_writer() and notify through notify_row_dirty_from(); release it
+    with unregister_writer(). These callbacks are optional and may be NULL.
+  - A plugin may only touch fields of the version the host asked for in
+    get_marketdata_api() (or older).
   - C ABI only at the boundary (POD + function pointers).
 */
 
@@ -24,10 +38,36 @@ typedef struct {
 // Forward declare
 struct HostMDSlot;
 
+// Row-line storage (v4): one cache line holds MD_ROWS_PER_LINE complete rows. The seq
+// words are the host's seqlock counters; plugins never touch them directly.
+#define MD_ROWS_PER_LINE 2
+#if defined(_MSC_VER)
+  #define MD_ALIGN64 __declspec(align(64))
+#else
+  #define MD_ALIGN64 __attribute__((aligned(64)))
+#endif
+typedef struct MD_ALIGN64 MDRowLine {
+    int64_t  ts_ns[MD_ROWS_PER_LINE];
+    int64_t  px_n [MD_ROWS_PER_LINE];
+    int64_t  qty  [MD_ROWS_PER_LINE];
+    uint32_t seq  [MD_ROWS_PER_LINE];
+    uint8_t  side [MD_ROWS_PER_LINE];
+    uint8_t  reserved[6];
+} MDRowLine;  // exactly one 64-byte line
+
 // Host callbacks (implemented by host)
 typedef void (*Host_BeginRowWriteFn)(struct HostMDSlot* slot, uint32_t row_id);
 typedef void (*Host_EndRowWriteFn  )(struct HostMDSlot* slot, uint32_t row_id);
 typedef void (*Host_NotifyDirtyFn  )(struct HostMDSlot* slot, uint32_t row_id);
+typedef int32_t (*Host_RegisterWriterFn  )(struct HostMDSlot* slot);
+typedef void    (*Host_UnregisterWriterFn)(struct HostMDSlot* slot, int32_t writer);
+typedef void    (*Host_NotifyDirtyFromFn )(struct HostMDSlot* slot, int32_t writer, uint32_t row_id);
+typedef void    (*Host_BeginBatchFn )(struct HostMDSlot* slot, const uint32_t* row_ids, uint32_t n);
+typedef void    (*Host_CommitBatchFn)(struct HostMDSlot* slot, int32_t writer,
+                                      const uint32_t* row_ids, uint32_t n);
+typedef int     (*Host_WriterRangeFn)(struct HostMDSlot* slot, uint32_t writer_index,
+                                      uint32_t num_writers, uint32_t* first_row,
+                                      uint32_t* row_count);
 
 // Host-owned buffers and context
 typedef struct HostMDSlot {
@@ -42,11 +82,52 @@ typedef struct HostMDSlot {
     Host_BeginRowWriteFn begin_row_write;
     Host_EndRowWriteFn   end_row_write;
     Host_NotifyDirtyFn   notify_row_dirty;
+
+    // API v2: batched write transactions. writer is a register_writer() handle or -1.
+    Host_BeginBatchFn  begin_batch;
+    Host_CommitBatchFn commit_batch;
+
+    // API v3: row-ownership sharding (NULL = any writer may write any row). Fills the
+    // contiguous partition [first_row, first_row + row_count) owned by writer_index of
+    // num_writers; row_count may be 0. Returns 0 on success.
+    Host_WriterRangeFn writer_range;
+
+    // API v4: row-line storage (NULL = column arrays above).
+    MDRowLine* row_lines;
+
+    // API v5: optional per-writer notification rings (NULL when the host does not offer
+    // them). register_writer returns a handle >= 0, or -1 when no ring is free; a writer
+    // with a negative handle keeps using notify_row_dirty.
+    Host_RegisterWriterFn   register_writer;
+    Host_UnregisterWriterFn unregister_writer;
+    Host_NotifyDirtyFromFn  notify_row_dirty_from;
 } HostMDSlot;
 
+// Field accessors for either storage mode (v4). Scanning a column through them visits
+// one line per MD_ROWS_PER_LINE rows instead of one line per 8 rows.
+static inline int64_t* md_ts_ns(const HostMDSlot* s, uint32_t row) {
+    return s->row_lines ? &s->row_lines[row / MD_ROWS_PER_LINE].ts_ns[row % MD_ROWS_PER_LINE]
+                        : &s->ts_ns[row];
+}
+static inline int64_t* md_px_n(const HostMDSlot* s, uint32_t row) {
+    return s->row_lines ? &s->row_lines[row / MD_ROWS_PER_LINE].px_n[row % MD_ROWS_PER_LINE]
+                        : &s->px_n[row];
+}
+static inline int64_t* md_qty(const HostMDSlot* s, uint32_t row) {
+    return s->row_lines ? &s->row_lines[row / MD_ROWS_PER_LINE].qty[row % MD_ROWS_PER_LINE]
+                        : &s->qty[row];
+}
+static inline uint8_t* md_side(const HostMDSlot* s, uint32_t row) {
+    return s->row_lines ? &s->row_lines[row / MD_ROWS_PER_LINE].side[row % MD_ROWS_PER_LINE]
+                        : &s->side[row];
+}
+
+// Newest API version described by this header; hosts ask for it first and fall back.
+#define MD_API_VERSION 5
+
 // Plugin API
 typedef struct {
-    uint32_t api_version; // must equal host EXPECTED_API
+    uint32_t api_version; // must equal the version the host asked for
 
     // Bind host buffers / callbacks. Return 0 on success.
     int  (*bind_host_buffers)(HostMDSlot* host_slot);
@@ -3,125 +3,15 @@
 #include <glad/glad.h>  // MUST be included before any OpenGL headers (including GLFW)
 #include "GLFW/glfw3.h"
 #include "core/data_updater.h"
+#include "core/frame_pacer.h"
+#include "core/host_app.h"
+#include "core/ingest_thread.h"
 #include "core/main_context.h"
 #include "ui/IMGuiComponents.h"
 
 using namespace std;
 
-void initializeHostContext(HostContext& ctx, HostMDSlot& slot, const EmspConfig& config,
-                           std::vector<int64_t>& ts_ns, std::vector<int64_t>& px_n,
-                           std::vector<int64_t>& qty, std::vector<uint8_t>& side) {
-    // Initialize HostContext
-    ctx.num_rows = config.num_rows;
-    ctx.seq = std::make_unique<std::atomic<uint32_t>[]>(config.num_rows);
-    for (uint32_t i = 0; i < config.num_rows; ++i) {
-        ctx.seq[i].store(0, std::memory_order_relaxed);
-    }
-    ctx.dirty.assign(config.num_rows, 0);
-    ctx.last.resize(config.num_rows);
-    ctx.q.init(1u << 18);
-
-    // Initialize HostMDSlot
-    slot = HostMDSlot{};
-    slot.num_rows = config.num_rows;
-    slot.ts_ns = ts_ns.data();
-    slot.px_n = px_n.data();
-    slot.qty = qty.data();
-    slot.side = side.data();
-    slot.user = &ctx;
-    slot.begin_row_write = &host_begin_row_write;
-    slot.end_row_write = &host_end_row_write;
-    slot.notify_row_dirty = &host_notify_row_dirty;
-}
-
-struct PluginHandle {
-    LibHandle handle;
-    MD_API api;
-    void Cleanup() {
-        if (api.stop) {
-            // Stop the API if not already stopped
-            api.stop();
-            // Give threads time to finish
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-        if (handle) {
-            lib_close(handle);
-        }
-        handle = nullptr;
-        api = {};
-    }
-    ~PluginHandle() {
-        Cleanup();
-    }
-};
-
-bool loadMarketDataPlugin(PluginHandle& plugin, HostMDSlot& slot) {
-#ifdef _WIN32
-    const char* libname = "md_plugin.dll";
-#elif __APPLE__
-    const char* libname = "libmd_plugin.dylib";
-#else
-    const char* libname = "libmd_plugin.so";
-#endif
-
-    plugin.handle = lib_open(libname);
-    if (!plugin.handle) {
-#ifdef _WIN32
-        fprintf(stderr, "Failed to load %s\n", libname);
-#else
-        fprintf(stderr, "Failed to load %s: %s\n", libname, dlerror());
-#endif
-        return false;
-    }
-
-    typedef MD_API (*GetApiFn)(uint32_t);
-    auto get_api = (GetApiFn)lib_sym(plugin.handle, "get_marketdata_api");
-    if (!get_api) {
-        fprintf(stderr, "Symbol get_marketdata_api not found.\n");
-        return false;
-    }
-
-    const uint32_t EXPECTED_API = 1;
-    plugin.api = get_api(EXPECTED_API);
-    if (plugin.api.api_version != EXPECTED_API || !plugin.api.bind_host_buffers ||
-        !plugin.api.start || !plugin.api.stop) {
-        fprintf(stderr, "Plugin API mismatch.\n");
-        plugin.api = {};  // Clear invalid API
-        return false;
-    }
-
-    if (!plugin.handle) {
-        fprintf(stderr, "loading handle failed.\n");
-        return false;
-    }
-
-    if (plugin.api.api_version == 0) {
-        fprintf(stderr, "api_version is 0 which is invalid \n");
-        return false;
-    }
-
-    if (plugin.api.bind_host_buffers(&slot) != 0) {
-        fprintf(stderr, "bind_host_buffers failed.\n");
-        return false;
-    }
-
-    return true;
-}
-
-EmspConfig parseCommandLineArguments(int argc, char** argv) {
-    EmspConfig config;
-
-    if (argc > 1)
-        config.num_rows = std::max(100u, (uint32_t)std::strtoul(argv[1], nullptr, 10));
-    if (argc > 2)
-        config.writers = std::max(1u, (uint32_t)std::strtoul(argv[2], nullptr, 10));
-    if (argc > 3)
-        config.ups = std::max(100u, (uint32_t)std::strtoul(argv[3], nullptr, 10));
-
-    return config;
-}
-
-GLFWwindow* initializeGLFWAndOpenGL(const char** glsl_version_out) {
+GLFWwindow* initializeGLFWAndOpenGL(const char** glsl_version_out, bool vsync) {
     if (!glfwInit())
         return nullptr;
 
@@ -137,7 +27,7 @@ GLFWwindow* initializeGLFWAndOpenGL(const char** glsl_version_out) {
     if (window == NULL)
         return nullptr;
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);  // Enable vsync
+    glfwSwapInterval(vsync ? 1 : 0);  // off: the swap returns at once, may tear
 
     if (!gladLoadGLLoader(
             (GLADloadproc)glfwGetProcAddress))  // tie window context to glad's opengl funcs
@@ -156,64 +46,125 @@ GLFWwindow* initializeGLFWAndOpenGL(const char** glsl_version_out) {
 /**
  * @brief Memory Model Of Main Program
  *
- * This program uses a memory model that relies on stack-allocated vectors
- * to store trading data. The vectors are initialized with a fixed size
- * based on the command line arguments and are not resized during the
- * program's execution.
+ * The trading data columns are sized once from the command line arguments
+ * and never resized while the program runs. Without --arena they are heap
+ * vectors owned by main; with --arena the host carves them from its arena
+ * (one prefaulted mapping, see core/arena.h) and main's vectors stay empty.
  *
  * @param argc
  * @param argv
  * @return int , 0 = success, non zero is error
  */
 int main(int argc, char** argv) {
+    EmspConfig config = parseCommandLineArguments(argc, argv);
+    if (config.headless)
+        return run_headless(config);  // no window, no GL context
+
     const char* glsl_version;
-    GLFWwindow* window = initializeGLFWAndOpenGL(&glsl_version);
+    GLFWwindow* window = initializeGLFWAndOpenGL(&glsl_version, config.vsync);
     if (!window) {
         return 1;
     }
 
-    EmspConfig config = parseCommandLineArguments(argc, argv);
-
-    // Vector Representation of Trading Data
-    // Do not grow these vectors - they are meant to be on stack and maintain the
-    // same size for lifetime of the program
-
-    std::vector<int64_t> ts_ns(config.num_rows, 0);
-    std::vector<int64_t> px_n(config.num_rows, 0);
-    std::vector<int64_t> qty(config.num_rows, 0);
-    std::vector<uint8_t> side(config.num_rows, 0);
+    // Trading data columns when the arena is off. Do not grow these vectors: the host
+    // keeps pointers into them for the lifetime of the program. With --arena they stay
+    // empty and unused, the columns live in the host arena.
+    const uint32_t heap_rows = config.arena_size == ArenaSize::None ? config.num_rows : 0;
+    std::vector<int64_t> ts_ns(heap_rows, 0);
+    std::vector<int64_t> px_n(heap_rows, 0);
+    std::vector<int64_t> qty(heap_rows, 0);
+    std::vector<uint8_t> side(heap_rows, 0);
 
     HostContext ctx;
     HostMDSlot slot;
     initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
-    printf("Host (console) rows=%u writers=%u updates/sec=%u\n", config.num_rows, config.writers,
-           config.ups);
+    Profiler::global().set_thread_name("render");
+    printf("Host (console) rows=%u writers=%u updates/sec=%u notify=%s seq=%s%s\n",
+           config.num_rows, config.writers, config.ups, notify_mode_name(config.notify_mode),
+           seq_layout_name(ctx.seq.layout), config.shard_writers ? " sharded" : "");
+    if (config.arena_size != ArenaSize::None)
+        ctx.arena.print_report(stdout);
+    const uint64_t faults_at_start = os_page_faults();
 
     PluginHandle plugin;
 
     if (loadMarketDataPlugin(plugin, slot)) {
         plugin.api.start(config.writers, config.ups);
-        uint64_t t = now_ms();
-        uint64_t next_paint = t + 100;
 
         ImGuiComponents myimgui;
+        IngestThread ingest;
+        FramePacer pacer;
+        pacer.latency_us = config.latency_ms * 1000;
+        pacer.idle_us = config.idle_ms * 1000;
+        pacer.wake = glfwPostEmptyEvent;
         try {
             myimgui.Init(window, glsl_version);
+            myimgui.SetWorkBudget(config.work_budget_us);
+            myimgui.SetLatencyReportPath(config.latency_out);
+            myimgui.SetTracePath(config.trace_out);
+            // Single ingest stage on its own thread: drains, publishes and updates the
+            // views every config.ingest_period_us, whatever the frame rate; the loop below
+            // only draws the views it hands over, when the pacer says a frame is due
+            myimgui.Attach(ctx, slot, &pacer);
+            ingest.start(ctx, slot, config.ingest_period_us);
+            // Performance critical: sleeps in the event wait unless input or data is pending
             while (!glfwWindowShouldClose(window)) {
-                glfwPollEvents();
-
-                update_latest_data_from_context(ctx, config, t, next_paint, slot);
-
-                glClear(GL_COLOR_BUFFER_BIT);
-                myimgui.NewFrame();
-                myimgui.Update(ctx, slot, next_paint);
-                myimgui.Render();
-                glfwSwapBuffers(window);
-                next_paint = t + 250;
+                const int64_t wait = pacer.wait_us(FramePacer::now_us());
+                if (wait > 0) {
+                    glfwWaitEventsTimeout(wait * 1e-6);
+                    ++pacer.stats.waits;
+                } else {
+                    glfwPollEvents();
+                }
+
+                const int64_t now = FramePacer::now_us();
+                const FramePacer::Reason reason = pacer.next_paint(now);
+                if (reason == FramePacer::None)
+                    continue;
+                if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+                    // Nothing to show: keep the data pending, check back after idle_ms
+                    glfwWaitEventsTimeout(config.idle_ms * 1e-3);
+                    continue;
+                }
+
+                pacer.begin_frame(reason, now);
+                {
+                    PROFILE_SCOPE("frame");
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    myimgui.NewFrame();
+                    myimgui.Update(ctx, slot);
+                    myimgui.Render();
+                    {
+                        PROFILE_SCOPE("glfwSwapBuffers");
+                        glfwSwapBuffers(window);
+                    }
+                    myimgui.FramePresented(ctx);
+                }
+                pacer.end_frame(FramePacer::now_us());
             }
 
             // Proper shutdown sequence
             printf("Shutting down...\n");
+            ingest.stop();
+            printf("Ingest: %llu cycles, %llu rows, slowest cycle %u us\n",
+                   (unsigned long long)ingest.cycles.load(), (unsigned long long)ingest.rows.load(),
+                   ingest.max_cycle_us.load());
+            pacer.print_report(stdout);
+            printf("Page faults since startup: %llu\n",
+                   (unsigned long long)(os_page_faults() - faults_at_start));
+            printf("Snapshots: %llu rows, %llu torn, %llu retries, %llu failed (deferred)\n",
+                   (unsigned long long)ctx.snap_stats.rows,
+                   (unsigned long long)ctx.snap_stats.torn,
+                   (unsigned long long)ctx.snap_stats.retries,
+                   (unsigned long long)ctx.snap_stats.failures);
+            if (!config.trace_out.empty() &&
+                Profiler::global().export_chrome_trace(config.trace_out.c_str()))
+                printf("Trace written to %s\n", config.trace_out.c_str());
+            if (ctx.latency.on()) {
+                ctx.latency.write_summary(stdout);
+                if (!config.latency_out.empty() && ctx.latency.dump(config.latency_out.c_str()))
+                    printf("Latency report written to %s\n", config.latency_out.c_str());
+            }
 
             // 1. Stop the plugin first to stop generating new data
             plugin.api.stop();
@@ -228,6 +179,7 @@ int main(int argc, char** argv) {
 
         } catch (...) {
             fprintf(stderr, "An error occurred, cleaning up\n");
+            ingest.stop();
             plugin.api.stop();
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             myimgui.Shutdown();
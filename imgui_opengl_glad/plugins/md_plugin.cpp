@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <vector>
@@ -12,37 +13,89 @@
 using namespace std::chrono;
 
 static HostMDSlot* g_slot = nullptr;
+static uint32_t g_api_version = 0;  // version negotiated in get_marketdata_api
 static std::atomic<bool> g_run{false};
 static std::vector<std::thread> g_threads;
 
-static void writer_thread(uint32_t thread_id, uint32_t updates_per_sec) {
+// Row field addresses. v4 hosts may keep rows in MDRowLine blocks; older hosts only have
+// the column arrays and no row_lines field.
+static int64_t* ts_at(uint32_t i)  { return g_api_version >= 4 ? md_ts_ns(g_slot, i) : &g_slot->ts_ns[i]; }
+static int64_t* px_at(uint32_t i)  { return g_api_version >= 4 ? md_px_n (g_slot, i) : &g_slot->px_n [i]; }
+static int64_t* qty_at(uint32_t i) { return g_api_version >= 4 ? md_qty  (g_slot, i) : &g_slot->qty  [i]; }
+static uint8_t* side_at(uint32_t i){ return g_api_version >= 4 ? md_side (g_slot, i) : &g_slot->side [i]; }
+
+static void writer_thread(uint32_t thread_id, uint32_t threads, uint32_t updates_per_sec) {
     std::mt19937_64 rng((uint64_t)steady_clock::now().time_since_epoch().count() ^ (thread_id*0x9e3779b97f4a7c15ull));
-    std::uniform_int_distribution<uint32_t> row_dist(0, g_slot->num_rows-1);
+
+    // Sharded hosts (v3) hand each writer its own rows; otherwise pick from the whole table
+    uint32_t first_row = 0, row_count = g_slot->num_rows;
+    if (g_api_version >= 3 && g_slot->writer_range &&
+        g_slot->writer_range(g_slot, thread_id, threads, &first_row, &row_count) != 0)
+        return;
+    if (row_count == 0)
+        return;  // more writers than row partitions
+    std::uniform_int_distribution<uint32_t> row_dist(first_row, first_row + row_count - 1);
     std::uniform_int_distribution<int64_t>  px_jump(-50, 50);
     std::uniform_int_distribution<int64_t>  qty_jump(1, 100);
     // Note: side is no longer updated - it's immutable after initialization
 
+    // Claim a private notification ring when the host offers them (v5, -1 = shared queue)
+    int32_t writer =
+        g_api_version >= 5 && g_slot->register_writer ? g_slot->register_writer(g_slot) : -1;
+
+    // v2 hosts take a whole simulated feed packet per begin_batch/commit_batch pair;
+    // packets carry up to kMaxBatch rows, about one packet per millisecond per writer
+    const uint32_t kMaxBatch = 32;
+    const bool batched = g_api_version >= 2 && g_slot->begin_batch && g_slot->commit_batch;
+    const uint32_t batch =
+        batched ? std::min(kMaxBatch, std::max(1u, updates_per_sec / 1000)) : 1;
+    uint32_t ids[kMaxBatch];
+
     double per_update_ns = 1e9 / (double)updates_per_sec;
     auto next_tick = steady_clock::now();
 
     while (g_run.load(std::memory_order_acquire)) {
+        if (batched) {
+            for (uint32_t k = 0; k < batch; ++k)
+                ids[k] = row_dist(rng);
+            int64_t ts = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+            g_slot->begin_batch(g_slot, ids, batch);
+            for (uint32_t k = 0; k < batch; ++k) {
+                uint32_t i = ids[k];
+                *ts_at(i)  = ts;
+                *px_at(i)  += px_jump(rng);
+                *qty_at(i) += qty_jump(rng);
+            }
+            g_slot->commit_batch(g_slot, writer, ids, batch);
+
+            next_tick += nanoseconds((long long)(per_update_ns * batch));
+            std::this_thread::sleep_until(next_tick);
+            continue;
+        }
+
         uint32_t i = row_dist(rng);
         int64_t ts = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
-        int64_t px = g_slot->px_n[i] + px_jump(rng);
-        int64_t qt = g_slot->qty[i] + qty_jump(rng);
+        int64_t px = *px_at(i) + px_jump(rng);
+        int64_t qt = *qty_at(i) + qty_jump(rng);
         // Side is immutable - no longer updated here
 
         g_slot->begin_row_write(g_slot, i);
-        g_slot->ts_ns[i] = ts;
-        g_slot->px_n [i] = px;
-        g_slot->qty  [i] = qt;
+        *ts_at(i)  = ts;
+        *px_at(i)  = px;
+        *qty_at(i) = qt;
         // g_slot->side [i] = sd;  // REMOVED: side is immutable
         g_slot->end_row_write(g_slot, i);
-        g_slot->notify_row_dirty(g_slot, i);
+        if (writer >= 0)
+            g_slot->notify_row_dirty_from(g_slot, writer, i);
+        else
+            g_slot->notify_row_dirty(g_slot, i);
 
         next_tick += nanoseconds((long long)per_update_ns);
         std::this_thread::sleep_until(next_tick);
     }
+
+    if (writer >= 0 && g_slot->unregister_writer)
+        g_slot->unregister_writer(g_slot, writer);
 }
 
 extern "C" int bind_host_buffers_c(HostMDSlot* slot) {
@@ -54,7 +107,7 @@ extern "C" int bind_host_buffers_c(HostMDSlot* slot) {
     std::uniform_int_distribution<int> side_pick(1, 2); // 1 = Buy (bid), 2 = Sell (ask)
     
     for (uint32_t i = 0; i < slot->num_rows; ++i) {
-        slot->side[i] = (uint8_t)side_pick(init_rng);
+        *side_at(i) = (uint8_t)side_pick(init_rng);
     }
     
     return 0;
@@ -66,7 +119,7 @@ extern "C" void start_c(uint32_t threads, uint32_t updates_per_sec) {
     g_threads.reserve(threads);
     uint32_t ups_per_thread = std::max(1u, updates_per_sec / std::max(1u, threads));
     for (uint32_t t=0; t<threads; ++t) {
-        g_threads.emplace_back(writer_thread, t, ups_per_thread);
+        g_threads.emplace_back(writer_thread, t, threads, ups_per_thread);
     }
 }
 
@@ -78,8 +131,9 @@ extern "C" void stop_c(void) {
 
 extern "C" API_EXPORT MD_API get_marketdata_api(uint32_t expected) {
     MD_API api{};
-    if (expected != 1) return api;
-    api.api_version = 1;
+    if (expected < 1 || expected > 5) return api;
+    g_api_version = expected;
+    api.api_version = expected;
     api.bind_host_buffers = &bind_host_buffers_c;
     api.start = &start_c;
     api.stop  = &stop_c;
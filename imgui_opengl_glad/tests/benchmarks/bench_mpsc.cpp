@@ -0,0 +1,169 @@
+// Throughput comparison: per-cell sequence MPSC queue vs the previous head/tail ring.
+//
+// Usage: bench_mpsc [duration_ms]
+//
+// For 1/2/4/8/16 producers, every producer pushes as fast as it can for the given
+// duration while one consumer drains. Reported per queue:
+//   push Mops/s   accepted pushes per second (all producers)
+//   pop Mops/s    entries delivered to the consumer per second
+//   drop %        pushes rejected because the ring was full
+//   anomalies     entries that broke per-producer FIFO order (torn / stale reads)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../../core/mpsc.h"
+
+namespace {
+
+// The queue as it was before per-cell sequence stamps, kept verbatim for comparison.
+struct LegacyMPSCQueue {
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    uint32_t cap_mask{0};
+    std::vector<uint32_t> buf;
+
+    void init(uint32_t capacity_pow2) {
+        buf.resize(MPSCQueue::next_pow2(capacity_pow2));
+        cap_mask = (uint32_t)buf.size() - 1;
+    }
+
+    bool push(uint32_t value) {
+        uint32_t h = head.fetch_add(1, std::memory_order_acq_rel);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= buf.size())
+            return false;
+        buf[h & cap_mask] = value;
+        return true;
+    }
+
+    bool pop(uint32_t& out) {
+        uint32_t t = tail.load(std::memory_order_acquire);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (t == h)
+            return false;
+        out = buf[t & cap_mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+struct Result {
+    double push_mops;
+    double pop_mops;
+    double drop_pct;
+    uint64_t anomalies;
+};
+
+// Consumer drain adapters: the legacy ring only supports single pops.
+uint32_t drain(LegacyMPSCQueue& q, uint32_t* out, uint32_t max) {
+    uint32_t n = 0;
+    while (n < max && q.pop(out[n]))
+        ++n;
+    return n;
+}
+uint32_t drain(MPSCQueue& q, uint32_t* out, uint32_t max) {
+    return q.pop_batch(out, max);
+}
+
+template <typename Queue>
+Result run(uint32_t producers, uint32_t duration_ms) {
+    Queue q;
+    q.init(1u << 18);  // same capacity as the host
+
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> accepted(producers, 0);
+    std::vector<uint64_t> rejected(producers, 0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            uint32_t i = 0;
+            uint64_t ok = 0, fail = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                // value = producer id (high 8 bits) + per-producer counter
+                if (q.push((p << 24) | (i & 0xFFFFFFu))) {
+                    ++ok;
+                    ++i;
+                } else {
+                    ++fail;
+                }
+            }
+            accepted[p] = ok;
+            rejected[p] = fail;
+        });
+    }
+
+    std::vector<uint32_t> next_expected(producers, 0);
+    uint64_t popped = 0, anomalies = 0;
+    uint32_t out[512];
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(duration_ms);
+    go.store(true, std::memory_order_release);
+    while (std::chrono::steady_clock::now() < end) {
+        uint32_t n = drain(q, out, 512);
+        for (uint32_t k = 0; k < n; ++k) {
+            uint32_t p = out[k] >> 24;
+            uint32_t v = out[k] & 0xFFFFFFu;
+            if (p >= producers || v != (next_expected[p] & 0xFFFFFFu)) {
+                ++anomalies;
+                if (p < producers)
+                    next_expected[p] = v + 1;
+            } else {
+                ++next_expected[p];
+            }
+        }
+        popped += n;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads)
+        t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t ok = 0, fail = 0;
+    for (uint32_t p = 0; p < producers; ++p) {
+        ok += accepted[p];
+        fail += rejected[p];
+    }
+    Result r;
+    r.push_mops = ok / secs / 1e6;
+    r.pop_mops = popped / secs / 1e6;
+    r.drop_pct = (ok + fail) ? 100.0 * fail / (double)(ok + fail) : 0.0;
+    r.anomalies = anomalies;
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t duration_ms = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 500;
+    duration_ms = std::max(50u, duration_ms);
+
+    std::printf("MPSC queue throughput, %u ms per run, capacity 2^18, hw threads=%u\n\n",
+                duration_ms, std::thread::hardware_concurrency());
+    std::printf("%-9s | %-44s | %-44s\n", "", "legacy (head/tail)",
+                "per-cell seq + pop_batch");
+    std::printf("%-9s | %10s %10s %8s %12s | %10s %10s %8s %12s\n", "producers", "push Mops",
+                "pop Mops", "drop %", "anomalies", "push Mops", "pop Mops", "drop %",
+                "anomalies");
+
+    const uint32_t counts[] = {1, 2, 4, 8, 16};
+    for (uint32_t producers : counts) {
+        Result legacy = run<LegacyMPSCQueue>(producers, duration_ms);
+        Result vyukov = run<MPSCQueue>(producers, duration_ms);
+        std::printf("%-9u | %10.2f %10.2f %8.2f %12llu | %10.2f %10.2f %8.2f %12llu\n",
+                    producers, legacy.push_mops, legacy.pop_mops, legacy.drop_pct,
+                    (unsigned long long)legacy.anomalies, vyukov.push_mops, vyukov.pop_mops,
+                    vyukov.drop_pct, (unsigned long long)vyukov.anomalies);
+    }
+    return 0;
+}
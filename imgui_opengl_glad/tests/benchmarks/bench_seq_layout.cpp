@@ -0,0 +1,134 @@
+// Seq counter layout comparison: dense vs grouped vs padded columns, and row-line storage
+// (--storage=lines) where each row shares one cache line with its own seq word.
+//
+// Usage: bench_seq_layout [duration_ms] [hot_rows]
+//
+// Writers update a window of hot_rows adjacent rows, interleaved so that neighbouring
+// rows belong to different writers (the worst case for false sharing on the counters).
+// Each writer owns its rows, so the seqlock is used correctly. One reader thread takes
+// row_snapshot of the same window in a loop, like the paint loop does. Reported per layout:
+//   Mupd/s     row updates per second (all writers)
+//   snaps/s    successful snapshots per second (reader)
+//   retry %    snapshots that failed because a write was in progress or completed meanwhile
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../core/main_context.h"
+
+namespace {
+
+struct Result {
+    double mups;
+    double snaps_per_sec;
+    double retry_pct;
+};
+
+Result run(SeqLayout layout, uint32_t writers, uint32_t duration_ms, uint32_t hot_rows) {
+    const uint32_t num_rows = std::max(hot_rows, 1024u);
+    std::vector<int64_t> ts_ns(num_rows, 0), px_n(num_rows, 1000), qty(num_rows, 0);
+    std::vector<uint8_t> side(num_rows, 1);
+    HostContext ctx;
+    ctx.num_rows = num_rows;
+    HostMDSlot slot{};
+    slot.num_rows = num_rows;
+    if (layout == SeqLayout::Colocated) {
+        // Row-line storage, set up the way initializeHostContext does it
+        ctx.row_lines = make_arena_array<MDRowLine>(nullptr, num_rows / MD_ROWS_PER_LINE, "row lines");
+        ctx.seq.init_colocated(
+            reinterpret_cast<std::atomic<uint32_t>*>(&ctx.row_lines[0].seq[0]), 1, 4);
+        slot.row_lines = ctx.row_lines.get();
+    } else {
+        ctx.seq.init(num_rows, layout);
+        slot.ts_ns = ts_ns.data();
+        slot.px_n = px_n.data();
+        slot.qty = qty.data();
+        slot.side = side.data();
+    }
+    slot.user = &ctx;
+    slot.begin_row_write = &host_begin_row_write;
+    slot.end_row_write = &host_end_row_write;
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> updates(writers, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            uint64_t n = 0;
+            uint32_t i = w;
+            while (!stop.load(std::memory_order_relaxed)) {
+                slot.begin_row_write(&slot, i);
+                *md_ts_ns(&slot, i) = (int64_t)n;
+                *md_px_n(&slot, i) += 1;
+                *md_qty(&slot, i) += 1;
+                slot.end_row_write(&slot, i);
+                ++n;
+                i += writers;
+                if (i >= hot_rows)
+                    i = w;
+            }
+            updates[w] = n;
+        });
+    }
+
+    uint64_t attempts = 0, ok = 0;
+    std::thread reader([&] {
+        HostContext::RowSnap snap{};
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (uint32_t i = 0; i < hot_rows; ++i) {
+                ++attempts;
+                ok += row_snapshot(&ctx, &slot, i, snap);
+            }
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads)
+        t.join();
+    reader.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (uint32_t w = 0; w < writers; ++w)
+        total += updates[w];
+    Result r{};
+    r.mups = total / secs / 1e6;
+    r.snaps_per_sec = ok / secs;
+    r.retry_pct = attempts ? 100.0 * (attempts - ok) / attempts : 0.0;
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t duration_ms = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 500;
+    uint32_t hot_rows = argc > 2 ? (uint32_t)std::strtoul(argv[2], nullptr, 10) : 64;
+    duration_ms = std::max(50u, duration_ms);
+    hot_rows = std::max(16u, hot_rows);
+
+    std::printf("Seq layout, %u ms per run, %u adjacent hot rows, hardware threads=%u\n\n",
+                duration_ms, hot_rows, std::thread::hardware_concurrency());
+    std::printf("%-7s | %-9s | %10s %12s %8s\n", "writers", "layout", "Mupd/s", "snaps/s",
+                "retry %");
+
+    const uint32_t counts[] = {1, 2, 4, 8};
+    const SeqLayout layouts[] = {SeqLayout::Dense, SeqLayout::Grouped, SeqLayout::Padded,
+                                 SeqLayout::Colocated};
+    for (uint32_t writers : counts) {
+        for (int m = 0; m < 4; ++m) {
+            Result r = run(layouts[m], writers, duration_ms, hot_rows);
+            std::printf("%-7s | %-9s | %10.2f %12.0f %8.2f\n",
+                        m == 0 ? std::to_string(writers).c_str() : "",
+                        seq_layout_name(layouts[m]), r.mups, r.snaps_per_sec, r.retry_pct);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Writer scaling with and without row-ownership sharding.
+//
+// Usage: bench_shard [duration_ms] [num_rows]
+//
+// Each writer thread runs the plugin's write path (begin_row_write, read-modify-write of
+// px/qty, end_row_write) through the HostMDSlot callbacks as fast as it can. "uniform"
+// picks rows from the whole table like the unsharded plugin; "sharded" keeps each writer
+// inside the partition returned by host_writer_range. Reported per mode:
+//   Mupd/s       row updates per second (all writers)
+//   collisions   begin_row_write calls that found the row already open by another writer
+//                (each one is a seqlock protocol violation)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../core/main_context.h"
+
+namespace {
+
+struct Result {
+    double mups;
+    uint64_t collisions;
+};
+
+Result run(bool sharded, uint32_t writers, uint32_t duration_ms, uint32_t num_rows) {
+    std::vector<int64_t> ts_ns(num_rows, 0), px_n(num_rows, 1000), qty(num_rows, 0);
+    std::vector<uint8_t> side(num_rows, 1);
+    HostContext ctx;
+    ctx.num_rows = num_rows;
+    ctx.seq = std::make_unique<std::atomic<uint32_t>[]>(num_rows);
+    for (uint32_t i = 0; i < num_rows; ++i)
+        ctx.seq[i].store(0, std::memory_order_relaxed);
+
+    HostMDSlot slot{};
+    slot.num_rows = num_rows;
+    slot.ts_ns = ts_ns.data();
+    slot.px_n = px_n.data();
+    slot.qty = qty.data();
+    slot.side = side.data();
+    slot.user = &ctx;
+    slot.begin_row_write = &host_begin_row_write;
+    slot.end_row_write = &host_end_row_write;
+    slot.writer_range = sharded ? &host_writer_range : nullptr;
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> updates(writers, 0), collisions(writers, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            uint32_t first = 0, count = num_rows;
+            if (slot.writer_range)
+                slot.writer_range(&slot, w, writers, &first, &count);
+            if (count == 0)
+                return;
+            std::mt19937 rng(w * 7919u + 1);
+            std::uniform_int_distribution<uint32_t> row(first, first + count - 1);
+            uint64_t n = 0, hit = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint32_t i = row(rng);
+                hit += ctx.seq[i].load(std::memory_order_relaxed) & 1u;
+                slot.begin_row_write(&slot, i);
+                slot.ts_ns[i] = (int64_t)n;
+                slot.px_n[i] += 1;
+                slot.qty[i] += 1;
+                slot.end_row_write(&slot, i);
+                ++n;
+            }
+            updates[w] = n;
+            collisions[w] = hit;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads)
+        t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Result r{};
+    uint64_t total = 0;
+    for (uint32_t w = 0; w < writers; ++w) {
+        total += updates[w];
+        r.collisions += collisions[w];
+    }
+    r.mups = total / secs / 1e6;
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t duration_ms = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 500;
+    uint32_t num_rows = argc > 2 ? (uint32_t)std::strtoul(argv[2], nullptr, 10) : 10000;
+    duration_ms = std::max(50u, duration_ms);
+    num_rows = std::max(100u, num_rows);
+
+    std::printf("Writer scaling, %u ms per run, rows=%u, hardware threads=%u\n\n", duration_ms,
+                num_rows, std::thread::hardware_concurrency());
+    std::printf("%-7s | %-8s | %10s %12s\n", "writers", "mode", "Mupd/s", "collisions");
+
+    const uint32_t counts[] = {1, 2, 4, 8, 16};
+    for (uint32_t writers : counts) {
+        const Result results[] = {run(false, writers, duration_ms, num_rows),
+                                  run(true, writers, duration_ms, num_rows)};
+        const char* names[] = {"uniform", "sharded"};
+        for (int m = 0; m < 2; ++m) {
+            std::printf("%-7s | %-8s | %10.2f %12llu\n",
+                        m == 0 ? std::to_string(writers).c_str() : "", names[m], results[m].mups,
+                        (unsigned long long)results[m].collisions);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Paint-time refresh cost: per-row row_snapshot vs batched snapshot_rows.
+//
+// Usage: bench_snapshot [num_rows] [writers] [paints]
+//
+// Every row is marked dirty before each paint, then the render-thread refresh runs over
+// the whole table, like the ingest stage (run_ingest_cycle) with a fully dirty table:
+// the previous per-row loop vs refresh_dirty_rows on top of snapshot_rows.
+// Writers (0 = quiet table) keep updating random rows through the seqlock meanwhile.
+// Reported per storage and mode:
+//   ms/paint   average refresh time for num_rows dirty rows
+//   Mrows/s    rows snapshotted per second
+//   torn %     reads that found the row torn (writer/reader interference)
+//   deferred   rows still torn after the retries, carried to the next paint
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../core/data_updater.h"
+
+namespace {
+
+struct Result {
+    double ms_per_paint;
+    double mrows;
+    double torn_pct;
+    uint64_t deferred;
+};
+
+Result run(RowStorage storage, bool batched, uint32_t num_rows, uint32_t writers,
+           uint32_t paints) {
+    EmspConfig config;
+    config.num_rows = num_rows;
+    config.row_storage = storage;
+    std::vector<int64_t> ts_ns(num_rows, 0), px_n(num_rows, 0), qty(num_rows, 0);
+    std::vector<uint8_t> side(num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::mt19937 rng(w + 1);
+            int64_t n = 0;
+            // Performance critical: writer load while the paints run
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint32_t i = rng() % num_rows;
+                slot.begin_row_write(&slot, i);
+                *md_px_n(&slot, i) = ++n;
+                slot.end_row_write(&slot, i);
+            }
+        });
+    }
+
+    uint64_t torn = 0, deferred = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t p = 0; p < paints; ++p) {
+        ctx.dirty.mark_all();
+        if (batched) {
+            refresh_dirty_rows(ctx, slot, ctx.dirty, [](uint32_t, const HostContext::RowSnap&) {});
+            torn = ctx.snap_stats.torn;
+            deferred = ctx.snap_stats.deferred;
+            continue;
+        }
+        // Performance critical: the pre-batch refresh loop, two tries per row
+        ctx.dirty.consume([&](uint32_t i) {
+            HostContext::RowSnap tmp{};
+            bool good = false;
+            for (int tries = 0; tries < 2 && !good; ++tries) {
+                good = row_snapshot(&ctx, &slot, i, tmp);
+                torn += tries == 0 && !good;
+            }
+            deferred += !good;  // the old loop dropped these
+            if (good && !ctx.published.same(i, tmp))
+                ctx.published.set(i, tmp);
+        });
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads)
+        t.join();
+
+    Result r{};
+    r.ms_per_paint = secs * 1000.0 / paints;
+    r.mrows = (double)num_rows * paints / secs / 1e6;
+    r.torn_pct = 100.0 * torn / ((double)num_rows * paints);
+    r.deferred = deferred;
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t num_rows = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 100000;
+    uint32_t writers = argc > 2 ? (uint32_t)std::strtoul(argv[2], nullptr, 10) : 2;
+    uint32_t paints = argc > 3 ? (uint32_t)std::strtoul(argv[3], nullptr, 10) : 50;
+    num_rows = std::max(1000u, num_rows);
+    paints = std::max(1u, paints);
+
+    std::printf("Snapshot refresh, rows=%u writers=%u paints=%u, hardware threads=%u\n\n",
+                num_rows, writers, paints, std::thread::hardware_concurrency());
+    std::printf("%-8s | %-8s | %10s %10s %8s %9s\n", "storage", "mode", "ms/paint", "Mrows/s",
+                "torn %", "deferred");
+
+    const RowStorage storages[] = {RowStorage::Columns, RowStorage::Lines};
+    const char* storage_names[] = {"columns", "lines"};
+    for (int s = 0; s < 2; ++s) {
+        for (int batched = 0; batched < 2; ++batched) {
+            Result r = run(storages[s], batched != 0, num_rows, writers, paints);
+            std::printf("%-8s | %-8s | %10.3f %10.1f %8.4f %9llu\n",
+                        batched ? "" : storage_names[s], batched ? "batched" : "per-row",
+                        r.ms_per_paint, r.mrows, r.torn_pct, (unsigned long long)r.deferred);
+        }
+    }
+    return 0;
+}
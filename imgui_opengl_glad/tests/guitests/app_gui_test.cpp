@@ -41,7 +41,7 @@ struct AppGuiTestVars {
             ctx.seq[i].store(0, std::memory_order_relaxed);
         }
         ctx.dirty.assign(num_rows, 0);
-        ctx.last.resize(num_rows);
+        ctx.published.init(num_rows);
         ctx.q.init(1u << 18);
         
         // Initialize slot
@@ -82,7 +82,9 @@ void RegisterAppGuiTests(ImGuiTestEngine* engine) {
             static uint64_t next_paint_ms = 0;
             bool should_refresh = (t >= next_paint_ms);
             
-            vars.market_data_table->UpdateFromContext(vars.ctx, vars.slot, should_refresh);
+            vars.market_data_table->Subscribe(vars.ctx, vars.slot);
+            if (should_refresh)
+                run_ingest_cycle(vars.ctx, vars.slot);
             vars.market_data_table->Render(vars.ctx, vars.slot);
             
             if (should_refresh) {
@@ -117,7 +119,9 @@ void RegisterAppGuiTests(ImGuiTestEngine* engine) {
             static uint64_t next_paint_ms = 0;
             bool should_refresh = (t >= next_paint_ms);
             
-            vars.market_data_table->UpdateFromContext(vars.ctx, vars.slot, should_refresh);
+            vars.market_data_table->Subscribe(vars.ctx, vars.slot);
+            if (should_refresh)
+                run_ingest_cycle(vars.ctx, vars.slot);
             vars.market_data_table->Render(vars.ctx, vars.slot);
             
             if (should_refresh) {
@@ -158,7 +162,9 @@ void RegisterAppGuiTests(ImGuiTestEngine* engine) {
             static uint64_t next_paint_ms = 0;
             bool should_refresh = (t >= next_paint_ms);
             
-            vars.market_data_table->UpdateFromContext(vars.ctx, vars.slot, should_refresh);
+            vars.market_data_table->Subscribe(vars.ctx, vars.slot);
+            if (should_refresh)
+                run_ingest_cycle(vars.ctx, vars.slot);
             vars.market_data_table->Render(vars.ctx, vars.slot);
             
             if (should_refresh) {
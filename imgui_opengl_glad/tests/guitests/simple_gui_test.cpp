@@ -41,7 +41,7 @@ struct NavigatorTestVars {
             ctx.seq[i].store(0, std::memory_order_relaxed);
         }
         ctx.dirty.assign(num_rows, 0);
-        ctx.last.resize(num_rows);
+        ctx.published.init(num_rows);
         ctx.q.init(1u << 18);
         
         // Initialize slot
@@ -57,6 +57,7 @@ struct NavigatorTestVars {
         // Initialize Navigator directly (Test Engine provides ImGui context)
         navigator = std::make_unique<Navigator>();
         navigator->Initialize(num_rows);
+        navigator->Subscribe(ctx);
     }
     
     void Cleanup() {
@@ -96,7 +97,7 @@ struct FilterIntegrationVars {
             ctx.seq[i].store(0, std::memory_order_relaxed);
         }
         ctx.dirty.assign(num_rows, 0);
-        ctx.last.resize(num_rows);
+        ctx.published.init(num_rows);
         ctx.q.init(1u << 18);
         
         // Initialize slot
@@ -285,10 +286,12 @@ void RegisterSimpleGuiTests(ImGuiTestEngine* e)
             vars.qty[i] = 100;
             vars.side[i] = (i < 10) ? 1 : 2;
             vars.ctx.seq[i].store(1, std::memory_order_relaxed);
-            vars.ctx.dirty[i] = (i < 5) ? 1 : 0;
+            if (i < 5)
+                vars.ctx.dirty.mark(i);
         }
         
         if (vars.navigator) {
+            run_ingest_cycle(vars.ctx, vars.slot);  // stands in for the ingest thread
             vars.navigator->Render(vars.ctx, vars.slot);
         }
     };
@@ -385,7 +388,9 @@ void RegisterSimpleGuiTests(ImGuiTestEngine* e)
         
         // Render both components - Navigator gets table pointer for filter interaction
         if (vars.navigator && vars.table) {
-            vars.table->UpdateFromContext(vars.ctx, vars.slot, true);
+            vars.table->Subscribe(vars.ctx, vars.slot);
+            vars.navigator->Subscribe(vars.ctx);
+            run_ingest_cycle(vars.ctx, vars.slot);  // stands in for the ingest thread
             
             // Render both windows
             vars.navigator->Render(vars.ctx, vars.slot, vars.table.get());
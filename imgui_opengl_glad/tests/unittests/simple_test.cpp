@@ -88,7 +88,7 @@ TEST(BasicDataUpdaterTest, MinimalTest) {
         ctx.seq[i].store(0, std::memory_order_relaxed);
     }
     ctx.dirty.assign(config.num_rows, 0);
-    ctx.last.resize(config.num_rows);
+    ctx.published.init(config.num_rows);
     ctx.q.init(1u << 8);
 
     // Create test data arrays
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "../../core/arena.h"
+#include "../../core/data_updater.h"
+
+/**
+ * @brief Size classes parse case-insensitively and map to the documented byte counts
+ */
+TEST(ArenaTest, SizeClasses) {
+    ArenaSize size = ArenaSize::None;
+    EXPECT_TRUE(parse_arena_size("xs", size));
+    EXPECT_EQ(size, ArenaSize::XS);
+    EXPECT_TRUE(parse_arena_size("XXL", size));
+    EXPECT_EQ(size, ArenaSize::XXL);
+    EXPECT_FALSE(parse_arena_size("xxxl", size));
+    EXPECT_FALSE(parse_arena_size("", size));
+    EXPECT_EQ(size, ArenaSize::XXL);
+
+    EXPECT_EQ(arena_size_bytes(ArenaSize::XS), 128ull << 20);
+    EXPECT_EQ(arena_size_bytes(ArenaSize::XL), 2048ull << 20);
+    EXPECT_EQ(arena_size_bytes(ArenaSize::None), 0u);
+}
+
+/**
+ * @brief Bump allocation is aligned, tagged, and spills to the heap once full
+ */
+TEST(ArenaTest, AllocAlignsAndSpills) {
+    Arena arena;
+    ASSERT_TRUE(arena.reserve(1, false));
+    EXPECT_EQ(arena.capacity, 2ull << 20) << "rounded up to 2 MB";
+
+    void* a = arena.alloc(10, 64, "a");
+    void* b = arena.alloc(10, 64, "b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ((uintptr_t)b % 64, 0u);
+    EXPECT_EQ((uint8_t*)b - (uint8_t*)a, 64);
+    EXPECT_TRUE(arena.owns(a));
+
+    EXPECT_EQ(arena.alloc(arena.capacity, 64, "big"), nullptr);
+    EXPECT_EQ(arena.spilled_count, 1u);
+
+    ArenaArray<int64_t> spilled = make_arena_array<int64_t>(&arena, arena.capacity, "big");
+    ASSERT_TRUE(spilled);
+    EXPECT_FALSE(arena.owns(spilled.get()));
+    EXPECT_EQ(spilled[0], 0);
+
+    ArenaArray<int64_t> fits = make_arena_array<int64_t>(&arena, 100, "fits");
+    EXPECT_TRUE(arena.owns(fits.get()));
+    EXPECT_EQ(fits[99], 0);
+
+    ASSERT_EQ(arena.num_tags, 3u);
+    EXPECT_STREQ(arena.tags[2].name, "fits");
+    EXPECT_EQ(arena.tags[2].bytes, 800u);
+}
+
+/**
+ * @brief ArenaVector draws from the arena and uses the heap without one
+ */
+TEST(ArenaTest, VectorUsesArena) {
+    Arena arena;
+    ASSERT_TRUE(arena.reserve(1 << 20, false));
+
+    ArenaVector<uint32_t> v(ArenaAllocator<uint32_t>(&arena, "vec"));
+    v.reserve(1000);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_TRUE(arena.owns(v.data()));
+
+    // Copies within the reserved capacity do not allocate again
+    ArenaVector<uint32_t> w(ArenaAllocator<uint32_t>(&arena, "vec"));
+    w.reserve(1000);
+    const uint64_t used = arena.used;
+    w = v;
+    EXPECT_EQ(w[999], 999u);
+    EXPECT_EQ(arena.used, used);
+
+    ArenaVector<uint32_t> heap(10, 7u);
+    EXPECT_FALSE(arena.owns(heap.data()));
+}
+
+/**
+ * @brief With an arena every host buffer, including the row columns, lives inside it
+ */
+TEST(ArenaTest, HostContextCarvedFromArena) {
+    EmspConfig config;
+    config.num_rows = 1000;
+    config.writers = 2;
+    config.notify_mode = NotifyMode::WriterRings;
+
+    std::vector<int64_t> ts_ns, px_n, qty;
+    std::vector<uint8_t> side;
+    HostContext ctx;
+    ASSERT_TRUE(ctx.arena.reserve(16u << 20, false));
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+    EXPECT_TRUE(ctx.arena.owns(slot.ts_ns));
+    EXPECT_TRUE(ctx.arena.owns(slot.px_n));
+    EXPECT_TRUE(ctx.arena.owns(slot.qty));
+    EXPECT_TRUE(ctx.arena.owns(slot.side));
+    EXPECT_TRUE(ctx.arena.owns(ctx.seq.base));
+    EXPECT_TRUE(ctx.arena.owns(ctx.dirty.data()));
+    EXPECT_TRUE(ctx.arena.owns(ctx.published.blocks[0]));
+    EXPECT_TRUE(ctx.arena.owns(ctx.q.cells.get()));
+    EXPECT_TRUE(ctx.arena.owns(ctx.writer_rings.get()));
+    EXPECT_TRUE(ctx.arena.owns(ctx.writer_rings[0].buf.get()));
+    EXPECT_EQ(ctx.arena.spilled_count, 0u);
+
+    // The data path works unchanged on arena memory
+    int32_t w = slot.register_writer(&slot);
+    ASSERT_GE(w, 0);
+    slot.begin_row_write(&slot, 5);
+    slot.px_n[5] = 1234;
+    slot.end_row_write(&slot, 5);
+    slot.notify_row_dirty_from(&slot, w, 5);
+    drain_dirty_notifications(ctx);
+    EXPECT_EQ(ctx.dirty[5], 1);
+
+    HostContext::RowSnap snap{};
+    ASSERT_TRUE(row_snapshot(&ctx, &slot, 5, snap));
+    EXPECT_EQ(snap.px, 1234);
+}
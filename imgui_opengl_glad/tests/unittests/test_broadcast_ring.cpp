@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../../core/broadcast_ring.h"
+#include "../../core/data_updater.h"
+
+/**
+ * @brief Every registered consumer sees every published entry, in order
+ */
+TEST(BroadcastRingTest, EachConsumerSeesEveryEntry) {
+    BroadcastRing ring;
+    ring.init(16, BroadcastPolicy::Gated);
+    int32_t a = ring.register_consumer();
+    int32_t b = ring.register_consumer();
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+    ASSERT_NE(a, b);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(ring.publish(i));
+    }
+
+    uint32_t out[32];
+    bool lapped = true;
+    ASSERT_EQ(ring.poll(a, out, 32, lapped), 10u);
+    EXPECT_FALSE(lapped);
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(out[i], i);
+    }
+    EXPECT_EQ(ring.poll(a, out, 32, lapped), 0u);
+
+    // Consumer b is independent of a
+    ASSERT_EQ(ring.poll(b, out, 4, lapped), 4u);
+    EXPECT_EQ(out[3], 3u);
+    ASSERT_EQ(ring.poll(b, out, 32, lapped), 6u);
+    EXPECT_EQ(out[0], 4u);
+    EXPECT_FALSE(lapped);
+}
+
+/**
+ * @brief Gated producers stop one lap ahead of the slowest consumer
+ */
+TEST(BroadcastRingTest, GatedPublishWaitsForSlowestConsumer) {
+    BroadcastRing ring;
+    ring.init(8, BroadcastPolicy::Gated);
+    int32_t fast = ring.register_consumer();
+    int32_t slow = ring.register_consumer();
+
+    uint32_t out[8];
+    bool lapped;
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(ring.publish(i));
+    }
+    EXPECT_EQ(ring.poll(fast, out, 8, lapped), 8u);
+    EXPECT_FALSE(ring.publish(100)) << "slow consumer has not read entry 0 yet";
+
+    EXPECT_EQ(ring.poll(slow, out, 3, lapped), 3u);
+    EXPECT_TRUE(ring.publish(100));
+    EXPECT_TRUE(ring.publish(101));
+    EXPECT_TRUE(ring.publish(102));
+    EXPECT_FALSE(ring.publish(103));
+
+    // Unregistering the slow consumer releases the gate
+    ring.unregister_consumer(slow);
+    EXPECT_EQ(ring.poll(fast, out, 8, lapped), 3u);
+    EXPECT_TRUE(ring.publish(103));
+}
+
+/**
+ * @brief Lossy producers never block; a lapped consumer is told and skips ahead
+ */
+TEST(BroadcastRingTest, LossyReportsLappedConsumer) {
+    BroadcastRing ring;
+    ring.init(8, BroadcastPolicy::Lossy);
+    int32_t c = ring.register_consumer();
+
+    for (uint32_t i = 0; i < 20; ++i) {
+        ASSERT_TRUE(ring.publish(i));
+    }
+
+    uint32_t out[8];
+    bool lapped = false;
+    EXPECT_EQ(ring.poll(c, out, 8, lapped), 0u);
+    EXPECT_TRUE(lapped);
+
+    // After the jump the consumer reads the entries still in the ring
+    uint32_t n = ring.poll(c, out, 8, lapped);
+    EXPECT_FALSE(lapped);
+    ASSERT_GT(n, 0u);
+    EXPECT_EQ(out[n - 1], 19u);
+}
+
+/**
+ * @brief A consumer lapped while it reads never gets a value of a later lap: every id it
+ *        returns is the one published at its position, or the poll reports the lap
+ */
+TEST(BroadcastRingTest, LossyLappedReaderNeverReturnsWrongIds) {
+    BroadcastRing ring;
+    ring.init(8, BroadcastPolicy::Lossy);
+    const int32_t c = ring.register_consumer();
+    constexpr uint32_t kPublishes = 2000000;
+    std::atomic<bool> done{false}, polling{false};
+    std::thread producer([&] {
+        // Performance critical: start handshake, the consumer is polling before the first lap
+        while (!polling.load())
+            std::this_thread::yield();
+        // Performance critical: one producer, so the value published at position p is p
+        for (uint32_t p = 0; p < kPublishes; ++p)
+            ring.publish(p);
+        done.store(true);
+    });
+
+    uint32_t out[4];
+    uint64_t reads = 0, laps = 0;
+    // Performance critical: polls racing the producer until it is done
+    while (!done.load()) {
+        const uint64_t pos = ring.cursors[c].pos.load();
+        bool lapped = false;
+        const uint32_t n = ring.poll(c, out, 4, lapped);
+        // Performance critical: every id read must belong to its position
+        for (uint32_t k = 0; k < n; ++k)
+            ASSERT_EQ(out[k], (uint32_t)(pos + k)) << "value of another lap";
+        reads += n;
+        laps += lapped;
+        polling.store(true);
+    }
+    producer.join();
+    EXPECT_GT(reads + laps, 0u);
+
+    // Deterministic: a producer stopped inside store_cell for position 8, after its mark
+    // and its value but before the final seq, as a consumer still at position 0 sees it
+    BroadcastRing small;
+    small.init(8, BroadcastPolicy::Lossy);
+    const int32_t slow = small.register_consumer();
+    // Performance critical: one lap
+    for (uint32_t p = 0; p < 8; ++p)
+        small.publish(p);
+    small.claim.store(9);
+    small.cells[0].seq.store(8);
+    small.cells[0].value.store(8);
+    bool lapped = false;
+    EXPECT_EQ(small.poll(slow, out, 4, lapped), 0u) << "the id of position 0 is gone";
+    EXPECT_TRUE(lapped);
+}
+
+/**
+ * @brief publish_batch is all or nothing under the gate, every consumer sees the run
+ */
+TEST(BroadcastRingTest, PublishBatch) {
+    BroadcastRing ring;
+    ring.init(8, BroadcastPolicy::Gated);
+    int32_t a = ring.register_consumer();
+    int32_t b = ring.register_consumer();
+
+    const uint32_t v[] = {10, 11, 12, 13, 14, 15};
+    EXPECT_TRUE(ring.publish_batch(v, 6));
+    EXPECT_FALSE(ring.publish_batch(v, 3));
+    EXPECT_TRUE(ring.publish_batch(v, 2));
+
+    uint32_t out[8];
+    bool lapped;
+    EXPECT_EQ(ring.poll(a, out, 8, lapped), 8u);
+    EXPECT_EQ(out[5], 15u);
+    EXPECT_EQ(out[6], 10u);
+    EXPECT_EQ(ring.poll(b, out, 8, lapped), 8u);
+    EXPECT_FALSE(ring.publish_batch(v, 9));
+}
+
+/**
+ * @brief Concurrent producers, two consumers, nothing lost in gated mode
+ */
+TEST(BroadcastRingTest, ConcurrentProducersTwoConsumers) {
+    constexpr uint32_t kPerProducer = 20000;
+    constexpr uint32_t kProducers = 2;
+    BroadcastRing ring;
+    ring.init(1024, BroadcastPolicy::Gated);
+    int32_t ids[2] = {ring.register_consumer(), ring.register_consumer()};
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, p] {
+            for (uint32_t i = 0; i < kPerProducer; ++i) {
+                while (!ring.publish(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<uint8_t>> seen(2, std::vector<uint8_t>(kProducers * kPerProducer, 0));
+    uint64_t total[2] = {0, 0};
+    uint32_t out[256];
+    bool lapped;
+    while (total[0] < kProducers * kPerProducer || total[1] < kProducers * kPerProducer) {
+        for (int c = 0; c < 2; ++c) {
+            uint32_t n = ring.poll(ids[c], out, 256, lapped);
+            ASSERT_FALSE(lapped);
+            for (uint32_t k = 0; k < n; ++k) {
+                seen[c][out[k]]++;
+            }
+            total[c] += n;
+        }
+        std::this_thread::yield();
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    for (int c = 0; c < 2; ++c) {
+        for (uint32_t v = 0; v < kProducers * kPerProducer; ++v) {
+            ASSERT_EQ(seen[c][v], 1) << "consumer " << c << " value " << v;
+        }
+    }
+}
+
+/**
+ * @brief A cursor registered late starts at the claim position; a released one is reused
+ */
+TEST(BroadcastRingTest, RegisterStartsAtClaimAndReusesSlots) {
+    BroadcastRing ring;
+    ring.init(8, BroadcastPolicy::Gated);
+    const int32_t first = ring.register_consumer();
+    ASSERT_EQ(first, 0);
+    ASSERT_TRUE(ring.publish(1));
+    ASSERT_TRUE(ring.publish(2));
+
+    const int32_t late = ring.register_consumer();
+    ASSERT_EQ(late, 1);
+    EXPECT_EQ(ring.cursors[late].pos.load(), 2u);
+    EXPECT_EQ(ring.min_cursor(2), 0u) << "the first consumer still gates";
+
+    ring.unregister_consumer(first);
+    EXPECT_EQ(ring.min_cursor(2), 2u);
+    EXPECT_EQ(ring.register_consumer(), first) << "released slot claimed again";
+    EXPECT_EQ(ring.cursors[first].pos.load(), 2u);
+}
+
+/**
+ * @brief Broadcast notify mode: the primary cursor gets every dirty row
+ */
+TEST(BroadcastRingTest, BroadcastModeFeedsPrimary) {
+    EmspConfig config;
+    config.num_rows = 100;
+    config.notify_mode = NotifyMode::Broadcast;
+
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    ASSERT_GE(ctx.bcast_primary, 0);
+
+    slot.notify_row_dirty(&slot, 3);
+    slot.notify_row_dirty(&slot, 42);
+
+    drain_dirty_notifications(ctx);
+    EXPECT_EQ(ctx.dirty[3], 1);
+    EXPECT_EQ(ctx.dirty[42], 1);
+    EXPECT_EQ(ctx.dirty[4], 0);
+    EXPECT_EQ(ctx.resync_count, 0u);
+}
+
+/**
+ * @brief A gated overflow makes the primary consumer resync
+ */
+TEST(BroadcastRingTest, GatedOverflowResyncsPrimary) {
+    EmspConfig config;
+    config.num_rows = 50;
+    config.notify_mode = NotifyMode::Broadcast;
+
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+    // Fill the ring and one more: the extra notification is dropped
+    for (uint64_t i = 0; i <= ctx.bcast.capacity(); ++i) {
+        slot.notify_row_dirty(&slot, 1);
+    }
+    EXPECT_EQ(ctx.overflow_count.load(), 1u);
+
+    drain_dirty_notifications(ctx);
+    for (uint32_t i = 0; i < config.num_rows; ++i) {
+        ASSERT_EQ(ctx.dirty[i], 1) << "row " << i;
+    }
+    EXPECT_EQ(ctx.resync_count, 1u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../core/change_sink.h"
+
+namespace {
+
+ChangeSet make_changes(uint64_t cycle, uint32_t first_row, uint32_t count) {
+    ChangeSet cs;
+    cs.cycle = cycle;
+    cs.epoch = cycle * 10;
+    // Performance critical: test fixture, a handful of rows
+    for (uint32_t k = 0; k < count; ++k) {
+        const RowSnap before{0, 0, 0, 0};
+        const RowSnap after{1000 + k, -250 - (int64_t)k, 7 * k, (uint8_t)(k & 1)};
+        cs.add(first_row + k, before, after, k ? (uint8_t)RowColPx : (uint8_t)RowColAll);
+    }
+    return cs;
+}
+
+std::vector<char> read_file(const std::string& path) {
+    std::vector<char> data;
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return data;
+    char chunk[4096];
+    size_t n;
+    // Performance critical: test helper, reads the whole file
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+    std::fclose(f);
+    return data;
+}
+
+}  // namespace
+
+/**
+ * @brief Binary output starts with the header, then one set header and one record per row
+ */
+TEST(ChangeSinkTest, BinaryRoundTrip) {
+    const std::string path = testing::TempDir() + "emsp_changes.bin";
+    {
+        auto sink = make_change_sink(SinkKind::Binary, path.c_str(), 1);
+        ASSERT_NE(sink, nullptr);
+        sink->write(make_changes(1, 5, 3));
+        sink->write(ChangeSet{});
+        sink->write(make_changes(2, 40, 1));
+        EXPECT_TRUE(sink->flush());
+        EXPECT_EQ(sink->sets, 2u) << "empty sets are skipped";
+        EXPECT_EQ(sink->rows, 4u);
+    }
+
+    const std::vector<char> data = read_file(path);
+    std::remove(path.c_str());
+    using Header = BinarySink::SetHeader;
+    using Record = BinarySink::Record;
+    ASSERT_EQ(data.size(), 16 + 2 * sizeof(Header) + 4 * sizeof(Record));
+    EXPECT_EQ(std::memcmp(data.data(), "EMSPCHG1", 8), 0);
+    uint32_t sizes[2];
+    std::memcpy(sizes, data.data() + 8, sizeof(sizes));
+    EXPECT_EQ(sizes[0], sizeof(Header));
+    EXPECT_EQ(sizes[1], sizeof(Record));
+
+    const char* p = data.data() + 16;
+    Header h;
+    std::memcpy(&h, p, sizeof(h));
+    EXPECT_EQ(h.cycle, 1u);
+    EXPECT_EQ(h.epoch, 10u);
+    EXPECT_EQ(h.rows, 3u);
+    EXPECT_EQ(h.cols_union, (uint32_t)RowColAll);
+    p += sizeof(h);
+    Record r;
+    std::memcpy(&r, p + sizeof(Record), sizeof(r));
+    EXPECT_EQ(r.row, 6u);
+    EXPECT_EQ(r.cols, RowColPx);
+    EXPECT_EQ(r.side, 1);
+    EXPECT_EQ(r.ts, 1001);
+    EXPECT_EQ(r.px, -251);
+    EXPECT_EQ(r.qty, 7);
+    p += 3 * sizeof(Record);
+    std::memcpy(&h, p, sizeof(h));
+    EXPECT_EQ(h.cycle, 2u);
+    EXPECT_EQ(h.rows, 1u);
+    std::memcpy(&r, p + sizeof(h), sizeof(r));
+    EXPECT_EQ(r.row, 40u);
+    EXPECT_EQ(r.cols, RowColAll);
+}
+
+/**
+ * @brief Text output is one "cycle row ts px qty side cols" line per changed row
+ */
+TEST(ChangeSinkTest, TextLines) {
+    const std::string path = testing::TempDir() + "emsp_changes.txt";
+    {
+        auto sink = make_change_sink(SinkKind::Text, path.c_str(), 0);
+        ASSERT_NE(sink, nullptr);
+        sink->write(make_changes(3, 0, 2));
+    }
+    const std::vector<char> data = read_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(std::string(data.begin(), data.end()),
+              "3 0 1000 -250 0 0 15\n"
+              "3 1 1001 -251 7 1 2\n");
+}
+
+/**
+ * @brief Output smaller than the buffer stays in one write; more spills in buffer-sized ones
+ */
+TEST(ChangeSinkTest, BuffersWrites) {
+    const std::string path = testing::TempDir() + "emsp_changes_big.bin";
+    auto sink = make_change_sink(SinkKind::Binary, path.c_str(), 64u << 10);
+    ASSERT_NE(sink, nullptr);
+    sink->write(make_changes(1, 0, 100));
+    EXPECT_EQ(sink->writes, 0u) << "still buffered";
+    // Performance critical: enough records to fill the 64 KB buffer a few times
+    for (uint64_t c = 2; c < 40; ++c)
+        sink->write(make_changes(c, 0, 100));
+    EXPECT_GT(sink->writes, 0u);
+    EXPECT_LT(sink->writes, sink->bytes / (64u << 10) + 1);
+    EXPECT_TRUE(sink->flush());
+    const uint64_t bytes = sink->bytes;
+    sink.reset();
+    EXPECT_EQ(read_file(path).size(), bytes);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief The null sink counts what the binary sink would write, without a file
+ */
+TEST(ChangeSinkTest, NullSinkCounts) {
+    auto sink = make_change_sink(SinkKind::Null, nullptr, 0);
+    ASSERT_NE(sink, nullptr);
+    sink->write(make_changes(1, 0, 4));
+    sink->write(ChangeSet{});
+    EXPECT_EQ(sink->sets, 1u);
+    EXPECT_EQ(sink->rows, 4u);
+    EXPECT_EQ(sink->bytes, sizeof(BinarySink::SetHeader) + 4 * sizeof(BinarySink::Record));
+    EXPECT_EQ(sink->writes, 0u);
+
+    SinkKind kind;
+    EXPECT_TRUE(parse_sink_kind("binary", kind));
+    EXPECT_EQ(kind, SinkKind::Binary);
+    EXPECT_FALSE(parse_sink_kind("csv", kind));
+    EXPECT_STREQ(sink_kind_name(SinkKind::Text), "text");
+}
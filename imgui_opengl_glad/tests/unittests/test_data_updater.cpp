@@ -3,9 +3,11 @@
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "../../core/data_updater.h"
+#include "../../core/ingest_thread.h"
 
 /**
  * @brief Test fixture for DataUpdater tests using Google Test
@@ -47,7 +49,7 @@ class DataUpdaterTest : public ::testing::Test {
             ctx.seq[i].store(0, std::memory_order_relaxed);
         }
         ctx.dirty.assign(config.num_rows, 0);
-        ctx.last.resize(config.num_rows);
+        ctx.published.init(config.num_rows);
         ctx.q.init(1u << 10);  // Smaller queue for testing
 
         // Initialize HostMDSlot
@@ -61,6 +63,8 @@ class DataUpdaterTest : public ::testing::Test {
         slot.begin_row_write = &host_begin_row_write;
         slot.end_row_write = &host_end_row_write;
         slot.notify_row_dirty = &host_notify_row_dirty;
+        slot.begin_batch = &host_begin_batch;
+        slot.commit_batch = &host_commit_batch;
     }
 };
 
@@ -119,7 +123,7 @@ TEST_F(DataUpdaterTest, ProcessesSnapshotsWhenTimeReached) {
     side[2] = 1;  // Buy side
 
     // Mark row as dirty
-    ctx.dirty[2] = 1;
+    ctx.dirty.mark(2);
 
     // Set up sequence numbers to allow successful snapshot
     ctx.seq[2].store(0, std::memory_order_relaxed);  // Even number = not being written
@@ -131,10 +135,10 @@ TEST_F(DataUpdaterTest, ProcessesSnapshotsWhenTimeReached) {
 
     // Verify that dirty flag was cleared and last snapshot was updated
     EXPECT_EQ(ctx.dirty[2], 0);
-    EXPECT_EQ(ctx.last[2].ts, 123456789);
-    EXPECT_EQ(ctx.last[2].px, 100500);
-    EXPECT_EQ(ctx.last[2].qty, 1000);
-    EXPECT_EQ(ctx.last[2].side, 1);
+    EXPECT_EQ(ctx.published.row(2).ts, 123456789);
+    EXPECT_EQ(ctx.published.row(2).px, 100500);
+    EXPECT_EQ(ctx.published.row(2).qty, 1000);
+    EXPECT_EQ(ctx.published.row(2).side, 1);
 }
 
 /**
@@ -142,7 +146,7 @@ TEST_F(DataUpdaterTest, ProcessesSnapshotsWhenTimeReached) {
  */
 TEST_F(DataUpdaterTest, SkipsProcessingWhenTimeNotReached) {
     // Mark a row as dirty
-    ctx.dirty[1] = 1;
+    ctx.dirty.mark(1);
 
     uint64_t current_time = 100;
     uint64_t next_paint = 200;  // Time hasn't been reached yet
@@ -164,7 +168,7 @@ TEST_F(DataUpdaterTest, HandlesConcurrentWrites) {
     side[4] = 0;  // Sell side
 
     // Mark row as dirty
-    ctx.dirty[4] = 1;
+    ctx.dirty.mark(4);
 
     // Simulate a writer in progress (odd sequence number)
     ctx.seq[4].store(1, std::memory_order_relaxed);
@@ -174,14 +178,14 @@ TEST_F(DataUpdaterTest, HandlesConcurrentWrites) {
 
     update_latest_data_from_context(ctx, config, current_time, next_paint, slot);
 
-    // Verify that dirty flag was cleared even though snapshot failed
-    EXPECT_EQ(ctx.dirty[4], 0);
+    // The snapshot failed, so the row stays dirty for the next paint instead of going stale
+    EXPECT_EQ(ctx.dirty[4], 1);
 
     // Verify that last snapshot wasn't updated (should still be default)
-    EXPECT_EQ(ctx.last[4].ts, 0);
-    EXPECT_EQ(ctx.last[4].px, 0);
-    EXPECT_EQ(ctx.last[4].qty, 0);
-    EXPECT_EQ(ctx.last[4].side, 0);
+    EXPECT_EQ(ctx.published.row(4).ts, 0);
+    EXPECT_EQ(ctx.published.row(4).px, 0);
+    EXPECT_EQ(ctx.published.row(4).qty, 0);
+    EXPECT_EQ(ctx.published.row(4).side, 0);
 }
 
 /**
@@ -221,15 +225,15 @@ TEST_F(DataUpdaterTest, CompleteWorkflow) {
     EXPECT_EQ(ctx.dirty[2], 0);
 
     // Verify snapshots match expected data
-    EXPECT_EQ(ctx.last[0].ts, 1000000);
-    EXPECT_EQ(ctx.last[0].px, 100000);
-    EXPECT_EQ(ctx.last[0].qty, 100);
-    EXPECT_EQ(ctx.last[0].side, 0);
-
-    EXPECT_EQ(ctx.last[1].ts, 1001000);
-    EXPECT_EQ(ctx.last[1].px, 100050);
-    EXPECT_EQ(ctx.last[1].qty, 110);
-    EXPECT_EQ(ctx.last[1].side, 1);
+    EXPECT_EQ(ctx.published.row(0).ts, 1000000);
+    EXPECT_EQ(ctx.published.row(0).px, 100000);
+    EXPECT_EQ(ctx.published.row(0).qty, 100);
+    EXPECT_EQ(ctx.published.row(0).side, 0);
+
+    EXPECT_EQ(ctx.published.row(1).ts, 1001000);
+    EXPECT_EQ(ctx.published.row(1).px, 100050);
+    EXPECT_EQ(ctx.published.row(1).qty, 110);
+    EXPECT_EQ(ctx.published.row(1).side, 1);
 }
 
 /**
@@ -276,3 +280,430 @@ TEST_F(DataUpdaterTest, PerformanceCharacteristics) {
     // Should complete in reasonable time (less than 1ms for this small dataset)
     EXPECT_LT(duration.count(), 1000);
 }
+
+/**
+ * @brief Queue overflow is counted and triggers one full resync sweep
+ */
+TEST_F(DataUpdaterTest, OverflowTriggersFullResync) {
+    // Fixture queue holds 1024 ids; overflow it through the host callback
+    for (uint32_t i = 0; i < 1500; ++i) {
+        slot.notify_row_dirty(&slot, 1);
+    }
+    EXPECT_EQ(ctx.overflow_count.load(), 1500u - 1024u);
+    EXPECT_TRUE(ctx.resync_needed.load());
+
+    // Row 7 was never notified but must still be refreshed by the resync sweep
+    ts_ns[7] = 42;
+    px_n[7] = 4200;
+    qty[7] = 7;
+
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+
+    EXPECT_FALSE(ctx.resync_needed.load());
+    EXPECT_EQ(ctx.resync_count, 1u);
+    for (uint32_t i = 0; i < config.num_rows; ++i) {
+        EXPECT_EQ(ctx.dirty[i], 1) << "row " << i;
+    }
+    uint32_t value;
+    EXPECT_FALSE(ctx.q.pop(value));  // ring was reset
+
+    update_latest_data_from_context(ctx, config, 200, 200, slot);
+    EXPECT_EQ(ctx.published.row(7).px, 4200);
+
+    // Ring is usable again and no further resync happens without overflow
+    slot.notify_row_dirty(&slot, 3);
+    update_latest_data_from_context(ctx, config, 300, 400, slot);
+    EXPECT_EQ(ctx.dirty[3], 1);
+    EXPECT_EQ(ctx.dirty[4], 0);
+    EXPECT_EQ(ctx.resync_count, 1u);
+}
+
+/**
+ * @brief API v2 batch: rows stay odd until commit, then one queue claim carries every id
+ */
+TEST_F(DataUpdaterTest, BatchedWriteCommitsAndNotifies) {
+    const uint32_t ids[] = {2, 5, 2};  // duplicates are allowed
+    slot.begin_batch(&slot, ids, 3);
+    EXPECT_EQ(ctx.seq[2].load() & 1u, 1u);
+    EXPECT_EQ(ctx.seq[5].load() & 1u, 1u);
+
+    HostContext::RowSnap snap{};
+    EXPECT_FALSE(row_snapshot(&ctx, &slot, 5, snap));  // write in progress
+
+    px_n[2] = 200;
+    px_n[5] = 500;
+    slot.commit_batch(&slot, -1, ids, 3);
+    EXPECT_EQ(ctx.seq[2].load() & 1u, 0u);
+    EXPECT_EQ(ctx.seq[5].load() & 1u, 0u);
+    EXPECT_EQ(ctx.q.size_approx(), 3u);
+
+    update_latest_data_from_context(ctx, config, 200, 200, slot);
+    EXPECT_EQ(ctx.published.row(2).px, 200);
+    EXPECT_EQ(ctx.published.row(5).px, 500);
+    EXPECT_EQ(ctx.dirty[3], 0);
+    EXPECT_EQ(ctx.overflow_count.load(), 0u);
+}
+
+/**
+ * @brief A batch that does not fit in the queue is dropped whole and forces a resync
+ */
+TEST_F(DataUpdaterTest, BatchOverflowTriggersResync) {
+    std::vector<uint32_t> ids(1000, 4);
+    slot.begin_batch(&slot, ids.data(), 1000);
+    slot.commit_batch(&slot, -1, ids.data(), 1000);
+    slot.begin_batch(&slot, ids.data(), 100);
+    slot.commit_batch(&slot, -1, ids.data(), 100);  // 1100 > 1024: nothing queued
+
+    EXPECT_EQ(ctx.q.size_approx(), 1000u);
+    EXPECT_EQ(ctx.overflow_count.load(), 1u);
+    EXPECT_EQ(ctx.seq[4].load() & 1u, 0u);  // rows are closed even when the notify fails
+
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+    EXPECT_EQ(ctx.resync_count, 1u);
+}
+
+/**
+ * @brief Writer partitions are disjoint, cover the table and start on 8-row boundaries
+ */
+TEST_F(DataUpdaterTest, WriterRangesPartitionTable) {
+    slot.num_rows = 1001;
+    for (uint32_t writers = 1; writers <= 9; ++writers) {
+        uint32_t next = 0;
+        for (uint32_t w = 0; w < writers; ++w) {
+            uint32_t first = 99, count = 99;
+            ASSERT_EQ(host_writer_range(&slot, w, writers, &first, &count), 0);
+            EXPECT_EQ(first, next) << writers << " writers, writer " << w;
+            EXPECT_EQ(first % 8, 0u);
+            next = first + count;
+        }
+        EXPECT_EQ(next, 1001u) << writers << " writers";
+    }
+
+    // More writers than 8-row lines: the last ones get nothing
+    slot.num_rows = 10;
+    uint32_t first, count;
+    ASSERT_EQ(host_writer_range(&slot, 1, 4, &first, &count), 0);
+    EXPECT_EQ(first, 8u);
+    EXPECT_EQ(count, 2u);
+    ASSERT_EQ(host_writer_range(&slot, 3, 4, &first, &count), 0);
+    EXPECT_EQ(count, 0u);
+    EXPECT_EQ(host_writer_range(&slot, 4, 4, &first, &count), -1);
+}
+
+/**
+ * @brief Every seq layout keeps counters independent, 64-byte aligned and zeroed
+ */
+TEST_F(DataUpdaterTest, SeqLayoutsIsolateRows) {
+    const SeqLayout layouts[] = {SeqLayout::Dense, SeqLayout::Grouped, SeqLayout::Padded};
+    const uint32_t strides[] = {4, 8, 64};
+    for (int m = 0; m < 3; ++m) {
+        SeqArray seq;
+        seq.init(100, layouts[m]);
+        EXPECT_EQ(seq.stride_bytes(), strides[m]);
+        EXPECT_EQ((uintptr_t)&seq[0] % 64, 0u);
+        EXPECT_EQ((uintptr_t)&seq[1] - (uintptr_t)&seq[0], strides[m]);
+        for (uint32_t i = 0; i < 100; ++i) {
+            ASSERT_EQ(seq[i].load(), 0u);
+        }
+        seq[7].store(3);
+        EXPECT_EQ(seq[6].load(), 0u);
+        EXPECT_EQ(seq[8].load(), 0u);
+    }
+
+    // Host callbacks work the same on a padded layout
+    config.seq_layout = SeqLayout::Padded;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    slot.begin_row_write(&slot, 3);
+    EXPECT_EQ(ctx.seq[3].load(), 1u);
+    EXPECT_EQ(ctx.seq[2].load(), 0u);
+    slot.end_row_write(&slot, 3);
+    HostContext::RowSnap snap{};
+    EXPECT_TRUE(row_snapshot(&ctx, &slot, 3, snap));
+}
+
+/**
+ * @brief Row-line storage keeps each row and its seq word in one cache line
+ */
+TEST_F(DataUpdaterTest, RowLinesStorageColocatesSeq) {
+    config.row_storage = RowStorage::Lines;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    ASSERT_NE(slot.row_lines, nullptr);
+    EXPECT_EQ(slot.px_n, nullptr);
+    EXPECT_EQ(ctx.seq.layout, SeqLayout::Colocated);
+    EXPECT_EQ((uintptr_t)slot.row_lines % 64, 0u);
+
+    // Row 3 is the second row of line 1; its seq word and fields share that line
+    uintptr_t line = (uintptr_t)&slot.row_lines[1];
+    EXPECT_EQ((uintptr_t)&ctx.seq[3], (uintptr_t)&slot.row_lines[1].seq[1]);
+    EXPECT_EQ(((uintptr_t)md_px_n(&slot, 3) - line) / 64, 0u);
+    EXPECT_EQ(((uintptr_t)md_side(&slot, 3) - line) / 64, 0u);
+
+    slot.begin_row_write(&slot, 3);
+    EXPECT_EQ(slot.row_lines[1].seq[1], 1u);
+    EXPECT_EQ(slot.row_lines[1].seq[0], 0u);
+    *md_ts_ns(&slot, 3) = 33;
+    *md_px_n(&slot, 3) = 3300;
+    *md_qty(&slot, 3) = 3;
+    *md_side(&slot, 3) = 2;
+    slot.end_row_write(&slot, 3);
+    slot.notify_row_dirty(&slot, 3);
+
+    update_latest_data_from_context(ctx, config, 100, 100, slot);
+    EXPECT_EQ(ctx.published.row(3).ts, 33);
+    EXPECT_EQ(ctx.published.row(3).px, 3300);
+    EXPECT_EQ(ctx.published.row(3).qty, 3);
+    EXPECT_EQ(ctx.published.row(3).side, 2);
+
+    // Columns stay scannable through the accessors
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < config.num_rows; ++i) {
+        sum += *md_px_n(&slot, i);
+    }
+    EXPECT_EQ(sum, 3300);
+}
+
+/**
+ * @brief snapshot_rows matches row_snapshot and reports the rows a writer holds open
+ */
+TEST_F(DataUpdaterTest, SnapshotRowsBatchesAndFlagsTornRows) {
+    const RowStorage storages[] = {RowStorage::Columns, RowStorage::Lines};
+    for (RowStorage storage : storages) {
+        config.row_storage = storage;
+        initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+        // 21 ids: two full groups of eight and a partial one; every row appears twice
+        std::vector<uint32_t> ids;
+        for (uint32_t k = 0; k < 20; ++k) {
+            uint32_t i = (k * 7) % config.num_rows;
+            ids.push_back(i);
+            slot.begin_row_write(&slot, i);
+            *md_px_n(&slot, i) = 100 + i;
+            *md_side(&slot, i) = 1;
+            slot.end_row_write(&slot, i);
+        }
+        ids.push_back(ids[3]);
+
+        const uint32_t torn = ids[9];  // held open for the whole call, listed twice
+        slot.begin_row_write(&slot, torn);
+        std::vector<HostContext::RowSnap> out(ids.size());
+        std::vector<uint8_t> ok(ids.size(), 2);
+        EXPECT_EQ(snapshot_rows(&ctx, &slot, ids.data(), (uint32_t)ids.size(), out.data(),
+                                ok.data()),
+                  (uint32_t)ids.size() - 2);
+        for (size_t k = 0; k < ids.size(); ++k) {
+            if (ids[k] == torn) {
+                EXPECT_EQ(ok[k], 0);
+                continue;
+            }
+            ASSERT_EQ(ok[k], 1) << "k " << k;
+            HostContext::RowSnap single{};
+            ASSERT_TRUE(row_snapshot(&ctx, &slot, ids[k], single));
+            EXPECT_EQ(out[k].ts, single.ts);
+            EXPECT_EQ(out[k].qty, single.qty);
+            EXPECT_EQ(out[k].side, single.side);
+            EXPECT_EQ(out[k].px, 100 + ids[k]);
+        }
+        slot.end_row_write(&slot, torn);
+    }
+
+    // The lanes mask itself: equal and even only
+    const uint32_t before[8] = {0, 2, 3, 4, 6, 8, 10, 12};
+    const uint32_t after[8] = {0, 2, 3, 6, 6, 8, 10, 13};
+    EXPECT_EQ(seq_stable_mask8(before, after), 0x73u);
+}
+
+/**
+ * @brief A row that stays torn is counted and carried over, not dropped
+ */
+TEST_F(DataUpdaterTest, TornRowIsDeferredNotLost) {
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    slot.begin_row_write(&slot, 4);  // writer holds the row open across the paint
+    px_n[4] = 4400;
+    slot.notify_row_dirty(&slot, 4);
+    slot.begin_row_write(&slot, 6);
+    px_n[6] = 6600;
+    slot.end_row_write(&slot, 6);
+    slot.notify_row_dirty(&slot, 6);
+
+    update_latest_data_from_context(ctx, config, 100, 100, slot);
+    EXPECT_EQ(ctx.published.row(6).px, 6600);
+    EXPECT_EQ(ctx.published.row(4).px, 0);
+    EXPECT_EQ(ctx.dirty[4], 1) << "failed row is re-queued";
+    EXPECT_EQ(ctx.snap_stats.rows, 2u);
+    EXPECT_EQ(ctx.snap_stats.torn, 1u);
+    EXPECT_EQ(ctx.snap_stats.retries, (uint64_t)kSnapshotRetries);
+    EXPECT_EQ(ctx.snap_stats.failures, 1u);
+    EXPECT_EQ(ctx.snap_stats.last_deferred, 1u);
+    EXPECT_EQ(ctx.row_torn[4], 1u);
+    EXPECT_EQ(ctx.row_torn[6], 0u);
+
+    // No new notification: the carried-over flag alone brings the row up to date
+    slot.end_row_write(&slot, 4);
+    update_latest_data_from_context(ctx, config, 200, 200, slot);
+    EXPECT_EQ(ctx.published.row(4).px, 4400);
+    EXPECT_EQ(ctx.dirty[4], 0);
+    EXPECT_EQ(ctx.snap_stats.last_deferred, 0u);
+    EXPECT_EQ(ctx.snap_stats.deferred, 1u);
+    EXPECT_EQ(ctx.snap_stats.failures, 1u);
+}
+
+/**
+ * @brief Changed rows report exactly the columns that moved; unchanged rows are not reported
+ */
+TEST_F(DataUpdaterTest, RefreshReportsChangedColumns) {
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    ts_ns[1] = 10;  // heartbeat
+    px_n[2] = 20;
+    qty[2] = 30;
+    side[3] = 2;
+    for (uint32_t i = 0; i < 5; ++i)
+        ctx.dirty.mark(i);
+
+    uint8_t seen[5] = {0, 0, 0, 0, 0};
+    uint32_t calls = 0;
+    uint32_t changed = refresh_dirty_rows(ctx, slot, ctx.dirty,
+                                          [&](uint32_t row, const RowSnap&, uint8_t cols) {
+                                              seen[row] = cols;
+                                              ++calls;
+                                          });
+    EXPECT_EQ(changed, 3u);
+    EXPECT_EQ(calls, 3u);
+    EXPECT_EQ(seen[0], 0);
+    EXPECT_EQ(seen[1], RowColTs);
+    EXPECT_EQ(seen[2], RowColPx | RowColQty);
+    EXPECT_EQ(seen[3], RowColSide);
+
+    // Two-argument callbacks keep working
+    ts_ns[1] = 11;
+    ctx.dirty.mark(1);
+    uint32_t rows = 0;
+    refresh_dirty_rows(ctx, slot, ctx.dirty, [&](uint32_t, const RowSnap&) { ++rows; });
+    EXPECT_EQ(rows, 1u);
+}
+
+/**
+ * @brief One ingest cycle drains once and hands the same change set to every listener
+ */
+TEST_F(DataUpdaterTest, IngestCycleDeliversOneChangeSet) {
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    px_n[2] = 200;
+    slot.notify_row_dirty(&slot, 2);
+    update_latest_data_from_context(ctx, config, 100, 100, slot);
+
+    std::vector<const ChangeSet*> got_a, got_b;
+    std::vector<uint32_t> rows_a;
+    int32_t a = ctx.changes.subscribe([&](const ChangeSet& set) {
+        got_a.push_back(&set);
+        rows_a.assign(set.ids.begin(), set.ids.end());
+    });
+    int32_t b = ctx.changes.subscribe([&](const ChangeSet& set) { got_b.push_back(&set); });
+
+    px_n[2] = 250;
+    ts_ns[7] = 70;
+    slot.notify_row_dirty(&slot, 2);
+    slot.notify_row_dirty(&slot, 7);
+    slot.notify_row_dirty(&slot, 2);
+    update_latest_data_from_context(ctx, config, 150, 200, slot);  // drains only
+    EXPECT_TRUE(got_a.empty());
+    update_latest_data_from_context(ctx, config, 200, 200, slot);
+
+    ASSERT_EQ(got_a.size(), 1u);
+    ASSERT_EQ(got_b.size(), 1u);
+    EXPECT_EQ(got_a[0], got_b[0]) << "one shared, immutable change set";
+    const ChangeSet& set = ctx.changes.current;
+    EXPECT_EQ(set.cycle, 2u);
+    ASSERT_EQ(set.size(), 2u);
+    EXPECT_EQ(rows_a, (std::vector<uint32_t>{2, 7}));
+    EXPECT_EQ(set.before[0].px, 200);
+    EXPECT_EQ(set.after[0].px, 250);
+    EXPECT_EQ(set.cols[0], RowColPx);
+    EXPECT_EQ(set.cols[1], RowColTs);
+    EXPECT_EQ(set.cols_union, RowColPx | RowColTs);
+    EXPECT_EQ(set.epoch, ctx.published.epoch.load());
+
+    // A quiet cycle still delivers (empty), an unsubscribed listener is skipped
+    ctx.changes.unsubscribe(a);
+    update_latest_data_from_context(ctx, config, 300, 300, slot);
+    EXPECT_EQ(got_a.size(), 1u);
+    ASSERT_EQ(got_b.size(), 2u);
+    EXPECT_TRUE(ctx.changes.current.empty());
+    ctx.changes.unsubscribe(b);
+}
+
+/**
+ * @brief Under a concurrent writer the displayed values converge to the final writes
+ */
+TEST_F(DataUpdaterTest, RefreshConvergesUnderContention) {
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int64_t n = 1; n <= 200000; ++n) {
+            uint32_t i = (uint32_t)(n % config.num_rows);
+            slot.begin_row_write(&slot, i);
+            px_n[i] = n;
+            qty[i] = n;
+            slot.end_row_write(&slot, i);
+            slot.notify_row_dirty(&slot, i);
+        }
+        done = true;
+    });
+    uint64_t t = 0;
+    while (!done) {
+        update_latest_data_from_context(ctx, config, t, t, slot);
+        ++t;
+    }
+    writer.join();
+
+    // Every pending row is either notified or carried over, so one quiet paint settles it
+    update_latest_data_from_context(ctx, config, t, t, slot);
+    for (uint32_t i = 0; i < config.num_rows; ++i) {
+        EXPECT_EQ(ctx.published.row(i).px, px_n[i]) << "row " << i;
+        EXPECT_EQ(ctx.published.row(i).px, ctx.published.row(i).qty) << "row " << i << " torn";
+    }
+    EXPECT_EQ(ctx.snap_stats.last_deferred, 0u);
+    EXPECT_EQ(ctx.snap_stats.failures, ctx.snap_stats.deferred);
+}
+
+/**
+ * @brief The ingest thread keeps cycling on its own and its listeners see every change
+ */
+TEST_F(DataUpdaterTest, IngestThreadPublishesWithoutCaller) {
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    std::atomic<uint64_t> delivered{0}, sets{0};
+    int32_t sub = ctx.changes.subscribe([&](const ChangeSet& set) {
+        delivered += set.size();
+        ++sets;
+    });
+
+    IngestThread ingest;
+    ingest.start(ctx, slot, 200);
+    EXPECT_TRUE(ingest.running());
+    for (uint32_t i = 0; i < config.num_rows; ++i) {
+        slot.begin_row_write(&slot, i);
+        px_n[i] = 100 + i;
+        slot.end_row_write(&slot, i);
+        slot.notify_row_dirty(&slot, i);
+    }
+
+    // Nobody calls the ingest stage here: the thread picks the rows up by itself
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (delivered.load() < config.num_rows && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ingest.stop();
+    EXPECT_FALSE(ingest.running());
+
+    EXPECT_EQ(delivered.load(), (uint64_t)config.num_rows);
+    EXPECT_GT(ingest.cycles.load(), 0u);
+    EXPECT_EQ(ingest.cycles.load(), sets.load()) << "one change set per cycle";
+    EXPECT_EQ(ingest.rows.load(), (uint64_t)config.num_rows);
+    // Performance critical: checks every row once the thread has stopped
+    for (uint32_t i = 0; i < config.num_rows; ++i)
+        EXPECT_EQ(ctx.published.px(i), 100 + (int64_t)i) << "row " << i;
+
+    // Stopped means stopped: later notifications wait for the next start
+    const uint64_t cycles = ingest.cycles.load();
+    slot.notify_row_dirty(&slot, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(ingest.cycles.load(), cycles);
+    ctx.changes.unsubscribe(sub);
+}
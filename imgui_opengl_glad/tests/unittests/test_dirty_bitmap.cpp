@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../core/data_updater.h"
+#include "../../core/dirty_bitmap.h"
+
+/**
+ * @brief Repeated marks of the same row coalesce into a single drained id
+ */
+TEST(AtomicDirtyBitmapTest, CoalescesRepeatedMarks) {
+    AtomicDirtyBitmap bits;
+    bits.init(1000);
+
+    for (int i = 0; i < 50; ++i) {
+        bits.mark(7);
+    }
+    bits.mark(63);
+    bits.mark(64);
+    bits.mark(999);
+
+    std::vector<uint32_t> seen;
+    EXPECT_EQ(bits.drain([&](uint32_t id) { seen.push_back(id); }), 4u);
+    ASSERT_EQ(seen.size(), 4u);
+    EXPECT_EQ(seen[0], 7u);
+    EXPECT_EQ(seen[1], 63u);
+    EXPECT_EQ(seen[2], 64u);
+    EXPECT_EQ(seen[3], 999u);
+
+    // Drain clears the bits
+    EXPECT_EQ(bits.drain([](uint32_t) {}), 0u);
+}
+
+/**
+ * @brief Concurrent producers never lose a row
+ */
+TEST(AtomicDirtyBitmapTest, ConcurrentMarksAllVisible) {
+    constexpr uint32_t kRows = 4096;
+    AtomicDirtyBitmap bits;
+    bits.init(kRows);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&bits, p] {
+            for (uint32_t i = p; i < kRows; i += 4) {
+                bits.mark(i);
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    std::vector<uint8_t> seen(kRows, 0);
+    EXPECT_EQ(bits.drain([&](uint32_t id) { seen[id]++; }), kRows);
+    for (uint32_t i = 0; i < kRows; ++i) {
+        EXPECT_EQ(seen[i], 1) << "row " << i;
+    }
+}
+
+/**
+ * @brief Bitmap notify mode feeds the data updater like the queue does
+ */
+TEST(AtomicDirtyBitmapTest, BitmapModeMarksRowsDirty) {
+    EmspConfig config;
+    config.num_rows = 200;
+    config.notify_mode = NotifyMode::Bitmap;
+
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+    slot.notify_row_dirty(&slot, 5);
+    slot.notify_row_dirty(&slot, 5);
+    slot.notify_row_dirty(&slot, 150);
+
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+
+    EXPECT_EQ(ctx.dirty[5], 1);
+    EXPECT_EQ(ctx.dirty[150], 1);
+    EXPECT_EQ(ctx.dirty[6], 0);
+}
+
+/**
+ * @brief DirtyFlags visits only the listed rows, once each, and re-marks go to the next pass
+ */
+TEST(DirtyFlagsTest, ConsumeVisitsListedRowsOnce) {
+    DirtyFlags dirty(10000, 0, ArenaAllocator<uint8_t>(nullptr));
+    dirty.mark(42);
+    dirty.mark(7);
+    dirty.mark(42);
+    EXPECT_EQ(dirty.list.size(), 2u);
+    EXPECT_FALSE(dirty.scan_all);
+
+    std::vector<uint32_t> seen;
+    dirty.consume([&](uint32_t i) {
+        seen.push_back(i);
+        if (i == 7)
+            dirty.mark(7);  // deferred to the next consume
+    });
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], 42u);
+    EXPECT_EQ(seen[1], 7u);
+    EXPECT_EQ(dirty[42], 0);
+    EXPECT_EQ(dirty[7], 1);
+
+    seen.clear();
+    dirty.consume([&](uint32_t i) { seen.push_back(i); });
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0], 7u);
+    EXPECT_TRUE(dirty.list.empty());
+}
+
+/**
+ * @brief Past the list capacity (or after mark_all) consume falls back to a full scan
+ */
+TEST(DirtyFlagsTest, DenseMarksFallBackToScan) {
+    DirtyFlags dirty(1024, 0, ArenaAllocator<uint8_t>(nullptr));
+    const size_t cap = dirty.list_capacity();
+    for (uint32_t i = 0; i <= cap; ++i)
+        dirty.mark(i * 3 % 1024);
+    EXPECT_TRUE(dirty.scan_all);
+
+    uint32_t visits = 0, last = 0;
+    bool ascending = true;
+    dirty.consume([&](uint32_t i) {
+        ascending &= visits == 0 || i > last;
+        last = i;
+        ++visits;
+    });
+    EXPECT_EQ(visits, cap + 1);
+    EXPECT_TRUE(ascending) << "scan order";
+    EXPECT_FALSE(dirty.scan_all);
+
+    dirty.mark_all();
+    visits = 0;
+    dirty.consume([&](uint32_t) { ++visits; });
+    EXPECT_EQ(visits, 1024u);
+
+    dirty.mark(5);
+    dirty.clear();
+    visits = 0;
+    dirty.consume([&](uint32_t) { ++visits; });
+    EXPECT_EQ(visits, 0u);
+}
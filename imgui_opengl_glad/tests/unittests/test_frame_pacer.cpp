@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "../../core/frame_pacer.h"
+
+namespace {
+
+int g_wakes = 0;
+
+void count_wake() {
+    ++g_wakes;
+}
+
+void start_pacer(FramePacer& pacer) {
+    g_wakes = 0;
+    pacer.latency_us = 16000;
+    pacer.idle_us = 500000;
+    pacer.input_frames = 3;
+    pacer.wake = count_wake;
+    pacer.begin_frame(FramePacer::Idle, 1000000);  // first frame, nothing pending
+    pacer.end_frame(1005000);
+}
+
+}  // namespace
+
+/**
+ * @brief With nothing happening the render thread sleeps until the idle repaint
+ */
+TEST(FramePacerTest, SleepsWhenIdle) {
+    FramePacer pacer;
+    start_pacer(pacer);
+    EXPECT_EQ(pacer.next_paint(1010000), FramePacer::None);
+    EXPECT_EQ(pacer.wait_us(1010000), 490000);
+    EXPECT_EQ(pacer.next_paint(1500000), FramePacer::Idle);
+    EXPECT_EQ(pacer.wait_us(1600000), 0);
+    EXPECT_EQ(g_wakes, 0);
+}
+
+/**
+ * @brief Data after a quiet spell is painted at once; a steady stream once per latency target
+ */
+TEST(FramePacerTest, DataWithinLatencyTarget) {
+    FramePacer pacer;
+    start_pacer(pacer);
+    pacer.notify_data(1200000);
+    pacer.notify_data(1200100);
+    EXPECT_EQ(g_wakes, 1) << "one wake-up per painted frame";
+    EXPECT_EQ(pacer.next_paint(1200200), FramePacer::Data);
+    pacer.begin_frame(FramePacer::Data, 1200200);
+    pacer.end_frame(1203000);
+    EXPECT_EQ(pacer.stats.data_frames, 1u);
+    EXPECT_EQ(pacer.stats.latency_max_us, 3000u);
+
+    // Right after a paint new data waits out the rest of the latency target
+    pacer.notify_data(1204000);
+    EXPECT_EQ(g_wakes, 2);
+    EXPECT_EQ(pacer.next_paint(1204000), FramePacer::None);
+    EXPECT_EQ(pacer.wait_us(1204000), 12200);
+    EXPECT_EQ(pacer.next_paint(1216200), FramePacer::Data);
+}
+
+/**
+ * @brief Data arriving while a frame is drawn stays pending and wakes the loop again
+ */
+TEST(FramePacerTest, DataDuringFrameNotLost) {
+    FramePacer pacer;
+    start_pacer(pacer);
+    pacer.notify_data(1100000);
+    pacer.begin_frame(FramePacer::Data, 1100000);
+    pacer.notify_data(1101000);  // after the views were read
+    pacer.end_frame(1102000);
+    EXPECT_EQ(g_wakes, 2);
+    EXPECT_TRUE(pacer.data_pending());
+    EXPECT_EQ(pacer.next_paint(1116000), FramePacer::Data);
+    pacer.begin_frame(FramePacer::Data, 1116000);
+    pacer.end_frame(1117000);
+    EXPECT_FALSE(pacer.data_pending());
+    EXPECT_EQ(pacer.stats.latency_max_us, 16000u);
+}
+
+/**
+ * @brief Input paints right away and for input_frames frames in a row
+ */
+TEST(FramePacerTest, InputPaintsImmediately) {
+    FramePacer pacer;
+    start_pacer(pacer);
+    pacer.note_input();
+    // Performance critical: three frames
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_EQ(pacer.wait_us(1006000), 0);
+        EXPECT_EQ(pacer.next_paint(1006000), FramePacer::Input);
+        pacer.begin_frame(FramePacer::Input, 1006000);
+    }
+    EXPECT_EQ(pacer.next_paint(1007000), FramePacer::None);
+    EXPECT_EQ(pacer.stats.frames[FramePacer::Input], 3u);
+    EXPECT_EQ(pacer.stats.data_frames, 0u);
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../core/incremental_sort.h"
+#include "../../core/work_budget.h"
+
+/**
+ * @brief A spent budget refuses further work, but never the first piece of a slice
+ */
+TEST(WorkBudgetTest, FirstSpendAlwaysGoesAhead) {
+    WorkBudget spent(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    EXPECT_TRUE(spent.spend(100000)) << "a slice always makes progress";
+    EXPECT_FALSE(spent.spend(WorkBudget::kCheckUnits));
+    EXPECT_FALSE(spent.spend(1)) << "stays expired";
+
+    WorkBudget unlimited(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    // Performance critical: enough units for several clock checks
+    for (int k = 0; k < 10; ++k)
+        EXPECT_TRUE(unlimited.spend(WorkBudget::kCheckUnits));
+}
+
+/**
+ * @brief Sorting in tiny slices gives the same order as one std::sort, at every size
+ */
+TEST(IncrementalSortTest, SlicedSortMatchesStdSort) {
+    std::mt19937 rng(7);
+    const size_t run = IncrementalSort<uint32_t>::kRun;
+    // 0, 1, one run, a pass with an odd tail, even and odd pass counts (copy back or not)
+    const size_t sizes[] = {0, 1, run, run + 3, 2 * run, 3 * run + 17, 4 * run, 9 * run + 1};
+    IncrementalSort<uint32_t> sorter;
+    // Performance critical: a handful of sizes
+    for (size_t n : sizes) {
+        std::vector<uint32_t> data(n);
+        // Performance critical: test input
+        for (uint32_t& v : data)
+            v = rng() % 1000;  // many equal keys
+        std::vector<uint32_t> expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        sorter.start(n);
+        int slices = 0;
+        // Performance critical: at least one merge chunk per slice
+        while (true) {
+            WorkBudget budget(1);
+            ++slices;
+            if (sorter.step(data.data(), std::less<uint32_t>(), budget))
+                break;
+            ASSERT_LT(slices, 100000);
+        }
+        EXPECT_TRUE(sorter.done());
+        EXPECT_EQ(sorter.permille(), 1000u) << "n=" << n;
+        EXPECT_EQ(data, expected) << "n=" << n;
+        if (n > 2 * run) {
+            EXPECT_GT(slices, 1) << "n=" << n;
+        }
+    }
+}
+
+/**
+ * @brief Keys moving between slices (live rows) leave a permutation in which every row whose
+ *        key did not move is in order, and progress only grows
+ */
+TEST(IncrementalSortTest, KeysMovingMidSortKeepAllRows) {
+    using Sorter = IncrementalSort<uint32_t, int64_t>;
+    const size_t n = 6 * Sorter::kRun + 5;
+    std::mt19937 rng(11);
+    std::vector<int64_t> key(n);
+    std::vector<uint32_t> rows(n);
+    // Performance critical: test input
+    for (size_t i = 0; i < n; ++i) {
+        key[i] = rng() % 100000;
+        rows[i] = (uint32_t)i;
+    }
+    auto key_of = [&key](uint32_t row) { return key[row]; };
+    std::vector<uint8_t> moved(n, 0);
+
+    Sorter sorter;
+    sorter.start(n);
+    uint32_t last = 0;
+    int slices = 0;
+    // Performance critical: slices until done, values moving in between
+    while (true) {
+        WorkBudget budget(1);
+        const bool done = sorter.step(rows.data(), key_of, std::less<int64_t>(), budget);
+        EXPECT_GE(sorter.permille(), last);
+        last = sorter.permille();
+        if (done)
+            break;
+        ++slices;
+        // Performance critical: a few hundred updates per slice
+        for (int k = 0; k < 300; ++k) {
+            const uint32_t row = rng() % n;
+            key[row] = rng() % 100000;
+            moved[row] = 1;
+        }
+    }
+    EXPECT_GT(slices, 1);
+
+    std::vector<uint32_t> sorted_rows = rows;
+    std::sort(sorted_rows.begin(), sorted_rows.end());
+    // Performance critical: checks every row
+    for (size_t i = 0; i < n; ++i)
+        ASSERT_EQ(sorted_rows[i], i) << "every row exactly once";
+
+    // Merges compare captured keys only, so the rows that kept theirs are in order
+    std::vector<int64_t> kept;
+    // Performance critical: checks every row
+    for (uint32_t row : rows) {
+        if (!moved[row])
+            kept.push_back(key[row]);
+    }
+    EXPECT_TRUE(std::is_sorted(kept.begin(), kept.end()));
+
+    // Without moving keys the same sorter gives the exact order
+    sorter.start(n);
+    WorkBudget unlimited(0);
+    EXPECT_TRUE(sorter.step(rows.data(), key_of, std::less<int64_t>(), unlimited));
+    EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end(),
+                               [&key](uint32_t a, uint32_t b) { return key[a] < key[b]; }));
+}
+
+/**
+ * @brief Merging changed rows back in restores the full order and keeps every row, for no,
+ *        few, or all rows changed, on tiny and larger arrays with many equal keys
+ */
+TEST(IncrementalSortTest, ReinsertChangedRestoresOrder) {
+    std::mt19937 rng(23);
+    const size_t sizes[] = {1, 2, 5, 64, 1000};
+    // Performance critical: a handful of sizes
+    for (size_t n : sizes) {
+        const size_t counts[] = {0, 1, n / 10 + 1, n / 2, n};
+        // Performance critical: a handful of change counts per size
+        for (size_t k : counts) {
+            std::vector<int64_t> key(n);
+            std::vector<uint32_t> rows(n);
+            // Performance critical: test input
+            for (size_t i = 0; i < n; ++i) {
+                key[i] = rng() % 50;  // many equal keys
+                rows[i] = (uint32_t)i;
+            }
+            auto by_key = [&key](uint32_t a, uint32_t b) { return key[a] < key[b]; };
+            std::sort(rows.begin(), rows.end(), by_key);
+
+            std::vector<uint32_t> changed(n);
+            // Performance critical: test input
+            for (size_t i = 0; i < n; ++i)
+                changed[i] = (uint32_t)i;
+            std::shuffle(changed.begin(), changed.end(), rng);
+            changed.resize(k);
+            std::vector<uint8_t> mark(n, 0);
+            // Performance critical: test input
+            for (uint32_t row : changed) {
+                key[row] = rng() % 50;
+                mark[row] = 1;
+            }
+
+            reinsert_changed(rows.data(), n, changed.data(), k, mark.data(), by_key);
+            EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end(), by_key))
+                << "n=" << n << " k=" << k;
+            EXPECT_TRUE(std::all_of(mark.begin(), mark.end(), [](uint8_t m) { return !m; }))
+                << "marks cleared";
+            std::vector<uint32_t> all = rows;
+            std::sort(all.begin(), all.end());
+            // Performance critical: permutation check
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_EQ(all[i], (uint32_t)i) << "n=" << n << " k=" << k;
+        }
+    }
+}
+
+/**
+ * @brief The table's live order: a sliced sort with keys moving between slices, then the
+ *        rows changed since the sort started merged back in, gives the exact order
+ */
+TEST(IncrementalSortTest, SlicedSortThenReinsertIsFullySorted) {
+    using Sorter = IncrementalSort<uint32_t, int64_t>;
+    const size_t n = 20000;
+    std::mt19937 rng(29);
+    std::vector<int64_t> key(n);
+    std::vector<uint32_t> rows(n);
+    // Performance critical: test input
+    for (size_t i = 0; i < n; ++i) {
+        key[i] = rng() % 1000000;
+        rows[i] = (uint32_t)i;
+    }
+    auto key_of = [&key](uint32_t row) { return key[row]; };
+    auto by_key = [&key](uint32_t a, uint32_t b) { return key[a] < key[b]; };
+    std::vector<uint8_t> mark(n, 0);
+    std::vector<uint32_t> changed;
+
+    Sorter sorter;
+    sorter.start(n);
+    int slices = 0;
+    // Performance critical: slices until done, a few keys moving in between
+    while (true) {
+        WorkBudget budget(1);
+        if (sorter.step(rows.data(), key_of, std::less<int64_t>(), budget))
+            break;
+        ++slices;
+        // Performance critical: five updates per slice
+        for (int k = 0; k < 5; ++k) {
+            const uint32_t row = rng() % n;
+            key[row] = rng() % 1000000;
+            if (!mark[row]) {
+                mark[row] = 1;
+                changed.push_back(row);
+            }
+        }
+    }
+    EXPECT_GT(slices, 1);
+    ASSERT_FALSE(changed.empty());
+
+    reinsert_changed(rows.data(), n, changed.data(), changed.size(), mark.data(), by_key);
+    size_t inversions = 0;
+    // Performance critical: checks every adjacent pair
+    for (size_t i = 1; i < n; ++i)
+        inversions += by_key(rows[i], rows[i - 1]) ? 1 : 0;
+    EXPECT_EQ(inversions, 0u);
+}
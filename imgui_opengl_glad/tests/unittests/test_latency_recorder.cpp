@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../core/latency_recorder.h"
+
+/**
+ * @brief Buckets tile the value range in order, each value within 1/64 of its bucket
+ */
+TEST(LatencyHistogramTest, BucketsAreContiguousAndPrecise) {
+    // Performance critical: every bucket once
+    for (uint32_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+        ASSERT_EQ(LatencyHistogram::bucket_of(LatencyHistogram::bucket_low(b)), b);
+        if (b + 1 < LatencyHistogram::kBuckets) {
+            ASSERT_EQ(LatencyHistogram::bucket_of(LatencyHistogram::bucket_low(b + 1) - 1), b);
+        }
+    }
+
+    std::mt19937_64 rng(3);
+    // Performance critical: random values over the whole range
+    for (int k = 0; k < 100000; ++k) {
+        const uint64_t v = rng() >> (rng() % 40 + 24);  // 1 ns to about 1000 s
+        const uint64_t low = LatencyHistogram::bucket_low(LatencyHistogram::bucket_of(v));
+        ASSERT_LE(low, v);
+        if (v < (1ull << 36)) {
+            ASSERT_LE((v - low) * 64, v) << v;
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::bucket_of(~0ull), LatencyHistogram::kBuckets - 1);
+}
+
+/**
+ * @brief Percentiles of a known distribution come out to bucket precision, max exactly
+ */
+TEST(LatencyRecorderTest, PercentilesOfUniformAges) {
+    LatencyRecorder rec;
+    const int64_t now = 50000000000;
+    // Performance critical: ages of 1 to 10000 us
+    for (int64_t us = 1; us <= 10000; ++us)
+        rec.record(TickStage::Snapshot, now - us * 1000, now);
+    rec.record(TickStage::Snapshot, 0, now);  // unstamped row: skipped
+
+    const LatencySummary s = rec.summary(TickStage::Snapshot);
+    EXPECT_EQ(s.count, 10000u);
+    EXPECT_EQ(s.max, 10000000u);
+    EXPECT_NEAR((double)s.p50, 5000000.0, 5000000.0 / 64);
+    EXPECT_NEAR((double)s.p99, 9900000.0, 9900000.0 / 64);
+    EXPECT_NEAR((double)s.p999, 9990000.0, 9990000.0 / 64);
+    EXPECT_LE(s.p999, s.max);
+    EXPECT_EQ(rec.summary(TickStage::Pixel).count, 0u);
+
+    rec.enabled.store(false);
+    rec.record(TickStage::Snapshot, now - 1000, now);
+    EXPECT_EQ(rec.summary(TickStage::Snapshot).count, 10000u) << "off records nothing";
+}
+
+/**
+ * @brief Every thread records into its own histograms; readers see the sum of all of them
+ */
+TEST(LatencyRecorderTest, MergesPerThreadHistograms) {
+    LatencyRecorder rec;
+    std::vector<std::thread> threads;
+    // Performance critical: four writer threads
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&rec, t] {
+            // Performance critical: 1000 samples per thread, ages 1..4 us by thread
+            for (int k = 0; k < 1000; ++k)
+                rec.record(TickStage::Notify, 1000000, 1000000 + (t + 1) * 1000, 1);
+        });
+    }
+    // Performance critical: joins the writers
+    for (std::thread& th : threads)
+        th.join();
+
+    EXPECT_EQ(rec.used.load(), 4u);
+    const LatencySummary s = rec.summary(TickStage::Notify);
+    EXPECT_EQ(s.count, 4000u);
+    EXPECT_EQ(s.max, 4000u);
+    EXPECT_LE(s.p50, 2000u + 2000u / 64);
+
+    // A recorder at the same address is a new one: no thread reuses the old sets
+    rec.~LatencyRecorder();
+    new (&rec) LatencyRecorder();  // required: placement, to recreate at the same address
+    rec.record(TickStage::Notify, 1000, 2000);
+    EXPECT_EQ(rec.used.load(), 1u);
+    EXPECT_EQ(rec.summary(TickStage::Notify).count, 1u);
+}
+
+/**
+ * @brief Subtracting a baseline resets the figures while the threads keep recording
+ */
+TEST(LatencyRecorderTest, BaselineSubtractResets) {
+    LatencyRecorder rec;
+    // Performance critical: slow samples before the reset
+    for (int k = 0; k < 100; ++k)
+        rec.record(TickStage::View, 1, 1 + 5000000);
+    auto base = std::make_unique<LatencySnapshot>();
+    rec.merge(TickStage::View, *base);
+
+    // Performance critical: fast samples after it
+    for (int k = 0; k < 300; ++k)
+        rec.record(TickStage::View, 1, 1 + 20000);
+    auto now = std::make_unique<LatencySnapshot>();
+    rec.merge(TickStage::View, *now);
+    now->subtract(*base);
+    const LatencySummary s = summarize(*now);
+    EXPECT_EQ(s.count, 300u);
+    EXPECT_NEAR((double)s.max, 20000.0, 20000.0 / 64) << "the old max is gone too";
+    EXPECT_NEAR((double)s.p99, 20000.0, 20000.0 / 64);
+
+    now->subtract(*now);
+    EXPECT_EQ(summarize(*now).count, 0u);
+    EXPECT_EQ(summarize(*now).max, 0u);
+    EXPECT_EQ(now->percentile(0.5), 0u);
+}
+
+/**
+ * @brief The report has the summary table and a distribution for each stage with samples
+ */
+TEST(LatencyRecorderTest, ReportListsStagesWithSamples) {
+    LatencyRecorder rec;
+    rec.record(TickStage::Notify, 1000, 3000);
+    rec.record(TickStage::Pixel, 1000, 9000000);
+
+    FILE* f = std::tmpfile();
+    ASSERT_NE(f, nullptr);
+    rec.write_report(f);
+    std::rewind(f);
+    std::string text;
+    char buf[4096];
+    size_t got;
+    // Performance critical: reads back the report
+    while ((got = std::fread(buf, 1, sizeof(buf), f)) > 0)
+        text.append(buf, got);
+    std::fclose(f);
+
+    EXPECT_NE(text.find("p99.9"), std::string::npos);
+    EXPECT_NE(text.find("delivered"), std::string::npos) << "every stage in the summary";
+    EXPECT_NE(text.find("# stage notify"), std::string::npos);
+    EXPECT_NE(text.find("# stage pixel"), std::string::npos);
+    EXPECT_EQ(text.find("# stage view"), std::string::npos) << "no samples, no distribution";
+    EXPECT_NE(text.find("1/(1-Percentile)"), std::string::npos);
+}
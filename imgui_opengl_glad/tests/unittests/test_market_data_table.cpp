@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../core/data_updater.h"
+#include "../../ui/MarketDataTable.h"
+
+namespace {
+
+// One ingest cycle, then the render thread's side: take the view so the next cycle may
+// work on the table again
+const TableView& cycle(HostContext& ctx, const HostMDSlot& slot, MarketDataTable& table) {
+    run_ingest_cycle(ctx, slot);
+    return table.LatestView();
+}
+
+ViewWork stage_of(const MarketDataTable& table) {
+    return (ViewWork)(table.WorkState() >> 16);
+}
+
+}  // namespace
+
+/**
+ * @brief Sort keys ticking while a budgeted filter pass runs over several cycles: rows
+ *        moving past the pass's cursor must not make it skip others, so the view ends up
+ *        with exactly the rows passing the new filter, in sort order
+ */
+TEST(MarketDataTableTest, ReinsertDuringFilterPassKeepsView) {
+    EmspConfig config;
+    config.num_rows = 20000;
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    const uint32_t n = config.num_rows;
+    // Performance critical: test input, price order = row order, qty unrelated to it
+    for (uint32_t i = 0; i < n; ++i) {
+        *md_px_n(&slot, i) = i;
+        *md_qty(&slot, i) = (i * 37) % 1000;
+        slot.notify_row_dirty(&slot, i);
+    }
+
+    MarketDataTable table;
+    table.Initialize(n);
+    table.SetWorkBudget(1);  // a slice per cycle is a budget check, about kCheckUnits rows
+    table.Subscribe(ctx, slot);
+    const SortKey by_price{2, true};
+    table.SetSort(&by_price, 1);
+    ColumnFilter filter;
+    filter.type = FILTER_NUMERIC_LESS;
+    filter.numeric_value = 500;
+    filter.enabled = true;
+    table.SetColumnFilter(3, filter);
+    cycle(ctx, slot, table);
+    // Performance critical: until the first sort and pass are done
+    for (int k = 0; k < 1000 && stage_of(table) != ViewWork::Idle; ++k)
+        cycle(ctx, slot, table);
+    ASSERT_EQ(stage_of(table), ViewWork::Idle);
+
+    // The complement: every row the new pass skips keeps a wrong result
+    filter.type = FILTER_NUMERIC_GREATER_EQUAL;
+    table.SetColumnFilter(3, filter);
+    int64_t next_px = n;
+    uint32_t lowest = 0;  // rows below it were already moved to the end
+    int filter_cycles = 0;
+    // Performance critical: the pass, the lowest-priced rows moving to the end meanwhile
+    for (int k = 0; k < 1000; ++k) {
+        // Performance critical: a few rows behind the cursor per cycle
+        for (int t = 0; t < 4; ++t, ++lowest) {
+            *md_px_n(&slot, lowest) = next_px++;
+            slot.notify_row_dirty(&slot, lowest);
+        }
+        cycle(ctx, slot, table);
+        if (stage_of(table) != ViewWork::Filter)
+            break;
+        ++filter_cycles;
+    }
+    EXPECT_GT(filter_cycles, 1) << "the pass spans cycles";
+    const TableView& view = cycle(ctx, slot, table);
+
+    std::vector<uint32_t> expected;
+    // Performance critical: the rows passing, in price order
+    for (uint32_t i = lowest; i < n; ++i) {
+        if (*md_qty(&slot, i) >= 500)
+            expected.push_back(i);
+    }
+    // Performance critical: the moved rows, priced above all others in the order moved
+    for (uint32_t i = 0; i < lowest; ++i) {
+        if (*md_qty(&slot, i) >= 500)
+            expected.push_back(i);
+    }
+    ASSERT_EQ(view.rows.size(), expected.size());
+    EXPECT_TRUE(view.rows == expected);
+}
+
+/**
+ * @brief Prices ticking while a sliced sort runs: once the sort is done and the changed rows
+ *        are merged back, the view is exactly in price order
+ */
+TEST(MarketDataTableTest, TicksDuringSortLeaveExactOrder) {
+    EmspConfig config;
+    config.num_rows = 20000;
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    const uint32_t n = config.num_rows;
+    std::mt19937 rng(5);
+    // Performance critical: test input
+    for (uint32_t i = 0; i < n; ++i) {
+        *md_px_n(&slot, i) = rng() % 1000000;
+        slot.notify_row_dirty(&slot, i);
+    }
+
+    MarketDataTable table;
+    table.Initialize(n);
+    table.SetWorkBudget(1);
+    table.Subscribe(ctx, slot);
+    cycle(ctx, slot, table);  // first snapshot of every row, unsorted
+    const SortKey by_price{2, true};
+    table.SetSort(&by_price, 1);
+
+    int sort_cycles = 0;
+    // Performance critical: the sort, five prices moving per cycle
+    for (int k = 0; k < 1000; ++k) {
+        // Performance critical: five ticks
+        for (int t = 0; t < 5; ++t) {
+            const uint32_t row = rng() % n;
+            *md_px_n(&slot, row) = rng() % 1000000;
+            slot.notify_row_dirty(&slot, row);
+        }
+        cycle(ctx, slot, table);
+        if (stage_of(table) != ViewWork::Sort)
+            break;
+        ++sort_cycles;
+    }
+    EXPECT_GT(sort_cycles, 1) << "the sort spans cycles";
+    const TableView& view = cycle(ctx, slot, table);
+
+    ASSERT_EQ(view.rows.size(), n);
+    size_t inversions = 0;
+    // Performance critical: checks every adjacent pair
+    for (size_t i = 1; i < n; ++i)
+        inversions += ctx.published.px(view.rows[i]) < ctx.published.px(view.rows[i - 1]);
+    EXPECT_EQ(inversions, 0u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../core/mpsc.h"
+
+/**
+ * @brief pop_batch drains everything that is published, in FIFO order
+ */
+TEST(MPSCQueueBatchTest, PopBatchDrainsInOrder) {
+    MPSCQueue queue;
+    queue.init(64);
+
+    for (uint32_t i = 0; i < 40; ++i) {
+        ASSERT_TRUE(queue.push(i));
+    }
+
+    uint32_t out[32];
+    EXPECT_EQ(queue.pop_batch(out, 32), 32u);
+    for (uint32_t i = 0; i < 32; ++i) {
+        EXPECT_EQ(out[i], i);
+    }
+    EXPECT_EQ(queue.pop_batch(out, 32), 8u);
+    EXPECT_EQ(out[0], 32u);
+    EXPECT_EQ(out[7], 39u);
+    EXPECT_EQ(queue.pop_batch(out, 32), 0u);
+}
+
+/**
+ * @brief A full queue rejects pushes without disturbing the queued entries
+ */
+TEST(MPSCQueueBatchTest, OverflowLeavesRingIntact) {
+    MPSCQueue queue;
+    queue.init(8);
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.push(100 + i));
+    }
+    // Repeated overflow must not advance the claim counter
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(queue.push(999));
+    }
+    EXPECT_EQ(queue.size_approx(), 8u);
+
+    uint32_t value;
+    for (uint32_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, 100 + i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+
+    // Ring is usable again after draining
+    EXPECT_TRUE(queue.push(7));
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 7u);
+}
+
+/**
+ * @brief Cells are recycled correctly over many laps of the ring
+ */
+TEST(MPSCQueueBatchTest, WrapsAroundManyLaps) {
+    MPSCQueue queue;
+    queue.init(4);
+
+    uint32_t out[3];
+    for (uint32_t lap = 0; lap < 1000; ++lap) {
+        ASSERT_TRUE(queue.push(lap * 3));
+        ASSERT_TRUE(queue.push(lap * 3 + 1));
+        ASSERT_TRUE(queue.push(lap * 3 + 2));
+        ASSERT_EQ(queue.pop_batch(out, 3), 3u);
+        EXPECT_EQ(out[0], lap * 3);
+        EXPECT_EQ(out[2], lap * 3 + 2);
+    }
+}
+
+/**
+ * @brief Concurrent producers: every accepted value is seen exactly once and
+ * per-producer order is preserved
+ */
+TEST(MPSCQueueBatchTest, ConcurrentProducersNoLossNoTearing) {
+    constexpr uint32_t kProducers = 4;
+    constexpr uint32_t kPerProducer = 50000;
+
+    MPSCQueue queue;
+    queue.init(1024);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (uint32_t i = 0; i < kPerProducer; ++i) {
+                uint32_t v = (p << 24) | i;
+                while (!queue.push(v)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next_expected(kProducers, 0);
+    uint32_t received = 0;
+    uint32_t out[256];
+    while (received < kProducers * kPerProducer) {
+        uint32_t n = queue.pop_batch(out, 256);
+        for (uint32_t k = 0; k < n; ++k) {
+            uint32_t p = out[k] >> 24;
+            ASSERT_LT(p, kProducers);
+            ASSERT_EQ(out[k] & 0xFFFFFFu, next_expected[p]);
+            ++next_expected[p];
+        }
+        received += n;
+    }
+
+    for (auto& t : producers) {
+        t.join();
+    }
+    uint32_t value;
+    EXPECT_FALSE(queue.pop(value));
+}
+
+/**
+ * @brief push_batch claims a run of cells at once and is all or nothing
+ */
+TEST(MPSCQueueTest, PushBatchAllOrNothing) {
+    MPSCQueue queue;
+    queue.init(8);
+
+    const uint32_t a[] = {1, 2, 3, 4, 5};
+    EXPECT_TRUE(queue.push_batch(a, 5));
+    EXPECT_FALSE(queue.push_batch(a, 4)) << "only 3 cells free";
+    EXPECT_EQ(queue.size_approx(), 5u);
+    EXPECT_TRUE(queue.push_batch(a, 3));
+    EXPECT_FALSE(queue.push(9));
+
+    uint32_t out[8];
+    ASSERT_EQ(queue.pop_batch(out, 6), 6u);
+    EXPECT_EQ(out[4], 5u);
+    EXPECT_EQ(out[5], 1u);
+
+    // Wraps around the end of the ring
+    EXPECT_TRUE(queue.push_batch(a, 5));
+    ASSERT_EQ(queue.pop_batch(out, 8), 7u);
+    EXPECT_EQ(out[0], 2u);
+    EXPECT_EQ(out[2], 1u);
+    EXPECT_EQ(out[6], 5u);
+    EXPECT_TRUE(queue.push_batch(a, 0));
+    EXPECT_FALSE(queue.push_batch(a, 9));
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../core/profiler.h"
+
+namespace {
+
+// Samples of the profiled thread called name that ended at or after since_ns, so earlier
+// runs of the same test (--gtest_repeat) are left out
+std::vector<ProfileSample> samples_of(const char* name, int64_t since_ns) {
+    Profiler& profiler = Profiler::global();
+    std::vector<ProfileSample> all, mine;
+    profiler.collect(all, since_ns);
+    // Performance critical: filters the test thread's samples
+    for (const ProfileSample& s : all) {
+        if (profiler.thread_name(s.thread) == name)
+            mine.push_back(s);
+    }
+    return mine;
+}
+
+}  // namespace
+
+/**
+ * @brief Nested probes come out innermost first, with their depth, inside their parent
+ */
+TEST(ProfilerTest, NestedScopesKeepDepthAndOrder) {
+    // Probes on the test thread: it claims one ring for the whole run, where a thread per
+    // repeat would use up kMaxThreads
+    const int64_t since_ns = Profiler::now_ns();
+    Profiler::global().set_thread_name("test nested");
+    {
+        PROFILE_SCOPE("outer");
+        {
+            PROFILE_SCOPE("inner");
+            PROFILE_SCOPE("innermost");
+        }
+        PROFILE_SCOPE("second");
+    }
+
+    const std::vector<ProfileSample> s = samples_of("test nested", since_ns);
+    ASSERT_EQ(s.size(), 4u);
+    EXPECT_STREQ(s[0].name, "innermost");
+    EXPECT_EQ(s[0].depth, 2u);
+    EXPECT_STREQ(s[1].name, "inner");
+    EXPECT_EQ(s[1].depth, 1u);
+    EXPECT_STREQ(s[2].name, "second");
+    EXPECT_EQ(s[2].depth, 1u);
+    EXPECT_STREQ(s[3].name, "outer");
+    EXPECT_EQ(s[3].depth, 0u);
+    EXPECT_LE(s[3].begin_ns, s[1].begin_ns);
+    EXPECT_GE(s[3].end_ns, s[2].end_ns);
+}
+
+/**
+ * @brief With profiling off a probe records nothing and claims no ring
+ */
+TEST(ProfilerTest, OffRecordsNothing) {
+    Profiler& profiler = Profiler::global();
+    const uint32_t rings = profiler.used.load();
+    profiler.enabled.store(false);
+    std::thread([] { PROFILE_SCOPE("never"); }).join();
+    profiler.enabled.store(true);
+    EXPECT_EQ(profiler.used.load(), rings);
+}
+
+/**
+ * @brief A wrapped ring yields exactly its last kCapacity - 1 scopes, oldest first; since_ns
+ *        trims the older ones
+ */
+TEST(ProfileRingTest, WrapKeepsNewestInOrder) {
+    auto ring = std::make_unique<ProfileRing>();
+    const uint64_t n = ProfileRing::kCapacity * 2 + 123;
+    // Performance critical: fills the ring twice over
+    for (uint64_t i = 0; i < n; ++i)
+        ring->push("x", (int64_t)i * 10, (int64_t)i * 10 + 5, 0);
+
+    std::vector<ProfileSample> out;
+    ring->copy(out, 0);
+    ASSERT_EQ(out.size(), ProfileRing::kCapacity - 1);
+    EXPECT_EQ(out.front().begin_ns, (int64_t)(n - ProfileRing::kCapacity + 1) * 10);
+    EXPECT_EQ(out.back().begin_ns, (int64_t)(n - 1) * 10);
+
+    out.clear();
+    ring->copy(out, (int64_t)(n - 10) * 10 + 5);
+    ASSERT_EQ(out.size(), 10u);
+    EXPECT_EQ(out.front().end_ns, (int64_t)(n - 10) * 10 + 5);
+}
+
+/**
+ * @brief A reader copying while the writer laps the ring never gets a half-written scope
+ */
+TEST(ProfileRingTest, ConcurrentCopySeesWholeScopes) {
+    auto ring = std::make_unique<ProfileRing>();
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        int64_t i = 0;
+        // Performance critical: laps the ring over and over until the reader is done
+        while (!stop.load(std::memory_order_relaxed)) {
+            ring->push("w", i, i * 3, (uint32_t)(i % 7));
+            if (++i % 16 == 0)
+                std::this_thread::yield();  // slow enough for copies to keep some scopes
+        }
+    });
+
+    // Performance critical: waits for the writer to lap the ring twice
+    while (ring->head.load() < 2 * ProfileRing::kCapacity)
+        std::this_thread::yield();
+
+    std::vector<ProfileSample> out;
+    uint64_t checked = 0;
+    // Performance critical: many copies racing the writer
+    for (int round = 0; round < 200; ++round) {
+        out.clear();
+        ring->copy(out, 0);
+        // Performance critical: every copied scope must be one consistent push
+        for (size_t k = 0; k < out.size(); ++k) {
+            ASSERT_EQ(out[k].end_ns, out[k].begin_ns * 3);
+            ASSERT_EQ(out[k].depth, (uint32_t)(out[k].begin_ns % 7));
+            if (k > 0) {
+                ASSERT_EQ(out[k].begin_ns, out[k - 1].begin_ns + 1);
+            }
+        }
+        checked += out.size();
+    }
+    stop.store(true);
+    writer.join();
+    EXPECT_GT(checked, 0u);
+}
+
+/**
+ * @brief The export is a Chrome trace: thread name metadata and one complete event per scope
+ */
+TEST(ProfilerTest, ChromeTraceHasThreadsAndEvents) {
+    Profiler::global().set_thread_name("test \"trace\"");
+    {
+        PROFILE_SCOPE("exported");
+    }
+
+    FILE* f = std::tmpfile();
+    ASSERT_NE(f, nullptr);
+    Profiler::global().write_chrome_trace(f);
+    std::rewind(f);
+    std::string text;
+    char buf[4096];
+    size_t got;
+    // Performance critical: reads back the export
+    while ((got = std::fread(buf, 1, sizeof(buf), f)) > 0)
+        text.append(buf, got);
+    std::fclose(f);
+
+    EXPECT_EQ(text.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(text.find("\"args\":{\"name\":\"test \\\"trace\\\"\"}"), std::string::npos)
+        << "quotes escaped";
+    EXPECT_NE(text.find("{\"name\":\"exported\",\"cat\":\"emsp\",\"ph\":\"X\""),
+              std::string::npos);
+    EXPECT_EQ(text.substr(text.size() - 4), "\n]}\n");
+}
@@ -0,0 +1,332 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../../core/data_updater.h"
+#include "../../core/published_rows.h"
+
+/**
+ * @brief The publisher backs off while a reader is inside and the epoch only moves on publish
+ */
+TEST(PublishedRowsTest, PublishDefersToReaders) {
+    PublishedRows rows;
+    rows.init(4);
+    EXPECT_EQ(rows.epoch.load(), 0u);
+
+    {
+        PublishedReadGuard view(rows);
+        EXPECT_EQ(view.epoch, 0u);
+        EXPECT_FALSE(rows.try_begin_publish());
+        EXPECT_EQ(rows.epoch.load(), 0u) << "a failed attempt leaves the epoch alone";
+    }
+
+    ASSERT_TRUE(rows.try_begin_publish());
+    EXPECT_EQ(rows.epoch.load() & 1u, 1u);
+    rows.set(2, RowSnap{7, 8, 9, 1});
+    rows.end_publish();
+    EXPECT_EQ(rows.epoch.load(), 2u);
+
+    PublishedReadGuard view(rows);
+    EXPECT_EQ(view.epoch, 2u);
+    EXPECT_TRUE(rows.same(2, RowSnap{7, 8, 9, 1}));
+    EXPECT_EQ(rows.row(2).px, 8);
+    EXPECT_EQ(rows.row(1).px, 0);
+}
+
+/**
+ * @brief A refresh that meets a reader keeps its rows dirty and publishes them next time
+ */
+TEST(PublishedRowsTest, RefreshHoldsRowsWhileReaderInside) {
+    EmspConfig config;
+    config.num_rows = 16;
+    std::vector<int64_t> ts_ns(config.num_rows, 0), px_n(config.num_rows, 0),
+        qty(config.num_rows, 0);
+    std::vector<uint8_t> side(config.num_rows, 0);
+    HostContext ctx;
+    HostMDSlot slot;
+    initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+
+    px_n[3] = 300;
+    slot.notify_row_dirty(&slot, 3);
+    {
+        PublishedReadGuard view(ctx.published);
+        update_latest_data_from_context(ctx, config, 100, 100, slot);
+        EXPECT_EQ(ctx.published.px(3), 0) << "view stays at its epoch";
+        EXPECT_EQ(ctx.snap_stats.held, 1u);
+        EXPECT_EQ(ctx.dirty[3], 1);
+    }
+
+    update_latest_data_from_context(ctx, config, 200, 200, slot);
+    EXPECT_EQ(ctx.published.px(3), 300);
+    EXPECT_EQ(ctx.dirty[3], 0);
+    EXPECT_EQ(ctx.published.epoch.load(), 2u);
+}
+
+/**
+ * @brief Readers on another thread never see a change set half applied
+ */
+TEST(PublishedRowsTest, ReadersSeeWholeChangeSets) {
+    constexpr uint32_t kRows = 64;
+    constexpr int64_t kSets = 2000;
+    PublishedRows rows;
+    rows.init(kRows);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> mixed{0}, views{0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            PublishedReadGuard view(rows);
+            const int64_t v = rows.px(0);
+            for (uint32_t i = 1; i < kRows; ++i) {
+                if (rows.px(i) != v) {
+                    ++mixed;
+                    break;
+                }
+            }
+            ++views;
+        }
+    });
+
+    // Start handshake: the reader is in its loop before the first publish, and publishing
+    // goes on until it has taken kMinViews views meanwhile, however the threads are scheduled
+    constexpr uint64_t kMinViews = 100;
+    while (views.load() == 0)
+        std::this_thread::yield();
+    const uint64_t views_before = views.load();
+
+    // Change set v sets every row to v; a deferred set is simply retried
+    int64_t v = 1;
+    while (v <= kSets || views.load() - views_before < kMinViews) {
+        if (!rows.try_begin_publish()) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint32_t i = 0; i < kRows; ++i) {
+            rows.set(i, RowSnap{v, v, v, 1});
+        }
+        rows.end_publish();
+        ++v;
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(mixed.load(), 0u);
+    EXPECT_GE(views.load() - views_before, kMinViews);
+    EXPECT_EQ(rows.epoch.load(), 2u * (uint64_t)(v - 1));
+}
+
+/**
+ * @brief A snapshot keeps its epoch while publishing goes on; only pinned blocks are copied
+ */
+TEST(PublishedRowsTest, SnapshotKeepsItsEpoch) {
+    const uint32_t kRows = 3 * kPublishedBlockRows;
+    PublishedRows rows;
+    rows.init(kRows);
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(1, RowSnap{1, 10, 100, 1});
+    rows.end_publish();
+
+    PublishedSnapshot snap;
+    ASSERT_TRUE(rows.snapshot(snap));
+    EXPECT_EQ(snap.epoch, 2u);
+    EXPECT_EQ(snap.num_rows, kRows);
+
+    // Snapshots do not hold readers back
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(1, RowSnap{2, 20, 200, 2});
+    rows.set(2, RowSnap{2, 21, 200, 2});  // same block, copied once
+    rows.set(kPublishedBlockRows + 5, RowSnap{2, 22, 200, 2});
+    rows.end_publish();
+    EXPECT_EQ(rows.cow_copies, 2u);
+    EXPECT_EQ(rows.px(1), 20);
+    EXPECT_EQ(rows.px(kPublishedBlockRows + 5), 22);
+
+    EXPECT_EQ(snap.px(1), 10);
+    EXPECT_EQ(snap.px(2), 0);
+    EXPECT_EQ(snap.side(1), 1);
+    EXPECT_EQ(snap.px(kPublishedBlockRows + 5), 0);
+    EXPECT_EQ(snap.blocks[2], rows.blocks[2]) << "untouched block stays shared";
+
+    // Released clones are recycled instead of allocated again
+    snap.release();
+    EXPECT_FALSE(snap.valid());
+    ASSERT_TRUE(rows.snapshot(snap));
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(3, RowSnap{3, 30, 300, 1});
+    rows.end_publish();
+    EXPECT_EQ(rows.cow_copies, 3u);
+    snap.release();
+    EXPECT_EQ(rows.spares.size(), 2u);
+
+    // With nothing pinned the publisher writes in place
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(4, RowSnap{4, 40, 400, 1});
+    rows.end_publish();
+    EXPECT_EQ(rows.cow_copies, 3u);
+}
+
+/**
+ * @brief Totals over a snapshot taken on another thread always match one whole change set
+ */
+TEST(PublishedRowsTest, SnapshotTotalsAreConsistent) {
+    const uint32_t kRows = 2 * kPublishedBlockRows + 17;
+    constexpr int64_t kSets = 300;
+    PublishedRows rows;
+    rows.init(kRows);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> mixed{0}, views{0};
+    std::thread reader([&] {
+        PublishedSnapshot snap;
+        while (!done.load()) {
+            ASSERT_TRUE(rows.snapshot(snap));
+            // Change set v writes qty v to every row, so the total is a multiple of kRows
+            int64_t total = 0;
+            for (uint32_t i = 0; i < kRows; ++i)
+                total += snap.qty(i);
+            if (total % kRows != 0 || total / kRows != (int64_t)(snap.epoch / 2))
+                ++mixed;
+            snap.release();
+            ++views;
+        }
+    });
+
+    for (int64_t v = 1; v <= kSets;) {
+        if (!rows.try_begin_publish()) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint32_t i = 0; i < kRows; ++i) {
+            rows.set(i, RowSnap{v, v, v, 1});
+        }
+        rows.end_publish();
+        ++v;
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(mixed.load(), 0u);
+    EXPECT_GT(views.load(), 0u);
+    EXPECT_LE(rows.spares.size(), 2u * rows.num_blocks) << "clones are recycled";
+}
+
+/**
+ * @brief Snapshots released on several threads while the publisher clones hand every block
+ *        back to the pool exactly once
+ */
+TEST(PublishedRowsTest, ConcurrentReleasesKeepThePoolWhole) {
+    const uint32_t kRows = 4 * kPublishedBlockRows;
+    constexpr int64_t kSets = 200;
+    PublishedRows rows;
+    rows.init(kRows);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> started{0};
+    std::vector<std::thread> readers;
+    // Performance critical: test input, four threads pinning and releasing blocks
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            PublishedSnapshot snap;
+            ++started;
+            // Performance critical: test input, pins every block as often as it can
+            while (!done.load()) {
+                rows.snapshot(snap);
+                snap.release();
+            }
+        });
+    }
+    // Performance critical: start handshake, every reader runs before the first publish
+    while (started.load() < 4)
+        std::this_thread::yield();
+
+    // Performance critical: test input, one row per block per change set. The publisher pins
+    // the table before each set, so every set clones every block.
+    PublishedSnapshot held;
+    for (int64_t v = 1; v <= kSets;) {
+        rows.snapshot(held);
+        if (!rows.try_begin_publish()) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint32_t b = 0; b < rows.num_blocks; ++b)
+            rows.set(b * kPublishedBlockRows + (uint32_t)v, RowSnap{v, v, v, 1});
+        rows.end_publish();
+        ++v;
+    }
+    held.release();
+    done = true;
+    // Performance critical: test teardown
+    for (std::thread& t : readers)
+        t.join();
+
+    // Every block is either current or free, never both and never listed twice
+    std::set<const PublishedBlock*> free_blocks;
+    size_t listed = 0;
+    for (const PublishedBlock* b : {rows.free_local, rows.free_head.load()}) {
+        // Performance critical: walks one free list
+        for (; b; b = b->next_free, ++listed)
+            free_blocks.insert(b);
+    }
+    EXPECT_EQ(listed, free_blocks.size());
+    EXPECT_EQ(free_blocks.size(), rows.spares.size());
+    for (uint32_t b = 0; b < rows.num_blocks; ++b) {
+        EXPECT_EQ(free_blocks.count(rows.blocks[b]), 0u);
+        EXPECT_EQ(rows.blocks[b]->refs.load(), 1u);
+    }
+    EXPECT_GE(rows.cow_copies, (uint64_t)kSets * rows.num_blocks);
+    for (int64_t v = 1; v <= kSets; ++v)
+        ASSERT_EQ(rows.qty(kPublishedBlockRows + (uint32_t)v), v);
+}
+
+/**
+ * @brief Values far from the block base rebase transparently; a column spanning more than
+ * 32 bits falls back to int64 values; bulk decode matches the per-row reads
+ */
+TEST(PublishedRowsTest, DeltaEncodingRebasesAndWidens) {
+    const uint32_t kRows = kPublishedBlockRows + 100;
+    PublishedRows rows;
+    rows.init(kRows);
+    const int64_t ns = 1700000000000000000LL;
+
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(0, RowSnap{ns, 10050, 7, 1});
+    rows.set(1, RowSnap{ns + 1000, -25, 0, 2});
+    rows.set(2, RowSnap{ns - 4000000000LL, 10060, 3, 3});  // still within 2^32 of the others
+    rows.set(kPublishedBlockRows + 1, RowSnap{-5, INT64_MAX, INT64_MIN, 2});
+    rows.end_publish();
+    EXPECT_EQ(rows.widened, 0u);
+    EXPECT_GT(rows.rebases, 0u);
+
+    EXPECT_EQ(rows.ts(0), ns);
+    EXPECT_EQ(rows.ts(1), ns + 1000);
+    EXPECT_EQ(rows.ts(2), ns - 4000000000LL);
+    EXPECT_EQ(rows.px(1), -25);
+    EXPECT_EQ(rows.qty(1), 0);
+    EXPECT_EQ(rows.side(2), 3);
+    EXPECT_EQ(rows.ts(3), 0) << "untouched rows stay 0";
+    EXPECT_TRUE(rows.same(kPublishedBlockRows + 1, RowSnap{-5, INT64_MAX, INT64_MIN, 2}));
+
+    // A timestamp an hour away no longer fits 32-bit deltas: the column widens
+    ASSERT_TRUE(rows.try_begin_publish());
+    rows.set(5, RowSnap{ns + 3600000000000LL, 1, 1, 1});
+    rows.end_publish();
+    EXPECT_EQ(rows.widened, 1u);
+    EXPECT_EQ(rows.ts(5), ns + 3600000000000LL);
+    EXPECT_EQ(rows.ts(2), ns - 4000000000LL);
+    EXPECT_EQ(rows.px(0), 10050) << "other columns stay narrow";
+
+    PublishedSnapshot snap;
+    ASSERT_TRUE(rows.snapshot(snap));
+    std::vector<int64_t> out(kRows);
+    for (uint32_t f = 0; f < kPublishedFields; ++f) {
+        snap.decode(f, 0, kRows, out.data());
+        for (uint32_t i = 0; i < kRows; ++i) {
+            const RowSnap r = rows.row(i);
+            const int64_t expect = f == PubTs ? r.ts : f == PubPx ? r.px : r.qty;
+            ASSERT_EQ(out[i], expect) << "field " << f << " row " << i;
+        }
+    }
+}
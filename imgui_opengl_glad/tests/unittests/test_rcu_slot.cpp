@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../core/rcu_slot.h"
+
+/**
+ * @brief The consumer gets the newest publish, skips the ones in between, and keeps its value
+ */
+TEST(RcuSlotTest, ReadTakesNewestValue) {
+    RcuSlot<int> slot;
+    EXPECT_FALSE(slot.fresh());
+    EXPECT_EQ(slot.read(), 0) << "nothing published yet";
+
+    slot.back() = 1;
+    slot.publish();
+    slot.back() = 2;
+    slot.publish();
+    EXPECT_TRUE(slot.fresh());
+    EXPECT_EQ(slot.read(), 2);
+    EXPECT_FALSE(slot.fresh());
+    EXPECT_EQ(slot.read(), 2) << "no new publish, same value";
+    EXPECT_EQ(slot.published, 2u);
+    EXPECT_EQ(slot.taken, 1u);
+
+    // The producer never writes the buffer the consumer holds
+    const int* held = &slot.front();
+    for (int v = 3; v < 10; ++v) {
+        EXPECT_NE(&slot.back(), held);
+        slot.back() = v;
+        slot.publish();
+        EXPECT_EQ(*held, 2);
+    }
+    EXPECT_EQ(slot.read(), 9);
+}
+
+/**
+ * @brief Values handed across threads are always whole and never go backwards
+ */
+TEST(RcuSlotTest, ConsumerSeesWholeValues) {
+    constexpr uint32_t kLen = 512;
+    constexpr uint32_t kPublishes = 20000;
+    RcuSlot<std::vector<uint32_t>> slot;
+
+    std::atomic<bool> done{false}, reading{false};
+    std::atomic<uint64_t> torn{0}, backwards{0}, reads{0};
+    std::thread consumer([&] {
+        uint32_t last = 0;
+        while (!done.load()) {
+            const std::vector<uint32_t>& v = slot.read();
+            ++reads;
+            reading.store(true);
+            if (v.empty())
+                continue;
+            // Performance critical: checks every element of the value
+            for (uint32_t x : v) {
+                if (x != v[0]) {
+                    ++torn;
+                    break;
+                }
+            }
+            backwards += v[0] < last;
+            last = v[0];
+        }
+    });
+
+    // Performance critical: start handshake, the consumer has read once before the first publish
+    while (!reading.load())
+        std::this_thread::yield();
+    for (uint32_t n = 1; n <= kPublishes; ++n) {
+        slot.back().assign(kLen, n);
+        slot.publish();
+    }
+    done = true;
+    consumer.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_EQ(backwards.load(), 0u);
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(slot.read()[0], kPublishes);
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../core/data_updater.h"
+#include "../../core/spsc.h"
+
+/**
+ * @brief SPSC ring keeps FIFO order and reports full / empty
+ */
+TEST(SPSCRingTest, FifoFullAndEmpty) {
+    SPSCRing ring;
+    ring.init(8);
+
+    uint32_t out[16];
+    EXPECT_EQ(ring.pop_batch(out, 16), 0u);
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(99));
+
+    EXPECT_EQ(ring.pop_batch(out, 5), 5u);
+    EXPECT_EQ(out[0], 0u);
+    EXPECT_EQ(out[4], 4u);
+    EXPECT_TRUE(ring.push(8));
+    EXPECT_EQ(ring.pop_batch(out, 16), 4u);
+    EXPECT_EQ(out[3], 8u);
+}
+
+/**
+ * @brief push_batch publishes a run with one head store and is all or nothing
+ */
+TEST(SPSCRingTest, PushBatchAllOrNothing) {
+    SPSCRing ring;
+    ring.init(8);
+    const uint32_t a[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_TRUE(ring.push_batch(a, 6));
+    EXPECT_FALSE(ring.push_batch(a, 3));
+    EXPECT_TRUE(ring.push_batch(a, 2));
+
+    uint32_t out[8];
+    ASSERT_EQ(ring.pop_batch(out, 8), 8u);
+    EXPECT_EQ(out[5], 6u);
+    EXPECT_EQ(out[7], 2u);
+}
+
+/**
+ * @brief One producer thread and one consumer thread exchange every value in order
+ */
+TEST(SPSCRingTest, ConcurrentProducerConsumer) {
+    constexpr uint32_t kCount = 50000;
+    SPSCRing ring;
+    ring.init(256);
+
+    std::thread producer([&ring] {
+        for (uint32_t i = 0; i < kCount; ++i) {
+            while (!ring.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t out[64];
+    while (expected < kCount) {
+        uint32_t n = ring.pop_batch(out, 64);
+        for (uint32_t k = 0; k < n; ++k) {
+            ASSERT_EQ(out[k], expected);
+            ++expected;
+        }
+    }
+    producer.join();
+}
+
+/**
+ * @brief Fixture running the host in per-writer ring mode
+ */
+class WriterRingsTest : public ::testing::Test {
+  protected:
+    EmspConfig config;
+    HostContext ctx;
+    HostMDSlot slot;
+    std::vector<int64_t> ts_ns, px_n, qty;
+    std::vector<uint8_t> side;
+
+    void SetUp() override {
+        config.num_rows = 64;
+        config.writers = 2;
+        config.notify_mode = NotifyMode::WriterRings;
+        ts_ns.assign(config.num_rows, 0);
+        px_n.assign(config.num_rows, 0);
+        qty.assign(config.num_rows, 0);
+        side.assign(config.num_rows, 0);
+        initializeHostContext(ctx, slot, config, ts_ns, px_n, qty, side);
+    }
+};
+
+/**
+ * @brief Registered writers notify through their own rings, extra writers fall back
+ */
+TEST_F(WriterRingsTest, RegisterNotifyAndFallback) {
+    ASSERT_NE(slot.register_writer, nullptr);
+    int32_t w0 = slot.register_writer(&slot);
+    int32_t w1 = slot.register_writer(&slot);
+    int32_t w2 = slot.register_writer(&slot);
+    EXPECT_EQ(w0, 0);
+    EXPECT_EQ(w1, 1);
+    EXPECT_EQ(w2, -1);  // only config.writers rings
+
+    slot.notify_row_dirty_from(&slot, w0, 3);
+    slot.notify_row_dirty_from(&slot, w1, 9);
+    slot.notify_row_dirty_from(&slot, w2, 12);  // shared queue
+
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+    EXPECT_EQ(ctx.dirty[3], 1);
+    EXPECT_EQ(ctx.dirty[9], 1);
+    EXPECT_EQ(ctx.dirty[12], 1);
+    EXPECT_EQ(ctx.dirty[4], 0);
+
+    // A released ring can be claimed again
+    slot.unregister_writer(&slot, w1);
+    EXPECT_EQ(slot.register_writer(&slot), 1);
+}
+
+/**
+ * @brief commit_batch publishes through the writer's own ring with one push
+ */
+TEST_F(WriterRingsTest, CommitBatchUsesWriterRing) {
+    int32_t w = slot.register_writer(&slot);
+    const uint32_t ids[] = {8, 9, 10};
+    slot.begin_batch(&slot, ids, 3);
+    slot.commit_batch(&slot, w, ids, 3);
+
+    uint32_t value;
+    EXPECT_FALSE(ctx.q.pop(value));
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+    EXPECT_EQ(ctx.dirty[8], 1);
+    EXPECT_EQ(ctx.dirty[10], 1);
+    EXPECT_EQ(ctx.dirty[11], 0);
+}
+
+/**
+ * @brief A full writer ring counts the overflow and triggers a resync
+ */
+TEST_F(WriterRingsTest, RingOverflowTriggersResync) {
+    int32_t w = slot.register_writer(&slot);
+    uint32_t cap = ctx.writer_rings[w].capacity();
+    for (uint32_t i = 0; i < cap + 10; ++i) {
+        slot.notify_row_dirty_from(&slot, w, 1);
+    }
+    EXPECT_EQ(ctx.overflow_count.load(), 10u);
+
+    update_latest_data_from_context(ctx, config, 100, 200, slot);
+    EXPECT_EQ(ctx.resync_count, 1u);
+    EXPECT_EQ(ctx.dirty[40], 1);
+    uint32_t out[4];
+    EXPECT_EQ(ctx.writer_rings[w].pop_batch(out, 4), 0u);
+}
@@ -0,0 +1,99 @@
+#include "DiagnosticsWindow.h"
+
+#include <utility>
+
+#include "imgui.h"
+
+// Performance critical: no, constructed once; the path is moved in
+DiagnosticsWindow::DiagnosticsWindow(std::string dump_path)
+    : dump_path_(dump_path.empty() ? "latency_report.txt" : std::move(dump_path)),
+      merged_(std::make_unique<LatencySnapshot[]>(kTickStages)),  // 80 KB each, off the stack
+      baseline_(std::make_unique<LatencySnapshot[]>(kTickStages)) {
+}
+
+// Merges every thread's histograms and takes the baseline off
+void DiagnosticsWindow::Refresh(const LatencyRecorder& latency) {
+    // Performance critical: five merges, four times a second
+    for (uint32_t st = 0; st < kTickStages; ++st) {
+        merged_[st] = LatencySnapshot{};
+        latency.merge((TickStage)st, merged_[st]);
+        merged_[st].subtract(baseline_[st]);
+        summaries_[st] = summarize(merged_[st]);
+    }
+}
+
+void DiagnosticsWindow::Reset(const LatencyRecorder& latency) {
+    // Performance critical: five merges, on the button only
+    for (uint32_t st = 0; st < kTickStages; ++st) {
+        baseline_[st] = LatencySnapshot{};
+        latency.merge((TickStage)st, baseline_[st]);
+    }
+}
+
+void DiagnosticsWindow::Render(LatencyRecorder& latency) {
+    if (!ImGui::Begin("Latency")) {
+        ImGui::End();
+        return;
+    }
+
+    const double now = ImGui::GetTime();
+    if (now >= next_refresh_) {
+        Refresh(latency);
+        next_refresh_ = now + kRefreshMs * 1e-3;
+    }
+
+    bool enabled = latency.on();
+    if (ImGui::Checkbox("Record", &enabled))
+        latency.enabled.store(enabled, std::memory_order_relaxed);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) {
+        Reset(latency);
+        next_refresh_ = 0.0;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump")) {
+        dump_status_ = latency.dump(dump_path_.c_str()) ? "Written to " + dump_path_
+                                                        : "Cannot write " + dump_path_;
+    }
+    if (!dump_status_.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", dump_status_.c_str());
+    }
+
+    ImGui::TextDisabled("Tick age in microseconds, plugin timestamp to each stage");
+    const ImGuiTableFlags flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("LatencyStages", 7, flags)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p90");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("p99.9");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+        // Performance critical: five rows
+        for (uint32_t st = 0; st < kTickStages; ++st) {
+            const LatencySummary& s = summaries_[st];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(tick_stage_name((TickStage)st));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)s.count);
+            const uint64_t values[] = {s.p50, s.p90, s.p99, s.p999, s.max};
+            // Performance critical: five cells
+            for (uint64_t v : values) {
+                ImGui::TableNextColumn();
+                if (s.count)
+                    ImGui::Text("%.1f", v / 1e3);
+                else
+                    ImGui::TextDisabled("-");
+            }
+        }
+        ImGui::EndTable();
+    }
+    if (const uint64_t lost = latency.unclaimed.load(std::memory_order_relaxed))
+        ImGui::TextDisabled("%llu samples from threads past the first %u not recorded",
+                           (unsigned long long)lost, LatencyRecorder::kMaxThreads);
+    ImGui::End();
+}
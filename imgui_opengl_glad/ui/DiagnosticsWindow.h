@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "../core/latency_recorder.h"
+
+// "Latency" window: tick age at each TickStage, from the plugin's ts_ns to the notification,
+// the published snapshot, the change-set delivery, the table view and the buffer swap.
+// The histograms are merged at most every kRefreshMs; Reset restarts the figures from the
+// current counts without stopping the recording threads, Dump writes the full report.
+class DiagnosticsWindow {
+  public:
+    static constexpr int kRefreshMs = 250;
+
+    // Dump writes to path, or latency_report.txt when empty
+    explicit DiagnosticsWindow(std::string dump_path);
+
+    // Render thread
+    void Render(LatencyRecorder& latency);
+
+  private:
+    void Refresh(const LatencyRecorder& latency);
+    void Reset(const LatencyRecorder& latency);
+
+    std::string dump_path_;
+    std::string dump_status_;
+    double next_refresh_ = 0.0;                   // ImGui time of the next merge
+    std::unique_ptr<LatencySnapshot[]> merged_;   // one per stage, scratch of Refresh
+    std::unique_ptr<LatencySnapshot[]> baseline_; // one per stage, counts at the last Reset
+    LatencySummary summaries_[kTickStages];
+};
@@ -2,10 +2,38 @@
 
 #include <cstring>
 
+#include "../core/frame_pacer.h"
 #include "../core/main_context.h"
 #include "MarketDataTable.h"
 #include "imgui.h"
 
+namespace {
+
+// Pacer the GLFW input callbacks report to, set by Attach. GLFW callbacks carry no context
+// and ImGui chains to them for every window, so this is the one shared pointer.
+FramePacer* g_input_pacer = nullptr;
+
+void NoteInput() {
+    if (g_input_pacer)
+        g_input_pacer->note_input();
+}
+
+void InstallInputCallbacks(GLFWwindow* window) {
+    // Installed before the ImGui backend, which keeps and calls them after its own
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { NoteInput(); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { NoteInput(); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { NoteInput(); });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { NoteInput(); });
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { NoteInput(); });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { NoteInput(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { NoteInput(); });
+    // Not used by ImGui: resizes and exposes need a frame too
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { NoteInput(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { NoteInput(); });
+}
+
+}  // namespace
+
 void ImGuiComponents::Init(GLFWwindow* window, const char* glsl_version) {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -28,38 +56,75 @@ void ImGuiComponents::Init(GLFWwindow* window, const char* glsl_version) {
     }
 
     // Setup Platform/Renderer bindings
+    InstallInputCallbacks(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplGlfw_SetCallbacksChainForAllWindows(true);  // input in viewport windows too
     ImGui_ImplOpenGL3_Init(glsl_version);
 
     // Initialize the enhanced market data table
     market_data_table_ = std::make_unique<MarketDataTable>();
-    // We'll initialize it with max rows when we have context
+    // Sized and subscribed by Attach once the context exists
     
     // Initialize the navigator
     navigator_ = std::make_unique<Navigator>();
-    // We'll initialize it with max rows when we have context
+    // Sized and subscribed by Attach once the context exists
+
+    diagnostics_ = std::make_unique<DiagnosticsWindow>(std::string());
+    profiler_window_ = std::make_unique<ProfilerWindow>(std::string());
 }
 
 void ImGuiComponents::NewFrame() {
+    PROFILE_SCOPE("ImGui::NewFrame");
     // feed inputs to dear imgui, start new frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 }
 
-void ImGuiComponents::Update(HostContext& ctx, const HostMDSlot& slot, uint64_t& next_paint_ms) {
-    // Initialize components if not done yet
-    static bool components_initialized = false;
-    if (!components_initialized) {
-        if (market_data_table_) {
-            market_data_table_->Initialize(ctx.num_rows);
-        }
-        if (navigator_) {
-            navigator_->Initialize(ctx.num_rows);
-        }
-        components_initialized = true;
+void ImGuiComponents::Attach(HostContext& ctx, const HostMDSlot& slot, FramePacer* pacer) {
+    if (market_data_table_) {
+        market_data_table_->Initialize(ctx.num_rows, &ctx.arena);
+        market_data_table_->Subscribe(ctx, slot);
     }
+    if (navigator_) {
+        navigator_->Initialize(ctx.num_rows);
+        navigator_->Subscribe(ctx);
+    }
+    if (!pacer || pacer_sub_ >= 0)
+        return;
+
+    // Subscribed after the views, so it runs once they are done with the cycle: wakes the
+    // render thread when rows changed, the table published a view it has not drawn yet
+    // (a view held back by backpressure goes out on a later, possibly empty, cycle) or its
+    // work in progress moved on
+    ctx_ = &ctx;
+    g_input_pacer = pacer;
+    pacer_sub_ = ctx.changes.subscribe([this, pacer](const ChangeSet& changes) {
+        const uint64_t views = market_data_table_ ? market_data_table_->ViewsPublished() : 0;
+        const uint32_t work = market_data_table_ ? market_data_table_->WorkState() : 0;
+        if (!changes.empty() || views != views_seen_ || work != work_seen_) {
+            views_seen_ = views;
+            work_seen_ = work;
+            pacer->notify_data(FramePacer::now_us());
+        }
+    });
+}
+
+void ImGuiComponents::SetWorkBudget(uint32_t budget_us) {
+    if (market_data_table_)
+        market_data_table_->SetWorkBudget(budget_us);
+}
+
+void ImGuiComponents::SetLatencyReportPath(const std::string& path) {
+    diagnostics_ = std::make_unique<DiagnosticsWindow>(path);
+}
+
+void ImGuiComponents::SetTracePath(const std::string& path) {
+    profiler_window_ = std::make_unique<ProfilerWindow>(path);
+}
 
+void ImGuiComponents::Update(HostContext& ctx, const HostMDSlot& slot) {
+    PROFILE_SCOPE("ImGui update");
     // Create main window with dockspace (similar to imgui_basic)
     ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::SetNextWindowPos(viewport->WorkPos);
@@ -83,9 +148,8 @@ void ImGuiComponents::Update(HostContext& ctx, const HostMDSlot& slot, uint64_t&
 
     ImGui::End();  // End MainWindow
 
-    // Update and render components - both share the same data source
-    uint64_t t = now_ms();
-    bool should_refresh = (t >= next_paint_ms);
+    // Render components - both share the same data source; the ingest thread keeps their
+    // views current through the change subscriptions, so here they only draw
 
     // Render Navigator (left side, dockable) - pass table pointer for filter interaction
     if (navigator_) {
@@ -94,18 +158,25 @@ void ImGuiComponents::Update(HostContext& ctx, const HostMDSlot& slot, uint64_t&
 
     // Render Market Data Table (right side, dockable)
     if (market_data_table_) {
-        market_data_table_->UpdateFromContext(ctx, slot, should_refresh);
         market_data_table_->Render(ctx, slot);
     }
 
-    if (should_refresh) {
-        next_paint_ms = t + 250;
+    if (diagnostics_) {
+        diagnostics_->Render(ctx.latency);
+    }
+
+    if (profiler_window_) {
+        profiler_window_->Render();
     }
 }
 
 void ImGuiComponents::Render() {
+    PROFILE_SCOPE("GL render");
     // Render dear imgui into screen
-    ImGui::Render();
+    {
+        PROFILE_SCOPE("ImGui::Render");
+        ImGui::Render();
+    }
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
     // Update and Render additional Platform Windows
@@ -118,10 +189,23 @@ void ImGuiComponents::Render() {
     }
 }
 
+void ImGuiComponents::FramePresented(HostContext& ctx) {
+    if (market_data_table_ && ctx.latency.on())
+        market_data_table_->FramePresented(ctx.latency);
+}
+
 void ImGuiComponents::Shutdown() {
+    // The ingest thread is stopped by now
+    if (ctx_ && pacer_sub_ >= 0)
+        ctx_->changes.unsubscribe(pacer_sub_);
+    pacer_sub_ = -1;
+    g_input_pacer = nullptr;
+
     // Cleanup components
     market_data_table_.reset();
     navigator_.reset();
+    diagnostics_.reset();
+    profiler_window_.reset();
 
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
@@ -8,23 +8,44 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
+#include "DiagnosticsWindow.h"
 #include "MarketDataTable.h"
 #include "Navigator.h"
+#include "ProfilerWindow.h"
 
 // Forward declarations
+struct FramePacer;
 struct HostContext;
 struct HostMDSlot;
 
 class ImGuiComponents {
   public:
     void Init(GLFWwindow* window, const char* glsl_version);
+    // Sizes the views and subscribes them to ctx.changes; call before the ingest thread starts.
+    // With a pacer, input and new views are reported to it (see FramePacer).
+    void Attach(HostContext& ctx, const HostMDSlot& slot, FramePacer* pacer = nullptr);
+    // Per ingest cycle time for table sorts, filter passes and regroups; before Attach
+    void SetWorkBudget(uint32_t budget_us);
+    // File the Latency window's Dump button writes, empty = latency_report.txt
+    void SetLatencyReportPath(const std::string& path);
+    // File the Profiler window's Export button writes, empty = profile_trace.json
+    void SetTracePath(const std::string& path);
     void NewFrame();
-    void Update(HostContext& ctx, const HostMDSlot& slot, uint64_t& next_paint_ms);
+    void Update(HostContext& ctx, const HostMDSlot& slot);
     void Render();
+    // After the buffer swap: times the ticks of newly drawn views to the screen
+    void FramePresented(HostContext& ctx);
     void Shutdown();
 
   private:
     std::unique_ptr<MarketDataTable> market_data_table_;
     std::unique_ptr<Navigator> navigator_;
+    std::unique_ptr<DiagnosticsWindow> diagnostics_;
+    std::unique_ptr<ProfilerWindow> profiler_window_;
+    HostContext* ctx_ = nullptr;
+    int32_t pacer_sub_ = -1;  // ctx_->changes listener feeding the pacer
+    uint64_t views_seen_ = 0;  // table views already reported to the pacer (ingest thread)
+    uint32_t work_seen_ = 0;   // table work progress already reported to the pacer
 };
\ No newline at end of file
@@ -7,21 +7,29 @@
 #include <map>
 
 MarketDataTable::MarketDataTable()
-    : num_rows_(0), last_selected_row_(-1), filters_dirty_(true), groups_dirty_(true) {
-    // Initialize all column filters
-    // Performance critical: initialization loop for column filters
-    for (int i = 0; i < 5; i++) {
-        column_filters_[i] = ColumnFilter{};
-    }
+    : num_rows_(0), filters_dirty_(true), groups_dirty_(true), last_selected_row_(-1) {
 }
 
-MarketDataTable::~MarketDataTable() {}
+MarketDataTable::~MarketDataTable() {
+    if (subscribed_ctx_)
+        subscribed_ctx_->changes.unsubscribe(change_sub_);
+}
 
-void MarketDataTable::Initialize(uint32_t max_rows) {
+void MarketDataTable::Initialize(uint32_t max_rows, Arena* arena) {
     num_rows_ = max_rows;
-    // Pre-allocate index vectors (much smaller than data)
+    // Pre-allocate index vectors (much smaller than data), sized once so filtering never
+    // reallocates
+    all_row_indices_ = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena, "table indices"));
+    filtered_indices_ = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena, "table indices"));
     all_row_indices_.reserve(max_rows);
     filtered_indices_.reserve(max_rows);
+    passes_ = ArenaVector<uint8_t>(max_rows, 0, ArenaAllocator<uint8_t>(arena, "table indices"));
+    recheck_rows_ = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena, "table indices"));
+    recheck_rows_.reserve(max_rows);
+    resort_rows_ = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena, "table indices"));
+    resort_rows_.reserve(max_rows);
+    resort_mark_ =
+        ArenaVector<uint8_t>(max_rows, 0, ArenaAllocator<uint8_t>(arena, "table indices"));
 
     // Initialize all row indices (0, 1, 2, ..., max_rows-1)
     all_row_indices_.clear();
@@ -31,38 +39,14 @@ void MarketDataTable::Initialize(uint32_t max_rows) {
     }
 }
 
-void MarketDataTable::UpdateFromContext(HostContext& ctx, const HostMDSlot& slot,
-                                        bool should_refresh) {
-    // Process dirty queue - no copying, just queue management
-    uint32_t id;
-    // Performance critical: tight loop processing queued UI updates
-    while (ctx.q.pop(id)) {
-        if (id < ctx.num_rows) {
-            ctx.dirty[id] = 1;
-        }
-    }
-
-    if (!should_refresh)
+void MarketDataTable::Subscribe(HostContext& ctx, const HostMDSlot& slot) {
+    if (subscribed_ctx_ == &ctx)
         return;
-
-    // Update snapshots in-place within the context (no copying to our data)
-    // Performance critical: bulk processing all dirty rows for UI refresh
-    for (uint32_t i = 0; i < ctx.num_rows; ++i) {
-        if (ctx.dirty[i]) {
-            ctx.dirty[i] = 0;
-            HostContext::RowSnap tmp{};
-            bool ok = false;
-            // Performance critical: retry loop for consistent row snapshot
-            for (int tries = 0; tries < 2 && !ok; ++tries) {
-                ok = row_snapshot(&ctx, &slot, i, tmp);
-            }
-            if (ok) {
-                if (std::memcmp(&tmp, &ctx.last[i], sizeof(tmp)) != 0) {
-                    ctx.last[i] = tmp;  // Update in place in the context
-                }
-            }
-        }
-    }
+    if (subscribed_ctx_)
+        subscribed_ctx_->changes.unsubscribe(change_sub_);
+    subscribed_ctx_ = &ctx;
+    slot_ = &slot;
+    change_sub_ = ctx.changes.subscribe([this](const ChangeSet& changes) { OnChangeSet(changes); });
 
     // Update our index count if context changed
     if (ctx.num_rows != num_rows_) {
@@ -72,11 +56,171 @@ void MarketDataTable::UpdateFromContext(HostContext& ctx, const HostMDSlot& slot
         for (uint32_t i = 0; i < num_rows_; ++i) {
             all_row_indices_.push_back(i);
         }
+        passes_.assign(num_rows_, 0);
+        resort_rows_.clear();
+        resort_mark_.assign(num_rows_, 0);
+        filters_dirty_ = true;
+        groups_dirty_ = true;
+        sort_dirty_ = true;
+    }
+}
+
+void MarketDataTable::OnChangeSet(const ChangeSet& changes) {
+    PROFILE_SCOPE("table update");
+    TakeSettings();
+    // Performance critical: O(changed rows), each row routed by its changed columns
+    for (size_t k = 0; k < changes.size(); ++k)
+        NoteRowChanged(changes.ids[k], changes.cols[k]);
+    if (subscribed_ctx_->latency.on()) {
+        const size_t take = std::min(changes.size(), kViewTicks - pending_ticks_.size());
+        // Performance critical: bounded copy of the tick stamps for the view and pixel stages
+        for (size_t k = 0; k < take; ++k)
+            pending_ticks_.push_back(changes.after[k].ts);
     }
 
-    // Mark filters and groups as dirty since data may have changed
-    filters_dirty_ = true;
+    // While the render thread has not taken the last view, changes only accumulate: the
+    // stages below then run at most once per drawn frame, however fast cycles come
+    if (view_slot_.fresh())
+        return;
+    UpdateView(changes);
+}
+
+// Picks up settings the render thread published since the last cycle
+void MarketDataTable::TakeSettings() {
+    if (!settings_slot_.fresh())
+        return;
+    const TableSettings& settings = settings_slot_.read();
+    if (settings.filters_gen != applied_.filters_gen) {
+        filters_dirty_ = true;
+        filter_running_ = false;  // a pass in progress tests the old filters
+    }
+    if (settings.group_gen != applied_.group_gen) {
+        RestartGroups();
+        if (settings.group_by_column < 0)
+            groups_.clear();
+    }
+    if (settings.sort_gen != applied_.sort_gen)
+        sort_dirty_ = true;
+    applied_ = settings;
+    view_dirty_ = true;
+}
+
+void MarketDataTable::UpdateView(const ChangeSet& changes) {
+    HostContext& ctx = *subscribed_ctx_;
+    const HostMDSlot& slot = *slot_;
+    // Stages run in order within this cycle's budget; one left unfinished keeps the later
+    // ones and the publish for the next cycle, and the render thread keeps the last view
+    WorkBudget budget(work_budget_us_);
+    if (!ApplySort(ctx, slot, budget) || !ApplyFilters(ctx, slot, budget))
+        return;
+    if (applied_.group_by_column >= 0 && !ApplyGrouping(ctx, slot, budget))
+        return;
+    ReportWork(ViewWork::Idle, 0);
+    if (view_dirty_)
+        PublishView(changes);
+}
+
+void MarketDataTable::ReportWork(ViewWork stage, uint32_t permille) {
+    work_state_.store((uint32_t)stage << 16 | std::min(permille, 1000u),
+                      std::memory_order_relaxed);
+}
+
+// Groups must be rebuilt from scratch: a build in progress is for stale rows or settings
+void MarketDataTable::RestartGroups() {
     groups_dirty_ = true;
+    group_running_ = false;
+    agg_running_ = false;
+}
+
+// Copies the finished state into the buffer the render thread will take next. Runs only
+// when the view changed and the previous one was taken, so at most once per frame.
+void MarketDataTable::PublishView(const ChangeSet& changes) {
+    PROFILE_SCOPE("table publish");
+    TableView& view = view_slot_.back();
+    const ArenaVector<uint32_t>& rows =
+        AnyFilterEnabled(applied_) ? filtered_indices_ : all_row_indices_;
+    view.rows.assign(rows.begin(), rows.end());
+    view.groups = groups_;
+    view.group_by_column = applied_.group_by_column;
+    view.settings_gen = applied_.filters_gen + applied_.group_gen + applied_.sort_gen;
+    view.cycle = changes.cycle;
+    view.epoch = changes.epoch;
+    // The ticks travel with the view so the render thread can time them to the screen
+    LatencyRecorder& latency = subscribed_ctx_->latency;
+    const int64_t now = LatencyRecorder::now_ns();
+    // Performance critical: at most kViewTicks samples per view
+    for (int64_t ts : pending_ticks_)
+        latency.record(TickStage::View, ts, now);
+    view.ticks.swap(pending_ticks_);
+    pending_ticks_.clear();  // the buffer the old view carried, capacity kept
+    view_slot_.publish();
+    view_dirty_ = false;
+}
+
+// Render thread: hands the edited settings to the ingest thread
+void MarketDataTable::PublishSettings() {
+    settings_slot_.back() = settings_;
+    settings_slot_.publish();
+}
+
+// RowColumn bit a table column depends on; the ID column never changes
+uint8_t MarketDataTable::ColumnBit(int column) {
+    switch (column) {
+    case 1:
+        return RowColTs;
+    case 2:
+        return RowColPx;
+    case 3:
+        return RowColQty;
+    case 4:
+        return RowColSide;
+    default:
+        return 0;
+    }
+}
+
+uint8_t MarketDataTable::FilterColumns() const {
+    uint8_t cols = 0;
+    // Performance critical: five columns
+    for (int i = 0; i < 5; i++) {
+        if (applied_.filters[i].enabled)
+            cols |= ColumnBit(i);
+    }
+    return cols;
+}
+
+// Routes one changed row to the stages that read its changed columns: the filters recheck
+// the row, groups regroup when the key column moved and only re-aggregate otherwise
+// (the aggregates read ts, px and qty).
+uint8_t MarketDataTable::SortColumns() const {
+    uint8_t cols = 0;
+    // Performance critical: at most five keys
+    for (int n = 0; n < applied_.sort_count; n++)
+        cols |= ColumnBit(applied_.sort[n].column);
+    return cols;
+}
+
+void MarketDataTable::NoteRowChanged(uint32_t row_index, uint8_t cols) {
+    // Also while a full sort runs: it may have read the row before the change
+    if ((cols & SortColumns()) && !resort_mark_[row_index]) {
+        resort_mark_[row_index] = 1;
+        resort_rows_.push_back(row_index);  // Performance critical: reserved up front
+    }
+    // While a full pass is in progress the rows it already tested are rechecked after it
+    if ((!filters_dirty_ || filter_running_) && (cols & FilterColumns())) {
+        if (recheck_rows_.size() < passes_.size()) {
+            recheck_rows_.push_back(row_index);  // Performance critical: reserved up front
+        } else {
+            filters_dirty_ = true;  // more rechecks than rows, a full pass is cheaper
+            filter_running_ = false;
+        }
+    }
+    if (applied_.group_by_column >= 0) {
+        if (cols & ColumnBit(applied_.group_by_column))
+            groups_dirty_ = true;
+        else if (cols & (RowColTs | RowColPx | RowColQty))
+            aggregates_dirty_ = true;
+    }
 }
 
 bool MarketDataTable::IsRowSelected(uint32_t row_id) {
@@ -96,8 +240,10 @@ void MarketDataTable::ToggleRowSelection(uint32_t row_id) {
 void MarketDataTable::SelectRowRange(int start_row, int end_row) {
     if (start_row > end_row)
         std::swap(start_row, end_row);
+    if (!view_)
+        return;
 
-    auto& display_indices = HasActiveFilters() ? filtered_indices_ : all_row_indices_;
+    const std::vector<uint32_t>& display_indices = view_->rows;
     // Performance critical: loop over row range for multi-selection
     for (int row = start_row; row <= end_row; row++) {
         if (row >= 0 && row < (int)display_indices.size()) {
@@ -120,33 +266,56 @@ void MarketDataTable::Render(HostContext& ctx, const HostMDSlot& slot) {
         return;
     }
 
-    // Apply filters if needed
-    ApplyFilters(ctx, slot);
-
-    // Apply grouping if needed
-    if (HasActiveGrouping()) {
-        ApplyGrouping(ctx, slot);
-    }
+    // Filtering, sorting and grouping were done by the ingest thread; take its latest view.
+    // Row values come from a snapshot pinned for this frame, which never holds the
+    // publisher back and is at least as new as the view.
+    view_ = &LatestView();
+    ctx.published.snapshot(snap_);
 
     RenderSelectionInfo();
     ImGui::Separator();
 
-    // Render appropriate table based on grouping state
-    if (HasActiveGrouping()) {
+    // Render appropriate table based on grouping state; until the ingest thread has
+    // grouped (or ungrouped) the rows the previous layout stays up
+    if (view_->group_by_column >= 0) {
         RenderGroupedTable(ctx, slot);
     } else {
         RenderTable(ctx, slot);
     }
 
+    snap_.release();
     ImGui::End();
 }
 
+void MarketDataTable::FramePresented(LatencyRecorder& latency) {
+    if (!view_ || view_->cycle == presented_cycle_)
+        return;
+    presented_cycle_ = view_->cycle;
+    const int64_t now = LatencyRecorder::now_ns();
+    // Performance critical: at most kViewTicks samples, once per view
+    for (int64_t ts : view_->ticks)
+        latency.record(TickStage::Pixel, ts, now);
+}
+
 void MarketDataTable::RenderSelectionInfo() {
     ImGui::Text("Total Rows: %d", (int)num_rows_);
+
+    // A sort, filter or regroup still running on the ingest thread; the view below is the
+    // last complete one
+    const uint32_t work = WorkState();
+    if ((work >> 16) != (uint32_t)ViewWork::Idle) {
+        const char* stage_names[] = {"", "Sorting", "Filtering", "Grouping", "Aggregating"};
+        const uint32_t permille = work & 0xffff;
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), "%s %u%%", stage_names[(work >> 16) % 5],
+                 permille / 10);
+        ImGui::SameLine();
+        ImGui::ProgressBar(permille / 1000.0f, ImVec2(160.0f, 0.0f), overlay);
+    }
     if (HasActiveFilters()) {
         ImGui::SameLine();
         ImVec4 filterColor = ImVec4(0.0f, 0.7f, 1.0f, 1.0f);
-        ImGui::TextColored(filterColor, "(Filtered: %d)", (int)filtered_indices_.size());
+        ImGui::TextColored(filterColor, "(Filtered: %d)", (int)view_->rows.size());
         ImGui::SameLine();
         if (ImGui::SmallButton("Clear Filters")) {
             ClearAllFilters();
@@ -161,7 +330,7 @@ void MarketDataTable::RenderSelectionInfo() {
     if (HasActiveGrouping()) {
         const char* column_names[] = {"ID", "Timestamp", "Price", "Quantity", "Side"};
         ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Grouped by: %s",
-                           column_names[group_by_column_]);
+                           column_names[settings_.group_by_column]);
         ImGui::SameLine();
         if (ImGui::SmallButton("Clear Grouping")) {
             ClearGrouping();
@@ -208,8 +377,11 @@ void MarketDataTable::RenderSelectionInfo() {
 }
 
 void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
-    // Use filtered indices for display - NO COPYING OF DATA!
-    auto& display_indices = HasActiveFilters() ? filtered_indices_ : all_row_indices_;
+    PROFILE_SCOPE("RenderTable");
+    (void)ctx;
+    // Filtered rows in sort order, straight from the view - NO COPYING OF DATA!
+    const std::vector<uint32_t>& display_indices = view_->rows;
+    bool filters_edited = false;
 
     // Market data table with virtualization for large datasets
     ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
@@ -235,7 +407,7 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
             ImGui::TableSetColumnIndex(column);
             ImGui::PushID(column);
 
-            ColumnFilter& filter = column_filters_[column];
+            ColumnFilter& filter = settings_.filters[column];
 
             // Create unique IDs for each filter control
             char filter_id[64];
@@ -252,7 +424,7 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
                     filter.numeric_value = strtoll(input_buffer, nullptr, 10);
                     filter.type = FILTER_NUMERIC_EQUALS;
                     filter.enabled = (filter.numeric_value != 0);
-                    filters_dirty_ = true;
+                    filters_edited = true;
                 }
 
                 // Right-click context menu for filter type
@@ -264,23 +436,23 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
                     if (ImGui::MenuItem("Equals", nullptr, filter.type == FILTER_NUMERIC_EQUALS)) {
                         filter.type = FILTER_NUMERIC_EQUALS;
                         filter.enabled = true;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     if (ImGui::MenuItem("Greater than", nullptr,
                                         filter.type == FILTER_NUMERIC_GREATER)) {
                         filter.type = FILTER_NUMERIC_GREATER;
                         filter.enabled = true;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     if (ImGui::MenuItem("Less than", nullptr, filter.type == FILTER_NUMERIC_LESS)) {
                         filter.type = FILTER_NUMERIC_LESS;
                         filter.enabled = true;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     if (ImGui::MenuItem("Clear", nullptr, !filter.enabled)) {
                         filter.enabled = false;
                         filter.type = FILTER_NONE;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     ImGui::EndPopup();
                 }
@@ -292,7 +464,7 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
                                      ImGuiInputTextFlags_EnterReturnsTrue)) {
                     filter.type = FILTER_TEXT_CONTAINS;
                     filter.enabled = (strlen(filter.text_value) > 0);
-                    filters_dirty_ = true;
+                    filters_edited = true;
                 }
 
                 if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
@@ -303,17 +475,17 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
                     if (ImGui::MenuItem("Contains", nullptr, filter.type == FILTER_TEXT_CONTAINS)) {
                         filter.type = FILTER_TEXT_CONTAINS;
                         filter.enabled = true;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     if (ImGui::MenuItem("Equals", nullptr, filter.type == FILTER_TEXT_EQUALS)) {
                         filter.type = FILTER_TEXT_EQUALS;
                         filter.enabled = true;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     if (ImGui::MenuItem("Clear", nullptr, !filter.enabled)) {
                         filter.enabled = false;
                         filter.type = FILTER_NONE;
-                        filters_dirty_ = true;
+                        filters_edited = true;
                     }
                     ImGui::EndPopup();
                 }
@@ -323,34 +495,23 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
             ImGui::PopID();
         }
 
-        // Handle sorting - sort indices based on values from raw memory
+        if (filters_edited) {
+            ++settings_.filters_gen;
+            PublishSettings();
+        }
+
+        // Sorting runs on the ingest thread; hand it the header's sort keys
         if (ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs()) {
             if (sort_specs->SpecsDirty) {
-                if (display_indices.size() > 1) {
-                    std::sort(
-                        display_indices.begin(), display_indices.end(),
-                        [&](uint32_t a_index, uint32_t b_index) {
-                            // Performance critical: multi-column sort comparison loop
-                            for (int n = 0; n < sort_specs->SpecsCount; n++) {
-                                const ImGuiTableColumnSortSpecs* sort_spec = &sort_specs->Specs[n];
-
-                                int64_t a_val =
-                                    GetColumnValue(a_index, sort_spec->ColumnIndex, ctx, slot);
-                                int64_t b_val =
-                                    GetColumnValue(b_index, sort_spec->ColumnIndex, ctx, slot);
-
-                                int delta = (a_val < b_val) ? -1 : (a_val > b_val) ? 1 : 0;
-
-                                if (delta != 0) {
-                                    return (sort_spec->SortDirection ==
-                                            ImGuiSortDirection_Ascending)
-                                               ? (delta < 0)
-                                               : (delta > 0);
-                                }
-                            }
-                            return false;
-                        });
+                SortKey keys[5];
+                const int count = std::min(sort_specs->SpecsCount, 5);
+                // Performance critical: at most five sort keys
+                for (int n = 0; n < count; n++) {
+                    keys[n].column = sort_specs->Specs[n].ColumnIndex;
+                    keys[n].ascending =
+                        sort_specs->Specs[n].SortDirection == ImGuiSortDirection_Ascending;
                 }
+                SetSort(keys, count);
                 sort_specs->SpecsDirty = false;
             }
         }
@@ -364,7 +525,9 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
             // Performance critical: render only visible rows for performance
             for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
                 uint32_t row_index = display_indices[row];
-                const HostContext::RowSnap& snap = ctx.last[row_index];
+                if (row_index >= snap_.num_rows)
+                    continue;
+                const HostContext::RowSnap snap = snap_.row(row_index);
                 bool is_selected = IsRowSelected(row_index);
 
                 ImGui::TableNextRow();
@@ -419,60 +582,217 @@ void MarketDataTable::RenderTable(HostContext& ctx, const HostMDSlot& slot) {
 }
 
 // Filter management methods
+// Filter management methods - render thread, applied by the ingest thread
 void MarketDataTable::ClearAllFilters() {
     // Performance critical: filter clearing loop for all columns
     for (int i = 0; i < 5; i++) {
-        column_filters_[i] = ColumnFilter{};
+        settings_.filters[i] = ColumnFilter{};
     }
-    filters_dirty_ = true;
+    ++settings_.filters_gen;
+    PublishSettings();
 }
 
 void MarketDataTable::SetColumnFilter(int column, const ColumnFilter& filter) {
     if (column >= 0 && column < 5) {
-        column_filters_[column] = filter;
-        filters_dirty_ = true;
+        settings_.filters[column] = filter;
+        ++settings_.filters_gen;
+        PublishSettings();
     }
 }
 
 bool MarketDataTable::HasActiveFilters() const {
+    return AnyFilterEnabled(settings_);
+}
+
+bool MarketDataTable::AnyFilterEnabled(const TableSettings& settings) {
     // Performance critical: filter checking loop for all columns
     for (int i = 0; i < 5; i++) {
-        if (column_filters_[i].enabled) {
+        if (settings.filters[i].enabled) {
             return true;
         }
     }
     return false;
 }
 
-// Filter management methods - work with indices only
-void MarketDataTable::ApplyFilters(HostContext& ctx, const HostMDSlot& slot) {
-    if (!filters_dirty_)
+// Orders all_row_indices_ by the applied sort keys; the filtered rows follow the new order.
+// New keys, or too many moved rows for a merge, take a full sort in budgeted slices;
+// otherwise only the rows whose keys changed move, see ReinsertChangedRows. While a filter
+// pass walks all_row_indices_ the moved rows wait for it: a row moving past its cursor
+// would shift another one back over it, and that row would keep its old result.
+bool MarketDataTable::ApplySort(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget) {
+    PROFILE_SCOPE("ApplySort");
+    const bool resort_all = !sort_running_ && !filter_running_ &&
+                            resort_rows_.size() > all_row_indices_.size() / kFullResortDivisor;
+    if (sort_dirty_ || resort_all) {
+        // New keys: (re)start the sort. The filter pass and group build walk this array,
+        // so whatever of them was in progress starts over once the sort is done.
+        sort_dirty_ = false;
+        ClearResortRows();  // the sort reads every key afresh
+        sort_running_ = applied_.sort_count > 0 && all_row_indices_.size() > 1;
+        if (sort_running_)
+            sorter_.start(all_row_indices_.size());
+        filter_running_ = false;
+        RestartGroups();
+    } else if (!sort_running_) {
+        if (!filter_running_)
+            ReinsertChangedRows(ctx, slot);
+        return true;
+    }
+
+    if (sort_running_) {
+        // Keys are read once per row, when the sorter captures it; rows changing after that
+        // are in resort_rows_ and re-placed below once the sort is done
+        auto key_of = [&](uint32_t row_index) {
+            RowSortKeys keys{};
+            // Performance critical: at most five keys per row
+            for (int n = 0; n < applied_.sort_count; n++)
+                keys.v[n] = GetColumnValue(row_index, applied_.sort[n].column, ctx, slot);
+            return keys;
+        };
+        auto less = [&](const RowSortKeys& a, const RowSortKeys& b) {
+            // Performance critical: multi-column sort comparison loop
+            for (int n = 0; n < applied_.sort_count; n++) {
+                if (a.v[n] != b.v[n])
+                    return applied_.sort[n].ascending ? a.v[n] < b.v[n] : a.v[n] > b.v[n];
+            }
+            return false;
+        };
+        if (!sorter_.step(all_row_indices_.data(), key_of, less, budget)) {
+            ReportWork(ViewWork::Sort, sorter_.permille());
+            return false;
+        }
+        sort_running_ = false;
+    }
+    order_dirty_ = true;
+    RestartGroups();
+    view_dirty_ = true;
+    // Rows that changed after their keys were captured are placed by their old keys
+    ReinsertChangedRows(ctx, slot);
+    return true;
+}
+
+bool MarketDataTable::SortsBefore(uint32_t a_index, uint32_t b_index, HostContext& ctx,
+                                  const HostMDSlot& slot) const {
+    // Performance critical: multi-column sort comparison loop
+    for (int n = 0; n < applied_.sort_count; n++) {
+        const SortKey& key = applied_.sort[n];
+        int64_t a_val = GetColumnValue(a_index, key.column, ctx, slot);
+        int64_t b_val = GetColumnValue(b_index, key.column, ctx, slot);
+        if (a_val != b_val)
+            return key.ascending ? a_val < b_val : a_val > b_val;
+    }
+    return false;
+}
+
+// Live order between full sorts: the rows whose sort keys changed are taken out and merged
+// back by binary search, O(k log n) comparisons for k rows. Membership does not change, so
+// groups keep their rows (and their order) until they are rebuilt for another reason.
+void MarketDataTable::ReinsertChangedRows(HostContext& ctx, const HostMDSlot& slot) {
+    if (resort_rows_.empty())
         return;
+    if (applied_.sort_count == 0) {
+        ClearResortRows();
+        return;
+    }
+    PROFILE_SCOPE("ReinsertChangedRows");
+    reinsert_changed(all_row_indices_.data(), all_row_indices_.size(), resort_rows_.data(),
+                     resort_rows_.size(), resort_mark_.data(),
+                     [&](uint32_t a_index, uint32_t b_index) {
+                         return SortsBefore(a_index, b_index, ctx, slot);
+                     });
+    resort_rows_.clear();
+    order_moved_ = true;
+    view_dirty_ = true;
+}
 
-    filtered_indices_.clear();
+void MarketDataTable::ClearResortRows() {
+    // Performance critical: the listed rows only
+    for (uint32_t row_index : resort_rows_)
+        resort_mark_[row_index] = 0;
+    resort_rows_.clear();
+}
 
-    if (!HasActiveFilters()) {
-        // No filters, use all indices
-        filtered_indices_ = all_row_indices_;
-    } else {
-        // Apply filters by testing each row index
+// Filtering - ingest thread, works with indices only
+bool MarketDataTable::ApplyFilters(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget) {
+    PROFILE_SCOPE("ApplyFilters");
+    if (!filters_dirty_) {
+        RecheckChangedRows(ctx, slot);
+        return true;
+    }
+
+    if (!filter_running_) {
+        filter_running_ = true;
+        filter_pos_ = 0;
+        filtered_indices_.clear();
+        recheck_rows_.clear();
+        order_dirty_ = false;
+        order_moved_ = false;
+    }
+
+    if (AnyFilterEnabled(applied_)) {
+        // Apply filters by testing each row index, from where the last slice stopped
         // Performance critical: filtering loop over all rows
-        for (uint32_t row_index : all_row_indices_) {
-            if (PassesFilter(row_index, ctx, slot)) {
+        for (; filter_pos_ < all_row_indices_.size(); ++filter_pos_) {
+            if (!budget.spend(1)) {
+                ReportWork(ViewWork::Filter,
+                           (uint32_t)(filter_pos_ * 1000 / all_row_indices_.size()));
+                return false;
+            }
+            const uint32_t row_index = all_row_indices_[filter_pos_];
+            const bool pass = PassesFilter(row_index, ctx, slot);
+            passes_[row_index] = pass ? 1 : 0;
+            if (pass) {
                 filtered_indices_.push_back(row_index);
             }
         }
     }
+    // else: no filters, the view uses all_row_indices_ as is
 
+    filter_running_ = false;
     filters_dirty_ = false;
+    RestartGroups();
+    view_dirty_ = true;
+    // Rows whose sort keys moved while the pass ran, then rows that changed after it
+    // tested them
+    ReinsertChangedRows(ctx, slot);
+    RecheckChangedRows(ctx, slot);
+    return true;
+}
+
+// Only rows whose filtered columns changed are tested again; the filtered rows are rebuilt
+// from the cached results when one of them crossed the filter or the order changed
+void MarketDataTable::RecheckChangedRows(HostContext& ctx, const HostMDSlot& slot) {
+    bool flipped = order_dirty_;
+    const bool moved = order_moved_;
+    order_dirty_ = false;
+    order_moved_ = false;
+    // Performance critical: recheck of changed rows only
+    for (uint32_t row_index : recheck_rows_) {
+        const uint8_t pass = PassesFilter(row_index, ctx, slot) ? 1 : 0;
+        flipped |= pass != passes_[row_index];
+        passes_[row_index] = pass;
+    }
+    recheck_rows_.clear();
+    if (!(flipped || moved) || !AnyFilterEnabled(applied_))
+        return;
+    filtered_indices_.clear();
+    // Performance critical: rebuild from cached results, no filter evaluation
+    for (uint32_t row_index : all_row_indices_) {
+        if (passes_[row_index])
+            filtered_indices_.push_back(row_index);
+    }
+    // Reinserted rows only move; groups keep their members until rebuilt anyway
+    if (flipped)
+        groups_dirty_ = true;
+    view_dirty_ = true;
 }
 
 bool MarketDataTable::PassesFilter(uint32_t row_index, HostContext& ctx,
                                    const HostMDSlot& slot) const {
     // Performance critical: filter validation loop for all columns
     for (int i = 0; i < 5; i++) {
-        if (column_filters_[i].enabled) {
-            if (!PassesColumnFilter(row_index, i, column_filters_[i], ctx, slot)) {
+        if (applied_.filters[i].enabled) {
+            if (!PassesColumnFilter(row_index, i, applied_.filters[i], ctx, slot)) {
                 return false;
             }
         }
@@ -536,61 +856,129 @@ bool MarketDataTable::PassesColumnFilter(uint32_t row_index, int column, const C
     return true;
 }
 
-// Grouping management methods - simplified for now
+// Sort management - render thread, applied by the ingest thread
+void MarketDataTable::SetSort(const SortKey* keys, int count) {
+    settings_.sort_count = std::max(0, std::min(count, 5));
+    // Performance critical: at most five sort keys
+    for (int n = 0; n < settings_.sort_count; n++)
+        settings_.sort[n] = keys[n];
+    ++settings_.sort_gen;
+    PublishSettings();
+}
+
+// Grouping management methods - render thread, applied by the ingest thread
 void MarketDataTable::SetGroupByColumn(int column) {
     if (column >= 0 && column < 5) {
-        group_by_column_ = column;
-        groups_dirty_ = true;
+        settings_.group_by_column = column;
+        ++settings_.group_gen;
+        PublishSettings();
     }
 }
 
 void MarketDataTable::ClearGrouping() {
-    group_by_column_ = -1;
-    groups_.clear();
-    groups_dirty_ = true;
+    settings_.group_by_column = -1;
+    ++settings_.group_gen;
+    PublishSettings();
 }
 
-void MarketDataTable::ApplyGrouping(HostContext& ctx, const HostMDSlot& slot) {
-    if (!groups_dirty_ || group_by_column_ < 0)
-        return;
+bool MarketDataTable::ApplyGrouping(HostContext& ctx, const HostMDSlot& slot,
+                                    WorkBudget& budget) {
+    PROFILE_SCOPE("ApplyGrouping");
+    if (applied_.group_by_column < 0)
+        return true;
+
+    if (groups_dirty_ && !group_running_) {
+        // Build from the rows displayed now; rows changing their group meanwhile only mark
+        // the groups dirty again, for the build after this one
+        groups_dirty_ = false;
+        aggregates_dirty_ = false;
+        agg_running_ = false;
+        group_running_ = true;
+        const auto& display_indices =
+            AnyFilterEnabled(applied_) ? filtered_indices_ : all_row_indices_;
+        group_rows_.assign(display_indices.begin(), display_indices.end());
+        group_pos_ = 0;
+        group_map_.clear();
+        group_it_ = group_map_.end();
+        building_groups_.clear();
+    }
+    if (group_running_) {
+        if (!BuildGroups(ctx, slot, budget))
+            return false;
+        group_running_ = false;
+        view_dirty_ = true;
+        return true;
+    }
 
-    BuildGroups(ctx, slot);
-    groups_dirty_ = false;
+    if (aggregates_dirty_ && !agg_running_) {
+        // Same members, new values: sums only, no regrouping
+        aggregates_dirty_ = false;
+        agg_running_ = true;
+        agg_pos_ = 0;
+    }
+    if (agg_running_) {
+        // Performance critical: one pass over the grouped rows, a group per budget check
+        for (; agg_pos_ < groups_.size(); ++agg_pos_) {
+            if (!budget.spend((uint32_t)groups_[agg_pos_].row_indices.size())) {
+                ReportWork(ViewWork::Aggregate, (uint32_t)(agg_pos_ * 1000 / groups_.size()));
+                return false;
+            }
+            CalculateGroupAggregates(groups_[agg_pos_], ctx, slot);
+        }
+        agg_running_ = false;
+        view_dirty_ = true;
+    }
+    return true;
 }
 
-void MarketDataTable::BuildGroups(HostContext& ctx, const HostMDSlot& slot) {
-    groups_.clear();
-
-    auto& display_indices = HasActiveFilters() ? filtered_indices_ : all_row_indices_;
-
-    // Create a map to group rows by the selected column
-    std::map<std::string, std::vector<uint32_t>> group_map;
+// Buckets group_rows_ by key, then turns the buckets into groups with their aggregates;
+// both halves resume where the budget stopped them
+bool MarketDataTable::BuildGroups(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget) {
+    const size_t total = group_rows_.size();
 
     // Performance critical: grouping all displayed rows by column value
-    for (uint32_t row_index : display_indices) {
-        std::string group_key = GetGroupKey(row_index, group_by_column_, ctx, slot);
-        group_map[group_key].push_back(row_index);
+    for (; group_pos_ < total; ++group_pos_) {
+        if (!budget.spend(1)) {
+            ReportWork(ViewWork::Group, (uint32_t)(group_pos_ * 500 / total));
+            return false;
+        }
+        const uint32_t row_index = group_rows_[group_pos_];
+        std::string group_key = GetGroupKey(row_index, applied_.group_by_column, ctx, slot);
+        group_map_[group_key].push_back(row_index);
     }
 
-    // Convert map to vector of GroupInfo
-    groups_.reserve(group_map.size());
+    if (group_it_ == group_map_.end() && building_groups_.empty()) {
+        group_it_ = group_map_.begin();
+        building_groups_.reserve(group_map_.size());
+    }
+    // Map order is key order, so the groups come out sorted by key
     // Performance critical: converting group map to display vector
-    for (const auto& pair : group_map) {
+    for (; group_it_ != group_map_.end(); ++group_it_) {
+        if (!budget.spend((uint32_t)group_it_->second.size())) {
+            ReportWork(ViewWork::Group,
+                       500 + (uint32_t)(building_groups_.size() * 500 / group_map_.size()));
+            return false;
+        }
         GroupInfo group;
-        group.group_key = pair.first;
-        group.row_indices = pair.second;
-        group.row_count = (int)pair.second.size();
+        group.group_key = group_it_->first;
+        group.row_indices = std::move(group_it_->second);  // Performance critical: no copy
+        group.row_count = (int)group.row_indices.size();
 
         CalculateGroupAggregates(group, ctx, slot);
-        groups_.push_back(group);
+        building_groups_.push_back(std::move(group));  // Performance critical: reserved
     }
 
-    // Sort groups by group key
-    std::sort(groups_.begin(), groups_.end(),
-              [](const GroupInfo& a, const GroupInfo& b) { return a.group_key < b.group_key; });
+    groups_.swap(building_groups_);
+    building_groups_.clear();
+    group_map_.clear();
+    group_it_ = group_map_.end();
+    group_rows_.clear();
+    return true;
 }
 
 void MarketDataTable::RenderGroupedTable(HostContext& ctx, const HostMDSlot& slot) {
+    PROFILE_SCOPE("RenderGroupedTable");
+    (void)ctx;
     ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
                             ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY |
                             ImGuiTableFlags_SizingStretchProp;
@@ -607,18 +995,15 @@ void MarketDataTable::RenderGroupedTable(HostContext& ctx, const HostMDSlot& slo
 
         // Render grouped data
         // Performance critical: main loop for rendering grouped table
-        for (int group_index = 0; group_index < (int)groups_.size(); group_index++) {
-            GroupInfo& group = groups_[group_index];
-
-            // Render group header
-            RenderGroupHeader(group, group_index);
+        for (int group_index = 0; group_index < (int)view_->groups.size(); group_index++) {
+            const GroupInfo& group = view_->groups[group_index];
 
-            // Render group rows if not collapsed
-            if (!group.is_collapsed) {
+            // Render group header, then its rows unless collapsed
+            if (RenderGroupHeader(group, group_index)) {
                 // Performance critical: loop rendering all rows within group
                 for (int i = 0; i < (int)group.row_indices.size(); i++) {
                     uint32_t row_index = group.row_indices[i];
-                    RenderGroupRow(row_index, i, ctx, slot);
+                    RenderGroupRow(row_index, i, slot);
                 }
             }
         }
@@ -627,7 +1012,8 @@ void MarketDataTable::RenderGroupedTable(HostContext& ctx, const HostMDSlot& slo
     }
 }
 
-void MarketDataTable::RenderGroupHeader(const GroupInfo& group, int group_index) {
+// Returns whether the group is expanded; ImGui keeps the open state per header id
+bool MarketDataTable::RenderGroupHeader(const GroupInfo& group, int group_index) {
     ImGui::TableNextRow();
 
     // Set a subtle background color for the entire group header row
@@ -645,10 +1031,6 @@ void MarketDataTable::RenderGroupHeader(const GroupInfo& group, int group_index)
 
     bool header_open = ImGui::CollapsingHeader(group_header, ImGuiTreeNodeFlags_DefaultOpen);
 
-    // Toggle collapse state when header is clicked
-    GroupInfo& mutable_group = const_cast<GroupInfo&>(group);
-    mutable_group.is_collapsed = !header_open;
-
     ImGui::PopStyleColor(2);
 
     // Show aggregate information aligned with columns
@@ -666,11 +1048,14 @@ void MarketDataTable::RenderGroupHeader(const GroupInfo& group, int group_index)
 
     ImGui::TableSetColumnIndex(4);
     ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Count: %d", group.row_count);
+    return header_open;
 }
 
-void MarketDataTable::RenderGroupRow(uint32_t row_index, int display_row, HostContext& ctx,
+void MarketDataTable::RenderGroupRow(uint32_t row_index, int display_row,
                                      const HostMDSlot& slot) {
-    const HostContext::RowSnap& snap = ctx.last[row_index];
+    if (row_index >= snap_.num_rows)
+        return;
+    const HostContext::RowSnap snap = snap_.row(row_index);
     bool is_selected = IsRowSelected(row_index);
 
     ImGui::TableNextRow();
@@ -732,14 +1117,14 @@ std::string MarketDataTable::GetGroupKey(uint32_t row_index, int column, HostCon
 }
 
 void MarketDataTable::CalculateGroupAggregates(GroupInfo& group, HostContext& ctx,
-                                               const HostMDSlot& slot) const {
+                                               const HostMDSlot& /*slot*/) const {
     group.total_qty = 0;
     int64_t total_price = 0;
     int64_t total_timestamp = 0;
 
     for (uint32_t row_index : group.row_indices) {
         if (row_index < ctx.num_rows) {
-            const HostContext::RowSnap& snap = ctx.last[row_index];
+            const HostContext::RowSnap snap = ctx.published.row(row_index);
             group.total_qty += snap.qty;
             total_price += snap.px;
             total_timestamp += snap.ts;
@@ -756,7 +1141,7 @@ int64_t MarketDataTable::GetColumnValue(uint32_t row_index, int column, HostCont
     if (row_index >= ctx.num_rows)
         return 0;
 
-    const HostContext::RowSnap& snap = ctx.last[row_index];
+    const HostContext::RowSnap snap = ctx.published.row(row_index);
     switch (column) {
     case 0:
         return (int64_t)row_index;  // ID
@@ -777,7 +1162,7 @@ int64_t MarketDataTable::GetColumnValue(uint32_t row_index, int column, HostCont
 uint8_t MarketDataTable::GetSideValue(uint32_t row_index, const HostMDSlot& slot) const {
     if (row_index >= slot.num_rows)
         return 0;
-    return slot.side[row_index];  // Direct access - no snapshot needed since it's immutable
+    return *md_side(&slot, row_index);  // Direct access - no snapshot needed since it's immutable
 }
 
 // Utility functions
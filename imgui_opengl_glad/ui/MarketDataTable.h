@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "../core/incremental_sort.h"
 #include "../core/main_context.h"
+#include "../core/rcu_slot.h"
+#include "../core/work_budget.h"
 #include "imgui.h"
 
 // Filter types for different column types
@@ -26,7 +31,6 @@ enum FilterType {
 struct GroupInfo {
     std::string group_key;              // The value that defines this group
     std::vector<uint32_t> row_indices;  // Indices into the raw context data (NOT copied data)
-    bool is_collapsed = false;          // Whether this group is collapsed
 
     // Aggregate data for the group
     int64_t total_qty = 0;
@@ -49,24 +53,81 @@ struct ColumnFilter {
     int64_t range_max = 0;
 };
 
+// One key of the header sort, in priority order
+struct SortKey {
+    int column = 0;
+    bool ascending = true;
+};
+
+// Values of the sort keys of one row, in SortKey order, as a full sort captured them
+struct RowSortKeys {
+    int64_t v[5];
+};
+
+// What the table shows, edited on the render thread and applied by the ingest thread.
+// Each generation counter moves with every edit of its part.
+struct TableSettings {
+    ColumnFilter filters[5];  // One for each column (ID, TS, PX, QTY, SIDE)
+    int group_by_column = -1;
+    SortKey sort[5];
+    int sort_count = 0;
+    uint32_t filters_gen = 0;
+    uint32_t group_gen = 0;
+    uint32_t sort_gen = 0;
+};
+
+// Ready-to-draw result of the ingest thread: rows in display order and the groups with
+// their aggregates. Row values are read from the published rows at draw time.
+struct TableView {
+    std::vector<uint32_t> rows;     // Rows passing the filters, in sort order
+    std::vector<GroupInfo> groups;  // Grouped mode only
+    int group_by_column = -1;       // Grouping the groups were built for
+    uint32_t settings_gen = 0;      // Sum of the applied generations
+    uint64_t cycle = 0;             // Ingest cycle that produced it
+    uint64_t epoch = 0;             // Published epoch it was computed at
+    std::vector<int64_t> ticks;     // ts_ns of rows changed since the previous view, sampled
+};
+
+// Stage of the view work spread over several ingest cycles (see SetWorkBudget)
+enum class ViewWork : uint8_t { Idle, Sort, Filter, Group, Aggregate };
+
 // Instead of copying data, we work with indices into the raw data
 // No separate data structures - just views into the original memory
 
-// Enhanced MarketDataTable class with sorting, filtering, and grouping
+// Enhanced MarketDataTable class with sorting, filtering, and grouping.
+//
+// Split across two threads. The render thread draws and edits the settings; the ingest
+// thread (the ctx.changes listener) applies settings and change sets to the index arrays,
+// filters, sorts and groups, and hands the finished view back. Settings travel in an
+// RcuSlot one way and views in another, so neither thread waits for the other.
+// A full sort, filter pass or regroup runs in slices of work_budget_us per ingest cycle,
+// resuming where it stopped, so one edit on a large table never holds up the change sets;
+// the last complete view stays on screen, with a progress bar, until the new one is done.
+// Between full sorts the order stays live: rows whose sort keys changed are merged back
+// into place every cycle (reinsert_changed), O(k log n) for k changed rows.
 class MarketDataTable {
   public:
     MarketDataTable();
     ~MarketDataTable();
 
-    // Initialize the table
-    void Initialize(uint32_t max_rows);
+    // Initialize the table; the index arrays come from arena when it is active
+    void Initialize(uint32_t max_rows, Arena* arena = nullptr);
 
-    // Update data from HostContext - NO COPYING, just refresh views
-    void UpdateFromContext(HostContext& ctx, const HostMDSlot& slot, bool should_refresh);
+    // Subscribe to the change sets of ctx (once, before the ingest thread starts); the
+    // ingest stage then drives every update
+    void Subscribe(HostContext& ctx, const HostMDSlot& slot);
 
-    // Render the table window
+    // Ingest thread: apply pending settings and one ingest cycle, then publish the view
+    // once the render thread has taken the previous one - NO COPYING of row data
+    void OnChangeSet(const ChangeSet& changes);
+
+    // Render the table window from the latest published view (render thread)
     void Render(HostContext& ctx, const HostMDSlot& slot);
 
+    // Render thread, after the buffer swap: the ticks of a view drawn for the first time
+    // reached the screen (TickStage::Pixel)
+    void FramePresented(LatencyRecorder& latency);
+
     // Get selected row IDs
     const std::vector<uint32_t>& GetSelectedRowIds() const {
         return selected_row_ids_;
@@ -80,31 +141,101 @@ class MarketDataTable {
     void SetColumnFilter(int column, const ColumnFilter& filter);
     bool HasActiveFilters() const;
 
+    // Sort management: keys in priority order, at most five (the header sets them too)
+    void SetSort(const SortKey* keys, int count);
+
     // Grouping management
     void SetGroupByColumn(int column);
     void ClearGrouping();
     bool HasActiveGrouping() const {
-        return group_by_column_ >= 0;
+        return settings_.group_by_column >= 0;
     }
     int GetGroupByColumn() const {
-        return group_by_column_;
+        return settings_.group_by_column;
+    }
+
+    // Render thread: the newest published view, the one Render would draw now
+    const TableView& LatestView() {
+        return view_slot_.read();
+    }
+
+    // Views the ingest thread published so far: exact on the ingest thread (change-set
+    // listeners), a diagnostic estimate on the render thread
+    uint64_t ViewsPublished() const {
+        return view_slot_.published;
+    }
+
+    // Time the view work may take per ingest cycle, 0 = finish in one cycle. Before Subscribe.
+    void SetWorkBudget(uint32_t budget_us) {
+        work_budget_us_ = budget_us;
+    }
+
+    // Stage in progress and its completion in permille, packed as stage << 16 | permille
+    uint32_t WorkState() const {
+        return work_state_.load(std::memory_order_relaxed);
     }
 
   private:
-    // NO DATA STORAGE - we work directly with raw memory from HostContext
+    uint32_t num_rows_;                      // Total number of rows
+    HostContext* subscribed_ctx_ = nullptr;  // Context whose change sets we receive
+    const HostMDSlot* slot_ = nullptr;       // Its slot, for the immutable side column
+    int32_t change_sub_ = -1;                // Handle in subscribed_ctx_->changes
+
+    // Render thread: the settings being edited and the view being drawn
+    TableSettings settings_;
+    RcuSlot<TableSettings> settings_slot_;  // render -> ingest
+    RcuSlot<TableView> view_slot_;          // ingest -> render
+    const TableView* view_ = nullptr;       // view_slot_ front for the current Render
+    PublishedSnapshot snap_;                // row values for the current Render
+
+    // Ingest thread from here on.
+    // NO DATA STORAGE - we work directly with the published rows from HostContext
     // Only store indices and views, never copy the actual market data
-    std::vector<uint32_t> all_row_indices_;   // All valid row indices (0 to num_rows-1)
-    std::vector<uint32_t> filtered_indices_;  // Indices that pass filters
-    uint32_t num_rows_;                       // Total number of rows
+    TableSettings applied_;                   // Settings the state below was built for
+    ArenaVector<uint32_t> all_row_indices_;   // All valid row indices, in sort order
+    ArenaVector<uint32_t> filtered_indices_;  // Indices that pass filters, in sort order
+    bool sort_dirty_ = true;                  // Sort settings changed, order_ must be redone
+    bool order_dirty_ = false;                // Sort order changed, filtered rows follow it
+    bool order_moved_ = false;                // Changed rows moved, same membership
+    bool view_dirty_ = true;                  // Something to publish
 
     // Filtering state
-    ColumnFilter column_filters_[5];  // One for each column (ID, TS, PX, QTY, SIDE)
-    bool filters_dirty_ = true;       // Flag to rebuild filtered view
+    bool filters_dirty_ = true;           // Flag to rebuild filtered view
+    ArenaVector<uint8_t> passes_;         // Per-row result of the last full filter pass
+    ArenaVector<uint32_t> recheck_rows_;  // Changed rows whose filtered columns changed
 
     // Grouping state
-    int group_by_column_ = -1;       // Column to group by (-1 = no grouping)
     std::vector<GroupInfo> groups_;  // Group information
     bool groups_dirty_ = true;       // Flag to rebuild groups
+    bool aggregates_dirty_ = false;  // Group members unchanged, only their values moved
+
+    // Work in progress across ingest cycles, each resumed where the budget stopped it
+    uint32_t work_budget_us_ = 4000;
+    std::atomic<uint32_t> work_state_{0};  // WorkState(), for the render thread
+    IncrementalSort<uint32_t, RowSortKeys> sorter_;  // ApplySort, on all_row_indices_
+    bool sort_running_ = false;
+    // Rows whose sort keys changed since they were placed, each once (resort_mark_), merged
+    // back by ReinsertChangedRows; more than 1 in kFullResortDivisor of the rows and one
+    // full sort is cheaper
+    static constexpr size_t kFullResortDivisor = 8;
+    ArenaVector<uint32_t> resort_rows_;
+    ArenaVector<uint8_t> resort_mark_;
+    bool filter_running_ = false;  // full filter pass, next row at filter_pos_
+    size_t filter_pos_ = 0;
+    bool group_running_ = false;               // BuildGroups over group_rows_
+    std::vector<uint32_t> group_rows_;         // displayed rows as of the build start
+    size_t group_pos_ = 0;                     // next of group_rows_ to bucket
+    std::map<std::string, std::vector<uint32_t>> group_map_;
+    std::map<std::string, std::vector<uint32_t>>::iterator group_it_;  // next to aggregate
+    std::vector<GroupInfo> building_groups_;   // replaces groups_ once complete
+    bool agg_running_ = false;                 // aggregates pass, next group at agg_pos_
+    size_t agg_pos_ = 0;
+
+    // Tick-to-pixel latency: ts_ns of changed rows waiting for the next view, at most
+    // kViewTicks per view, and the last view whose ticks reached the screen (render thread)
+    static constexpr size_t kViewTicks = 4096;
+    std::vector<int64_t> pending_ticks_;
+    uint64_t presented_cycle_ = 0;
 
     // Selection state
     std::vector<uint32_t> selected_row_ids_;  // Store row IDs, not indices
@@ -116,25 +247,49 @@ class MarketDataTable {
     void SelectRowRange(int start_row, int end_row);
     void RenderTable(HostContext& ctx, const HostMDSlot& slot);
     void RenderSelectionInfo();
+    void PublishSettings();
+
+    // Ingest thread: settings, then the stages, then the handoff
+    void TakeSettings();
+    void UpdateView(const ChangeSet& changes);
+    void PublishView(const ChangeSet& changes);
+    void ReportWork(ViewWork stage, uint32_t permille);
+    void RestartGroups();
+
+    // Column-granular change tracking: only stages depending on a changed column rerun
+    static uint8_t ColumnBit(int column);
+    uint8_t FilterColumns() const;
+    uint8_t SortColumns() const;
+    void NoteRowChanged(uint32_t row_index, uint8_t cols);
+
+    // The stages below return false when the budget ran out first; they resume next cycle
+    // and the view is published only once all of them are done.
+    // Sorting - orders all_row_indices_ by the applied sort keys
+    bool ApplySort(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget);
+    bool SortsBefore(uint32_t a_index, uint32_t b_index, HostContext& ctx,
+                     const HostMDSlot& slot) const;
+    void ReinsertChangedRows(HostContext& ctx, const HostMDSlot& slot);
+    void ClearResortRows();
 
     // Filtering functions - work directly with context data
-    void ApplyFilters(HostContext& ctx, const HostMDSlot& slot);
+    static bool AnyFilterEnabled(const TableSettings& settings);
+    bool ApplyFilters(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget);
+    void RecheckChangedRows(HostContext& ctx, const HostMDSlot& slot);
     bool PassesFilter(uint32_t row_index, HostContext& ctx, const HostMDSlot& slot) const;
     bool PassesColumnFilter(uint32_t row_index, int column, const ColumnFilter& filter,
                             HostContext& ctx, const HostMDSlot& slot) const;
 
     // Grouping functions - work with indices only
-    void ApplyGrouping(HostContext& ctx, const HostMDSlot& slot);
-    void BuildGroups(HostContext& ctx, const HostMDSlot& slot);
+    bool ApplyGrouping(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget);
+    bool BuildGroups(HostContext& ctx, const HostMDSlot& slot, WorkBudget& budget);
     void RenderGroupedTable(HostContext& ctx, const HostMDSlot& slot);
-    void RenderGroupHeader(const GroupInfo& group, int group_index);
-    void RenderGroupRow(uint32_t row_index, int display_row, HostContext& ctx,
-                        const HostMDSlot& slot);
+    bool RenderGroupHeader(const GroupInfo& group, int group_index);
+    void RenderGroupRow(uint32_t row_index, int display_row, const HostMDSlot& slot);
     std::string GetGroupKey(uint32_t row_index, int column, HostContext& ctx,
                             const HostMDSlot& slot) const;
     void CalculateGroupAggregates(GroupInfo& group, HostContext& ctx, const HostMDSlot& slot) const;
 
-    // Utility functions to access raw data by index
+    // Utility functions to access raw data by index (ingest thread, the publisher)
     int64_t GetColumnValue(uint32_t row_index, int column, HostContext& ctx,
                            const HostMDSlot& slot) const;
     uint8_t GetSideValue(uint32_t row_index,
@@ -17,11 +17,22 @@ void Navigator::Initialize(uint32_t max_rows) {
     initialized_ = true;
 }
 
-void Navigator::Render(HostContext& ctx, const HostMDSlot& slot, MarketDataTable* table) {
+void Navigator::Subscribe(HostContext& ctx) {
+    if (subscribed_ctx_ == &ctx) return;
+    if (subscribed_ctx_)
+        subscribed_ctx_->changes.unsubscribe(change_sub_);
+    subscribed_ctx_ = &ctx;
+    seeded_ = false;
+    change_sub_ = ctx.changes.subscribe(
+        [this, &ctx](const ChangeSet& changes) { OnChangeSet(ctx, changes); });
+}
+
+void Navigator::Render(HostContext& ctx, const HostMDSlot& /*slot*/, MarketDataTable* table) {
     if (!initialized_) return;
-    
-    // Update statistics from current data
-    UpdateStatistics(ctx, slot);
+    PROFILE_SCOPE("Navigator draw");
+
+    // Totals as of the latest ingest cycle; nothing is computed on this thread
+    stats_ = stats_slot_.read();
     
     // Navigator Window (dockable)
     ImGui::Begin("Navigator");
@@ -29,10 +40,10 @@ void Navigator::Render(HostContext& ctx, const HostMDSlot& slot, MarketDataTable
     ImGui::TextColored(ImVec4(0.5f, 0.8f, 1.0f, 1.0f), "Market Data Navigator");
     ImGui::Separator();
     
-    RenderDataCategoriesTree(ctx, slot);
+    RenderDataCategoriesTree();
     ImGui::Spacing();
     
-    RenderStatisticsTree(ctx, slot);
+    RenderStatisticsTree(ctx);
     ImGui::Spacing();
     
     RenderQuickFiltersTree(table);
@@ -40,47 +51,81 @@ void Navigator::Render(HostContext& ctx, const HostMDSlot& slot, MarketDataTable
     ImGui::End(); // Navigator
 }
 
-void Navigator::UpdateStatistics(HostContext& ctx, const HostMDSlot& slot) {
-    stats_ = DataStats{}; // Reset
-    stats_.total_rows = slot.num_rows;
-    
-    int64_t total_price = 0;
-    uint32_t valid_prices = 0;
-    
-    // Performance critical: single-pass statistics aggregation over all market data rows
-    // This loop processes all rows once per render frame to calculate real-time statistics
-    for (uint32_t i = 0; i < slot.num_rows; ++i) {
-        // Count by side (per md_api.h: 0=unk, 1=bid, 2=ask, 3=trade)
-        uint8_t side = slot.side[i];
-        switch (side) {
-            case 0: stats_.unknown_count++; break;
-            case 1: stats_.buy_count++; break;
-            case 2: stats_.sell_count++; break;
-            case 3: stats_.trade_count++; break;
-            default: break;  // Invalid side value
-        }
-        
-        // Sum quantities
-        stats_.total_quantity += slot.qty[i];
-        
-        // Calculate average price
-        if (slot.px_n[i] > 0) {
-            total_price += slot.px_n[i];
-            valid_prices++;
-        }
-        
-        // Count dirty rows
-        if (ctx.dirty[i] != 0) {
-            stats_.dirty_rows++;
+// Ingest thread: moves the totals by each changed row (its old value out, its new value
+// in), O(changed rows), and publishes them for the render thread every cycle
+void Navigator::OnChangeSet(HostContext& ctx, const ChangeSet& changes) {
+    PROFILE_SCOPE("Navigator statistics");
+    if (!seeded_) {
+        // The published rows already include this change set
+        SeedStatistics(ctx);
+        seeded_ = true;
+    } else {
+        // Performance critical: two updates per changed row
+        for (size_t k = 0; k < changes.size(); ++k) {
+            CountRow(changes.before[k], -1);
+            CountRow(changes.after[k], 1);
         }
     }
+
+    DataStats& out = stats_slot_.back();
+    out = totals_;
+    out.total_rows = ctx.num_rows;
+    out.avg_price = priced_rows_ > 0 ? price_sum_ / priced_rows_ : 0;
+    out.dirty_rows = (uint32_t)changes.size();
+    out.cycle = changes.cycle;
+    out.epoch = changes.epoch;
+    out.rows_delivered = ctx.changes.rows_delivered;
+    out.cow_copies = ctx.published.cow_copies;
+    out.rebases = ctx.published.rebases;
+    out.widened = ctx.published.widened;
+    out.resync_count = ctx.resync_count;
+    out.snap = ctx.snap_stats;
+    stats_slot_.publish();
+}
+
+// Adds (sign 1) or removes (sign -1) one row value from the running totals
+void Navigator::CountRow(const RowSnap& row, int64_t sign) {
+    const uint32_t d = (uint32_t)sign;
+    // Count by side (per md_api.h: 0=unk, 1=bid, 2=ask, 3=trade)
+    switch (row.side) {
+        case 0: totals_.unknown_count += d; break;
+        case 1: totals_.buy_count += d; break;
+        case 2: totals_.sell_count += d; break;
+        case 3: totals_.trade_count += d; break;
+        default: break;  // Invalid side value
+    }
+    totals_.total_quantity += sign * row.qty;
+    if (row.px > 0) {
+        price_sum_ += sign * row.px;
+        priced_rows_ += d;
+    }
+    if (row.px < 10000) totals_.low_price += d;
+    else if (row.px < 50000) totals_.mid_price += d;
+    else totals_.high_price += d;
+}
+
+// Full pass over one snapshot, once per subscription; the change sets keep it current
+void Navigator::SeedStatistics(HostContext& ctx) {
+    totals_ = DataStats{};
+    price_sum_ = 0;
+    priced_rows_ = 0;
+    PublishedSnapshot snap;
+    if (!ctx.published.snapshot(snap)) return;
     
-    if (valid_prices > 0) {
-        stats_.avg_price = total_price / valid_prices;
+    // Performance critical: single-pass statistics aggregation over all market data rows
+    for (uint32_t i = 0; i < snap.num_rows; ++i) {
+        // Decode qty and px a block at a time (SIMD) instead of row by row
+        const uint32_t k = i & kPublishedBlockMask;
+        if (k == 0) {
+            const uint32_t run = std::min(kPublishedBlockRows, snap.num_rows - i);
+            snap.decode(PubQty, i, run, qty_buf_);
+            snap.decode(PubPx, i, run, px_buf_);
+        }
+        CountRow(RowSnap{0, px_buf_[k], qty_buf_[k], snap.side(i)}, 1);
     }
 }
 
-void Navigator::RenderDataCategoriesTree(HostContext& ctx, const HostMDSlot& slot) {
+void Navigator::RenderDataCategoriesTree() {
     if (ImGui::TreeNode("Data Categories")) {
         // Market Sides (per md_api.h: 0=unk, 1=bid, 2=ask, 3=trade)
         if (ImGui::TreeNode("By Side")) {
@@ -125,28 +170,18 @@ void Navigator::RenderDataCategoriesTree(HostContext& ctx, const HostMDSlot& slo
         if (ImGui::TreeNode("By Price Range")) {
             ImGuiTreeNodeFlags leaf_flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
             
-            // Count orders in different price ranges
-            uint32_t low_price = 0, mid_price = 0, high_price = 0;
-            // Performance critical: price range classification for UI display
-            // Only executed when price range tree node is expanded
-            for (uint32_t i = 0; i < slot.num_rows; ++i) {
-                int64_t price = slot.px_n[i];
-                if (price < 10000) low_price++;
-                else if (price < 50000) mid_price++;
-                else high_price++;
-            }
-            
+            // Orders in different price ranges, counted on the ingest thread
             ImGui::TreeNodeEx("Low (< 100.00)", leaf_flags);
             ImGui::SameLine();
-            ImGui::TextDisabled("(%u)", low_price);
+            ImGui::TextDisabled("(%u)", stats_.low_price);
             
             ImGui::TreeNodeEx("Mid (100.00 - 500.00)", leaf_flags);
             ImGui::SameLine();
-            ImGui::TextDisabled("(%u)", mid_price);
+            ImGui::TextDisabled("(%u)", stats_.mid_price);
             
             ImGui::TreeNodeEx("High (> 500.00)", leaf_flags);
             ImGui::SameLine();
-            ImGui::TextDisabled("(%u)", high_price);
+            ImGui::TextDisabled("(%u)", stats_.high_price);
             
             ImGui::TreePop();
         }
@@ -170,7 +205,7 @@ void Navigator::RenderDataCategoriesTree(HostContext& ctx, const HostMDSlot& slo
     }
 }
 
-void Navigator::RenderStatisticsTree(HostContext& ctx, const HostMDSlot& slot) {
+void Navigator::RenderStatisticsTree(HostContext& ctx) {
     if (ImGui::TreeNode("Statistics")) {
         ImGui::Text("Total Rows: %u", stats_.total_rows);
         ImGui::Text("Total Quantity: %lld", (long long)stats_.total_quantity);
@@ -197,15 +232,73 @@ void Navigator::RenderStatisticsTree(HostContext& ctx, const HostMDSlot& slot) {
         ImGui::Spacing();
         
         ImGui::Text("Recently Updated: %u", stats_.dirty_rows);
+        ImGui::Text("Ingest cycle: %llu, rows delivered: %llu", (unsigned long long)stats_.cycle,
+                    (unsigned long long)stats_.rows_delivered);
         
         // Queue statistics
         ImGui::Spacing();
         ImGui::Separator();
-        ImGui::Text("Queue Stats:");
-        ImGui::Text("  Capacity: %zu", ctx.q.buf.size());
-        ImGui::Text("  Head: %u", ctx.q.head.load(std::memory_order_relaxed));
-        ImGui::Text("  Tail: %u", ctx.q.tail.load(std::memory_order_relaxed));
-        
+        if (ctx.notify_mode == NotifyMode::Bitmap) {
+            ImGui::Text("Notify: dirty bitmap");
+            ImGui::Text("  Words: %u", ctx.dirty_bits.num_words);
+        } else if (ctx.notify_mode == NotifyMode::Broadcast) {
+            ImGui::Text("Notify: broadcast ring (%s)",
+                        ctx.bcast.policy == BroadcastPolicy::Lossy ? "lossy" : "gated");
+            ImGui::Text("  Capacity: %llu", (unsigned long long)ctx.bcast.capacity());
+            ImGui::Text("  Published: %llu",
+                        (unsigned long long)ctx.bcast.claim.load(std::memory_order_relaxed));
+            ImGui::Text("  Slowest cursor: %llu",
+                        (unsigned long long)ctx.bcast.min_cursor(
+                            ctx.bcast.claim.load(std::memory_order_relaxed)));
+            ImGui::Text("  Overflows: %llu",
+                        (unsigned long long)ctx.overflow_count.load(std::memory_order_relaxed));
+            ImGui::Text("  Resyncs: %llu", (unsigned long long)stats_.resync_count);
+        } else {
+            if (ctx.notify_mode == NotifyMode::WriterRings) {
+                ImGui::Text("Writer Rings: %u / %u claimed",
+                            ctx.writer_ring_hwm.load(std::memory_order_relaxed), ctx.max_writers);
+            }
+            ImGui::Text("Queue Stats:");
+            ImGui::Text("  Capacity: %u", ctx.q.capacity());
+            ImGui::Text("  Head: %u", ctx.q.head.load(std::memory_order_relaxed));
+            ImGui::Text("  Tail: %u", ctx.q.tail.load(std::memory_order_relaxed));
+            ImGui::Text("  Overflows: %llu",
+                        (unsigned long long)ctx.overflow_count.load(std::memory_order_relaxed));
+            ImGui::Text("  Resyncs: %llu", (unsigned long long)stats_.resync_count);
+        }
+
+        ImGui::Spacing();
+        ImGui::Separator();
+        if (ctx.arena.active()) {
+            ImGui::Text("Arena: %.1f / %.1f MB (%s pages)", ctx.arena.used / 1048576.0,
+                        ctx.arena.capacity / 1048576.0, ctx.arena.page_kind);
+            if (ctx.arena.spilled_count)
+                ImGui::Text("  Spilled to heap: %u", ctx.arena.spilled_count);
+        } else {
+            ImGui::Text("Arena: off");
+        }
+
+        // Seqlock reader/writer interference
+        const HostContext::SnapshotStats& snap = stats_.snap;
+        ImGui::Text("Published epoch: %llu",
+                    (unsigned long long)(ctx.published.epoch.load(std::memory_order_relaxed) / 2));
+        ImGui::Text("  Totals as of: %llu, blocks copied: %llu",
+                    (unsigned long long)(stats_.epoch / 2),
+                    (unsigned long long)stats_.cow_copies);
+        ImGui::Text("  Encoding: rebases %llu, wide columns %llu",
+                    (unsigned long long)stats_.rebases,
+                    (unsigned long long)stats_.widened);
+        ImGui::Text("Snapshots: %llu", (unsigned long long)snap.rows);
+        ImGui::Text("  Torn: %llu (%.3f%%)", (unsigned long long)snap.torn,
+                    snap.rows ? snap.torn * 100.0 / snap.rows : 0.0);
+        ImGui::Text("  Retries: %llu", (unsigned long long)snap.retries);
+        ImGui::Text("  Failed: %llu, deferred now: %u", (unsigned long long)snap.failures,
+                    snap.last_deferred);
+        ImGui::Text("  Held for readers: %llu", (unsigned long long)snap.held);
+        if (snap.most_torn > 0)
+            ImGui::Text("  Most contended: row %u (%u)", snap.most_torn_row, snap.most_torn);
+        ImGui::Text("Page faults: %llu", (unsigned long long)os_page_faults());
+
         ImGui::TreePop();
     }
 }
@@ -287,5 +380,9 @@ void Navigator::RenderQuickFiltersTree(MarketDataTable* table) {
 }
 
 void Navigator::Cleanup() {
+    if (subscribed_ctx_) {
+        subscribed_ctx_->changes.unsubscribe(change_sub_);
+        subscribed_ctx_ = nullptr;
+    }
     initialized_ = false;
 }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "../core/main_context.h"
+#include "../core/rcu_slot.h"
 
 // Forward declarations
 struct HostContext;
@@ -18,7 +19,9 @@ class MarketDataTable;
  * - Data statistics and aggregations
  * - Quick filters and views
  * 
- * Shares the same HostContext and HostMDSlot data source as MarketDataTable
+ * Shares the same HostContext and HostMDSlot data source as MarketDataTable. The
+ * statistics are kept on the ingest thread, from the change sets, and reach the render
+ * thread through an RcuSlot; Render only draws them.
  */
 class Navigator {
 public:
@@ -30,11 +33,18 @@ public:
      * @param max_rows Maximum number of rows to handle
      */
     void Initialize(uint32_t max_rows);
+
+    /**
+     * @brief Subscribe to the change sets of ctx (before the ingest thread starts)
+     * @param ctx HostContext whose ingest stage keeps the statistics up to date
+     */
+    void Subscribe(HostContext& ctx);
     
     /**
      * @brief Render the navigator window
      * @param ctx HostContext with market data
-     * @param slot HostMDSlot with raw data buffers
+     * @param slot Unused: the totals come from change sets, not the raw buffers; kept so
+     *        every view's Render takes the same arguments
      * @param table Optional MarketDataTable to apply filters to
      */
     void Render(HostContext& ctx, const HostMDSlot& slot, MarketDataTable* table = nullptr);
@@ -49,7 +59,7 @@ private:
     bool initialized_;
     uint32_t max_rows_;
     
-    // Cached statistics (updated during render)
+    // Statistics as of one ingest cycle, built on the ingest thread
     struct DataStats {
         uint32_t total_rows = 0;
         uint32_t unknown_count = 0;  // side == 0
@@ -58,15 +68,39 @@ private:
         uint32_t trade_count = 0;    // side == 3
         int64_t total_quantity = 0;
         int64_t avg_price = 0;
-        uint32_t dirty_rows = 0;
+        uint32_t low_price = 0;      // px < 10000
+        uint32_t mid_price = 0;      // px < 50000
+        uint32_t high_price = 0;
+        uint32_t dirty_rows = 0;     // rows changed by the last ingest cycle
+        uint64_t cycle = 0;          // ingest cycle the totals are as of
+        uint64_t epoch = 0;          // published epoch of that cycle
+        uint64_t rows_delivered = 0;
+        uint64_t cow_copies = 0;     // publisher counters, copied for the render thread
+        uint64_t rebases = 0;
+        uint64_t widened = 0;
+        uint64_t resync_count = 0;
+        HostContext::SnapshotStats snap;
     };
-    DataStats stats_;
+    DataStats stats_;  // render thread: latest from stats_slot_
+    RcuSlot<DataStats> stats_slot_;
+    HostContext* subscribed_ctx_ = nullptr;  // context whose change sets we receive
+    int32_t change_sub_ = -1;
+
+    // Ingest thread: running totals, updated by the before/after values of each change
+    DataStats totals_;
+    int64_t price_sum_ = 0;   // sum of the positive prices
+    uint32_t priced_rows_ = 0;
+    bool seeded_ = false;     // totals_ counted once over the whole table
+    int64_t qty_buf_[kPublishedBlockRows];  // one decoded block, for the seeding pass
+    int64_t px_buf_[kPublishedBlockRows];
     
     // Helper rendering methods
-    void RenderDataCategoriesTree(HostContext& ctx, const HostMDSlot& slot);
-    void RenderStatisticsTree(HostContext& ctx, const HostMDSlot& slot);
+    void RenderDataCategoriesTree();
+    void RenderStatisticsTree(HostContext& ctx);
     void RenderQuickFiltersTree(MarketDataTable* table);
     
-    // Data analysis helpers
-    void UpdateStatistics(HostContext& ctx, const HostMDSlot& slot);
+    // Data analysis helpers (ingest thread)
+    void OnChangeSet(HostContext& ctx, const ChangeSet& changes);
+    void SeedStatistics(HostContext& ctx);
+    void CountRow(const RowSnap& row, int64_t sign);
 };
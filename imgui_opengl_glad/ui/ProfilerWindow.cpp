@@ -0,0 +1,176 @@
+#include "ProfilerWindow.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "imgui.h"
+
+namespace {
+
+// Same colour for a stage in every frame: hue from the name
+ImU32 StageColor(const char* name) {
+    uint32_t h = 2166136261u;
+    // Performance critical: a few characters per drawn scope
+    for (const char* p = name; p && *p; ++p)
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    return ImColor::HSV((h % 360) / 360.0f, 0.55f, 0.75f);
+}
+
+}  // namespace
+
+// Performance critical: no, constructed once; the path is moved in
+ProfilerWindow::ProfilerWindow(std::string trace_path)
+    : trace_path_(trace_path.empty() ? "profile_trace.json" : std::move(trace_path)) {
+}
+
+// Copies the window's scopes out of the rings and totals them per stage
+void ProfilerWindow::Capture(int64_t now_ns) {
+    const int64_t span_ns = (int64_t)(window_ms_ * 1e6);
+    samples_.clear();
+    Profiler::global().collect(samples_, now_ns - span_ns);
+    view_end_ns_ = now_ns;
+
+    stages_.clear();
+    const ProfileSample* spike = nullptr;
+    // Performance critical: every captured scope, stages found by linear search (a few dozen)
+    for (const ProfileSample& s : samples_) {
+        const double us = (s.end_ns - s.begin_ns) / 1e3;
+        auto it = std::find_if(stages_.begin(), stages_.end(), [&s](const StageStats& st) {
+            return st.name == s.name || std::strcmp(st.name, s.name) == 0;
+        });
+        if (it == stages_.end())
+            it = stages_.insert(stages_.end(), StageStats{s.name, 0, 0.0, 0.0});
+        ++it->count;
+        it->total_us += us;
+        it->max_us = std::max(it->max_us, us);
+        if (spike_ms_ > 0.0f && s.depth == 0 && us > spike_ms_ * 1e3 &&
+            s.end_ns > frozen_end_ns_ && (!spike || s.end_ns - s.begin_ns > spike->end_ns - spike->begin_ns))
+            spike = &s;
+    }
+    std::sort(stages_.begin(), stages_.end(),
+              [](const StageStats& a, const StageStats& b) { return a.max_us > b.max_us; });
+    if (spike) {
+        paused_ = true;
+        frozen_end_ns_ = spike->end_ns;  // resuming does not freeze on it again
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "Frozen on a %.2f ms \"%s\" on %s",
+                      (spike->end_ns - spike->begin_ns) / 1e6, spike->name,
+                      Profiler::global().thread_name(spike->thread).c_str());
+        status_ = buf;
+    }
+}
+
+void ProfilerWindow::Render() {
+    if (!ImGui::Begin("Profiler")) {
+        ImGui::End();
+        return;
+    }
+
+    Profiler& profiler = Profiler::global();
+    bool enabled = profiler.on();
+    if (ImGui::Checkbox("Record", &enabled))
+        profiler.enabled.store(enabled, std::memory_order_relaxed);
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &paused_);
+    ImGui::SameLine();
+    if (ImGui::Button("Export trace")) {
+        const bool ok = profiler.export_chrome_trace(trace_path_.c_str());
+        status_ = (ok ? "Written to " : "Cannot write ") + trace_path_;
+    }
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::SliderFloat("Window (ms)", &window_ms_, 5.0f, 1000.0f, "%.0f",
+                       ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100.0f);
+    ImGui::InputFloat("Freeze above (ms)", &spike_ms_, 0.0f, 0.0f, "%.1f");
+    if (!status_.empty())
+        ImGui::TextDisabled("%s", status_.c_str());
+
+    if (!paused_)
+        Capture(Profiler::now_ns());
+    RenderTimeline();
+    ImGui::Separator();
+    RenderStageTable();
+    ImGui::End();
+}
+
+void ProfilerWindow::RenderTimeline() {
+    const uint32_t threads = Profiler::global().used.load(std::memory_order_acquire);
+    const float row_h = ImGui::GetTextLineHeight() + 2.0f;
+    const float label_w = 90.0f;
+    const float width = std::max(50.0f, ImGui::GetContentRegionAvail().x - label_w);
+    const double span_ns = window_ms_ * 1e6;
+    const double begin_ns = (double)view_end_ns_ - span_ns;
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    // Performance critical: one lane per profiled thread
+    for (uint32_t t = 0; t < threads; ++t) {
+        uint32_t depth = 0;
+        // Performance critical: lane height from the deepest scope of the thread
+        for (const ProfileSample& s : samples_) {
+            if (s.thread == t)
+                depth = std::max(depth, s.depth + 1);
+        }
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float lane_h = std::max(1u, depth) * row_h;
+        draw->AddText(origin, ImGui::GetColorU32(ImGuiCol_Text),
+                      Profiler::global().thread_name(t).c_str());
+        const float x0 = origin.x + label_w;
+        draw->AddRectFilled(ImVec2(x0, origin.y), ImVec2(x0 + width, origin.y + lane_h),
+                            ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+        // Performance critical: one rectangle per scope in the window
+        for (const ProfileSample& s : samples_) {
+            if (s.thread != t)
+                continue;
+            const float a = x0 + (float)((s.begin_ns - begin_ns) / span_ns) * width;
+            const float b = x0 + (float)((s.end_ns - begin_ns) / span_ns) * width;
+            const ImVec2 lo(std::max(a, x0), origin.y + s.depth * row_h);
+            const ImVec2 hi(std::max(std::min(b, x0 + width), lo.x + 1.0f), lo.y + row_h - 1.0f);
+            draw->AddRectFilled(lo, hi, StageColor(s.name));
+            if (hi.x - lo.x > 30.0f) {
+                const ImVec4 clip(lo.x, lo.y, hi.x, hi.y);
+                draw->AddText(nullptr, 0.0f, ImVec2(lo.x + 2.0f, lo.y), IM_COL32_BLACK, s.name,
+                              nullptr, 0.0f, &clip);
+            }
+            if (mouse.x >= lo.x && mouse.x < hi.x && mouse.y >= lo.y && mouse.y < hi.y)
+                ImGui::SetTooltip("%s\n%.3f ms", s.name, (s.end_ns - s.begin_ns) / 1e6);
+        }
+        ImGui::Dummy(ImVec2(label_w + width, lane_h + 4.0f));
+    }
+    if (threads == 0)
+        ImGui::TextDisabled("No probes recorded yet");
+}
+
+void ProfilerWindow::RenderStageTable() {
+    const ImGuiTableFlags flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+    if (!ImGui::BeginTable("ProfilerStages", 4, flags))
+        return;
+    ImGui::TableSetupColumn("Stage");
+    ImGui::TableSetupColumn("Count");
+    ImGui::TableSetupColumn("Mean (us)");
+    ImGui::TableSetupColumn("Max (us)");
+    ImGui::TableHeadersRow();
+    // Performance critical: one row per stage, slowest first
+    for (const StageStats& st : stages_) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::PushID(st.name);
+        ImGui::ColorButton("##stage", ImColor(StageColor(st.name)),
+                           ImGuiColorEditFlags_NoTooltip | ImGuiColorEditFlags_NoDragDrop,
+                           ImVec2(10.0f, 10.0f));
+        ImGui::PopID();
+        ImGui::SameLine();
+        ImGui::TextUnformatted(st.name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", st.count);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", st.total_us / st.count);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", st.max_us);
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../core/profiler.h"
+
+// "Profiler" window: the last window_ms of every profiled thread as a timeline, one lane per
+// thread and one row per nesting level, and a per-stage table (count, mean, max) over the
+// same span. Capture can be paused, or frozen automatically by the first top-level scope
+// longer than spike_ms, to look at what made a frame or an ingest cycle slow. Export writes
+// everything still in the rings as a Chrome trace.
+class ProfilerWindow {
+  public:
+    // Export writes to path, or profile_trace.json when empty
+    explicit ProfilerWindow(std::string trace_path);
+
+    // Render thread
+    void Render();
+
+  private:
+    struct StageStats {
+        const char* name;
+        uint32_t count;
+        double total_us;
+        double max_us;
+    };
+
+    void Capture(int64_t now_ns);
+    void RenderTimeline();
+    void RenderStageTable();
+
+    std::string trace_path_;
+    std::string status_;
+    float window_ms_ = 100.0f;
+    float spike_ms_ = 0.0f;  // 0 = never freeze
+    bool paused_ = false;
+    int64_t view_end_ns_ = 0;    // right edge of the timeline
+    int64_t frozen_end_ns_ = 0;  // end of the scope that froze the capture last
+    std::vector<ProfileSample> samples_;
+    std::vector<StageStats> stages_;
+};